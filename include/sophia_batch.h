@@ -0,0 +1,110 @@
+#ifndef SOPHIA_BATCH_H
+#define SOPHIA_BATCH_H
+
+#include <cstddef>
+#include <vector>
+
+#include "sophia_interface.h"
+#include "sophia_spectra.h"
+
+/*
+    Parallel generation of many events with identical input.
+
+    The events are split into chunks of chunkSize events. Chunk c is always generated from
+    RNG substream (seed, c) by a freshly configured engine, whichever worker thread happens to
+    pick it up. The result is therefore bit-identical for any number of threads.
+    Each worker thread owns one sophia_interface which it reuses for all its chunks.
+    With chunkSize = 1 event i is sophia_interface::regenerateEvent(..., seed, i): every event
+    can be reproduced on its own.
+
+    generateInteractions() does the same for a list of different interactions, e.g. from a
+    propagation code. Their cost varies by orders of magnitude (resonance decay vs. multipion
+    fragmentation, whose cost grows with sqrt(s)), therefore the list is cut into consecutive
+    chunks of about equal estimated cost rather than equal size. The chunks are handed out
+    most expensive first, idle workers taking the next one, so that no long chunk is left for
+    the end. Chunk boundaries depend on the input only, results are again bit-identical for
+    any number of threads and come in input order.
+
+    generateSpectra() only histograms the events (see sophia_spectra.h), nothing is stored per
+    particle. Every worker fills its own histograms, which are added at the end. The events
+    are those of generateBatch; the sums are bit-identical for any number of threads as long
+    as all weights are 1 (no thinning), otherwise they may differ by rounding.
+*/
+
+// all particles of a batch in one flat list, event after event
+struct sophiabatch_output {
+  int nEvents = 0;
+  // particles of event i are the entries eventStart[i] ... eventStart[i + 1] - 1
+  std::vector<int> eventStart;
+  std::vector<int> partID;           // SOPHIA particle IDs
+  std::vector<double> partP[5];      // px, py, pz, E, m in GeV
+  std::vector<double> partWeight;    // statistical weights, 1 without thinning
+
+  int getNout(int event) const { return eventStart[event + 1] - eventStart[event]; }
+  int getPartID(int event, int i) const { return partID[eventStart[event] + i]; }
+  double getPartP(int event, int i, int j) const { return partP[j][eventStart[event] + i]; }
+  double getPartWeight(int event, int i) const { return partWeight[eventStart[event] + i]; }
+
+  // append the last event generated by SI (its p, LLIST, weight and np)
+  void append(const sophia_interface& SI);
+  // same, only the particles passing filter
+  void append(const sophia_interface& SI, const particle_filter& filter);
+};
+
+const int batchChunkSize = 100;
+
+// - nThreads <= 0: use all hardware threads
+// - parameters: configuration every engine starts from (stable pions are set per call), e.g.
+//   with thinning, see sophia_parameters::setThinningEnergy
+sophiabatch_output generateBatch(bool onProton, double Ein, double eps, int nEvents, int nThreads,
+                                 unsigned long long seed, bool declareChargedPionsStable = false,
+                                 const sophia_parameters& parameters = sophia_parameters(),
+                                 int chunkSize = batchChunkSize);
+// same, only the particles passing filter are stored (the events are the same)
+sophiabatch_output generateBatch(bool onProton, double Ein, double eps, int nEvents, int nThreads,
+                                 unsigned long long seed, const particle_filter& filter,
+                                 bool declareChargedPionsStable = false,
+                                 const sophia_parameters& parameters = sophia_parameters(),
+                                 int chunkSize = batchChunkSize);
+
+// spectra of nEvents events with the booking (species, bins) of booking, whose entries are
+// ignored. The arguments are those of generateBatch.
+// - firstEvent: the events firstEvent ... firstEvent + nEvents - 1 of a longer run with the same
+//   seed instead, a multiple of chunkSize. The merged spectra of consecutive parts of a run are
+//   those of the whole run (bit-identical with unit weights), see sophia_scan.h.
+sophia_spectra generateSpectra(bool onProton, double Ein, double eps, int nEvents, int nThreads,
+                               unsigned long long seed, const sophia_spectra& booking,
+                               bool declareChargedPionsStable = false,
+                               const sophia_parameters& parameters = sophia_parameters(),
+                               int chunkSize = batchChunkSize, int firstEvent = 0);
+
+struct interaction_request {
+  bool onProton;
+  double Ein;  // nucleon energy, GeV
+  double eps;  // photon energy, GeV
+};
+
+// estimated time of one event in units of a resonance event, from sqrt(s) at the typical
+// eps_prime and the channel probabilities of dec_inter3
+double estimateCost(const interaction_request& request);
+
+// default chunk size in estimated cost, ~ 1 ms
+const double interactionChunkCost = 100.;
+
+// one event per request, event i of the output belongs to requests[i]. Chunk c is generated
+// from RNG substream (seed, c).
+sophiabatch_output generateInteractions(const interaction_request* requests, size_t nRequests,
+                                        int nThreads, unsigned long long seed,
+                                        bool declareChargedPionsStable = false,
+                                        const particle_filter& filter = particle_filter(),
+                                        const sophia_parameters& parameters = sophia_parameters(),
+                                        double chunkCost = interactionChunkCost);
+inline sophiabatch_output generateInteractions(const std::vector<interaction_request>& requests,
+                                               int nThreads, unsigned long long seed,
+                                               bool declareChargedPionsStable = false,
+                                               const particle_filter& filter = particle_filter()) {
+  return generateInteractions(requests.data(), requests.size(), nThreads, seed,
+                              declareChargedPionsStable, filter);
+}
+
+#endif
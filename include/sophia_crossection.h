@@ -0,0 +1,110 @@
+#ifndef SOPHIA_CROSSECTION_H
+#define SOPHIA_CROSSECTION_H
+
+#include <vector>
+
+/*
+    Tabulated nucleon-photon cross sections, an optional fast replacement of
+    sophia_interface::crossection_analytic.
+
+    For both nucleons (NL0 = 13, 14) all 20 channels NDIR are tabulated as function of the
+    photon energy x = eps_prime in the nucleon rest frame. The grid is logarithmic in x and
+    split into segments at the threshold and at every kink or step of the parametrisation
+    (Ef/Pl thresholds, x = 0.85, x = 10), so linear interpolation never crosses one. The 20
+    channels of one grid point are stored next to each other, as dec_inter3/dec_res2 ask for
+    several channels at the same x.
+
+    Values are exact at the grid points. In between the deviation from the analytic cross
+    section is below 1e-3 of the total cross section with the default grid, and below 1e-4
+    once the total exceeds a few mubarn (x > 0.155), see maxDeviation(). Above xMax the
+    analytic cross section is returned.
+
+    The table is immutable after construction, instance() is built once per process and may
+    be shared by any number of engines and threads.
+*/
+// all channels NDIR of the nucleon-photon cross section at one x, in mubarn
+struct crossection_output {
+  static const int nChannels = 20;
+  double sigma[nChannels] = {0.};  // sigma[NDIR], see sophia_interface::crossection_analytic
+};
+
+class crossection_table {
+ public:
+  static const int nChannels = crossection_output::nChannels;  // NDIR = 0 ... 19
+
+  // pointsPerDecade: grid density below x = 10, pointsPerDecadeHigh: above
+  explicit crossection_table(int pointsPerDecade = 2000, int pointsPerDecadeHigh = 100,
+                             double xMax = 1e8);
+
+  // shared default table, built on first use
+  static const crossection_table& instance();
+
+  // same arguments and result as sophia_interface::crossection_analytic
+  double crossection(double x, int NDIR, int NL0) const;
+  // all channels, one segment lookup
+  crossection_output crossections(double x, int NL0) const;
+
+  // accuracy check: largest deviation |table - analytic| between the grid points, relative to
+  // the total cross section (NDIR = 3) at that x, over all channels and both nucleons
+  double maxDeviation() const;
+
+  double getXMax() const { return xMax; }
+
+ private:
+  struct segment {
+    double xLow;
+    double xHigh;
+    double lnXLow;
+    double invStep;          // 1 / (step in ln x)
+    int nPoints;
+    std::vector<double> value;  // value[i * nChannels + NDIR]
+  };
+
+  double xMax;
+  double xThreshold[2];
+  std::vector<segment> segments[2];
+};
+
+/*
+    Cumulative integral of functs(s, L0) = (s - pm^2) sigma_tot(s), the distribution of the
+    squared CMS energy s that sample_s draws from, on a logarithmic grid in s starting at the
+    threshold smin = 1.1646 GeV^2.
+
+    The integral over each grid cell is computed once with an 8-point Gauss-Legendre rule from
+    the analytic cross section. Inside a cell functs is taken as linear in s, which gives
+    integral(s) and its exact inverse, thus sample() costs a binary search and one square
+    root instead of two quadratures and a rejection loop.
+
+    Immutable after construction, instance() is built once per process and shared.
+*/
+class functs_table {
+ public:
+  static const double sMin;
+
+  explicit functs_table(int pointsPerDecade = 500, double sMax = 1e10);
+
+  // shared default table, built on first use
+  static const functs_table& instance();
+
+  // integral of functs(s', L0) over [sMin, s], for sMin <= s <= getSMax()
+  double integral(double s, int L0) const;
+
+  // s in [sMin, smax] distributed as functs(s, L0), from one uniform random number r in (0, 1)
+  double sample(double smax, int L0, double r) const;
+
+  double getSMax() const { return sMax; }
+
+ private:
+  // position of s inside cell i: returns i and the fraction of the cell integral below s
+  int locate(double s, int L0, double& fraction) const;
+
+  double sMax;
+  double lnSMin;
+  double invStep;                 // 1 / (step in ln s)
+  int nPoints;
+  std::vector<double> sNode;      // grid points
+  std::vector<double> functs[2];  // functs at the grid points, per nucleon
+  std::vector<double> cumulative[2];  // integral over [sMin, sNode[i]], per nucleon
+};
+
+#endif
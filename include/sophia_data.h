@@ -1,6 +1,8 @@
 #ifndef SOPHIA_DATA_H
 #define SOPHIA_DATA_H
 
+#include "sophia_particles.h"
+
 /*
     SOPHIA supports 49 particles, listed in the subsequently.
 
@@ -64,88 +66,116 @@
 // they serve as an early dictionary: if inputting the SIBYLL particle ID,
 // you get the particle data associated with it
 // remember, that in FORTRAN, array numbers are being counted from 1 onwards and not 0
-extern double AM[49];  // particle masses in GeV
-extern int IBAR[49];   // baryon numbers
-extern int ICHP[49];   // charges
-extern int
-    IDB[49];  // if entry > 0 -> particle is declared stable. all default numbers > 0 in this array
-              // are the particle IDs to remind the reader of the function of that array entry
+// AM (masses in GeV), IBAR (baryon numbers), ICHP (charges) and LBARP (anti-particles) are
+// compile-time constants, see sophia_particles.h
+extern const int IDB[49];   // default stability flags: entry > 0 -> particle decays, the entry
+                            // points to its first decay channel in CBR/KDEC. 0 -> stable.
+                            // Engines work on their own copy, see sophia_parameters below.
 
 //--------------------------------------------------------------------------------------
 // used by DECPAR_nonZero only which is a function that executes particle decays (of the 49
 // particles avilable)
-extern double CBR[102];  // containing numbers in [0,1]. I seems like these are probabilities for
-                         // decay channels
-extern int KDEC[612];  // length is 6x larger than length of CBR. Entries correspond to particle IDs
-                       // of decay products (in units of 6 possible particles per decay). These
-                       // decays are likely to occur with probability CBR
-extern int LBARP[49];  // contains SIBYLL anti-particle IDs. Due to the nature of how particles are
-                       // listed, some anti-particles are contained already. Also, some listed
-                       // particles might not have an anti-particle
+extern const double CBR[102];  // containing numbers in [0,1]. I seems like these are
+                               // probabilities for decay channels
+extern const int KDEC[612];  // length is 6x larger than length of CBR. Entries correspond to
+                             // particle IDs of decay products (in units of 6 possible particles
+                             // per decay). These decays are likely to occur with probability CBR
 
 //--------------------------------------------------------------------------------------
 // used RES_DECAY3 only
-extern int KDECRES1p[90];
-extern int KDECRES2p[180];
-extern int KDECRES3p[130];
-extern int KDECRES1n[90];
-extern int KDECRES2n[180];
-extern int KDECRES3n[110];
+extern const int KDECRES1p[90];
+extern const int KDECRES2p[180];
+extern const int KDECRES3p[130];
+extern const int KDECRES1n[90];
+extern const int KDECRES2n[180];
+extern const int KDECRES3n[110];
 
 //--------------------------------------------------------------------------------------
 // used by PROC_TWOPART only
-extern int FRES[49];
-extern double XLIMRES[49];
+extern const int FRES[49];
+extern const double XLIMRES[49];
 
 //--------------------------------------------------------------------------------------
 // used by crossection only
-extern double AMRESp[9];
-extern double AMRESn[9];
-extern double BGAMMAp[9];
-extern double BGAMMAn[9];
-extern double RATIOJp[9];
-extern double RATIOJn[9];
-extern double WIDTHp[9];
-extern double WIDTHn[9];
+extern const double AMRESp[9];
+extern const double AMRESn[9];
+extern const double BGAMMAp[9];
+extern const double BGAMMAn[9];
+extern const double RATIOJp[9];
+extern const double RATIOJn[9];
+extern const double WIDTHp[9];
+extern const double WIDTHn[9];
 
 //--------------------------------------------------------------------------------------
 // used by DEC_PROC2 only
-extern double CBRRES1p[18];
-extern double CBRRES2p[36];
-extern double CBRRES3p[26];
-extern double CBRRES1n[18];
-extern double CBRRES2n[36];
-extern double CBRRES3n[22];
-extern int IDBRES1p[9];
-extern int IDBRES2p[9];
-extern int IDBRES3p[9];
-extern int IDBRES1n[9];
-extern int IDBRES2n[9];
-extern int IDBRES3n[9];
-extern int ELIMITSp[9];
-extern int ELIMITSn[9];
-extern double RESLIMp[36];
-extern double RESLIMn[36];
+extern const double CBRRES1p[18];
+extern const double CBRRES2p[36];
+extern const double CBRRES3p[26];
+extern const double CBRRES1n[18];
+extern const double CBRRES2n[36];
+extern const double CBRRES3n[22];
+extern const int IDBRES1p[9];
+extern const int IDBRES2p[9];
+extern const int IDBRES3p[9];
+extern const int IDBRES1n[9];
+extern const int IDBRES2n[9];
+extern const int IDBRES3n[9];
+extern const int ELIMITSp[9];
+extern const int ELIMITSn[9];
+extern const double RESLIMp[36];
+extern const double RESLIMn[36];
 
 /* JETSET data block */
 
 // block data LUDATA. Purpose: to give default values to parameters and particle and decay data.
 
-// LUDAT1, containing status codes and most parameters.
-extern int MSTU[200];
-extern double PARU[200];
-extern int MSTJ[200];
-extern double PARJ[200];
+// LUDAT1, containing status codes and most parameters. Default values, see sophia_parameters.
+extern const int MSTU[200];
+extern const double PARU[200];
+extern const int MSTJ[200];
+extern const double PARJ[200];
 
 // LUDAT2, with particle data and flavour treatment parameters.
-extern int KCHG[3][500];
-extern double PMAS[4][500];
-extern double PARF[2000];
-
-// LUDAT3, with particle decay parameters and data.
-extern int MDCY[3][500];
-extern int MDME[2][2000];
-extern double BRAT[2000];
-extern int KFDP[5][2000];
+extern const int KCHG[3][500];
+extern const double PMAS[4][500];
+extern const double PARF[2000];
+
+// LUDAT3, with particle decay parameters and data. MDCY: default values, see sophia_parameters.
+extern const int MDCY[3][500];
+extern const int MDME[2][2000];
+extern const double BRAT[2000];
+extern const int KFDP[5][2000];
+
+/* per-engine parameters */
+
+//--------------------------------------------------------------------------------------
+// all tables above are read-only and shared by every engine of the process. The few
+// parameters SOPHIA and JETSET modify while running (status codes, energy-dependent
+// fragmentation parameters, stable particles) are copied into this struct instead, one
+// per sophia_interface. Inside sophia_interface these members shadow the global defaults
+// of the same name, so differently configured engines can run concurrently without locking.
+struct sophia_parameters {
+  // LUDAT1
+  int MSTU[200];
+  double PARU[200];
+  int MSTJ[200];
+  double PARJ[200];
+  // LUDAT3, decay switches
+  int MDCY[3][500];
+  // SOPHIA stability flags
+  int IDB[49];
+  // thinning levels in GeV (lab frame) per SOPHIA ID, antibaryons share the entry of the
+  // baryon. 0: the species is not thinned. See sophia_interface::thinEvent.
+  double thinningEnergy[49];
+  bool thinning;  // any thinningEnergy > 0
+
+  sophia_parameters();  // copies the global defaults, no thinning
+
+  // pi0, pi+ and pi- are either stable or decay with the default SOPHIA channels
+  void setChargedPionsStable(bool stable);
+  // thinning level of all species / of one species (SOPHIA ID)
+  void setThinningEnergy(double E);
+  void setThinningEnergy(int sophiaID, double E);
+};
 
 #endif
\ No newline at end of file
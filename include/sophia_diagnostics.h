@@ -0,0 +1,86 @@
+#ifndef SOPHIA_DIAGNOSTICS_H
+#define SOPHIA_DIAGNOSTICS_H
+
+#include <functional>
+#include <sstream>
+#include <string>
+
+/*
+    Messages of one engine during the event generation (warnings of sophiaevent/eventgen,
+    failed conservation checks, JETSET errors via LUERRM).
+
+    Every message kind is counted. It is only formatted and reported if its level is at
+    least getLevel() and it occurred at most maxReports times so far; the report announcing
+    the limit says so. Reports go to the callback if one is set, else to std::cout (one line,
+    no flush; lines of concurrent engines do not interleave).
+
+    Messages are issued via SOPHIA_DIAG(diagnostics, level, id, stream expression). The
+    expression is only evaluated for reported messages, thus a suppressed message costs one
+    counter increment and a comparison. The macro compiles to nothing if SOPHIA_NO_DIAGNOSTICS
+    is defined (cmake -DENABLE_DIAGNOSTICS=OFF); nothing is counted or reported then. The
+    message is still compiled in dead code, so that it stays valid and the variables it uses
+    do not become unused.
+*/
+#ifdef SOPHIA_NO_DIAGNOSTICS
+#define SOPHIA_DIAG(diagnostics, level, id, message)            \
+  do {                                                          \
+    if (false) {                                                \
+      std::ostringstream diagnosticMessage;                     \
+      diagnosticMessage << message;                             \
+      (diagnostics).report(level, id, diagnosticMessage.str()); \
+    }                                                           \
+  } while (0)
+#else
+#define SOPHIA_DIAG(diagnostics, level, id, message)            \
+  do {                                                          \
+    if ((diagnostics).count(level, id)) {                       \
+      std::ostringstream diagnosticMessage;                     \
+      diagnosticMessage << message;                             \
+      (diagnostics).report(level, id, diagnosticMessage.str()); \
+    }                                                           \
+  } while (0)
+#endif
+
+class sophia_diagnostics {
+ public:
+  enum level_type { debug, info, warning, error, silent };
+  enum message_id {
+    thetaOutOfRange,        // |cos(theta)| > 1 from rounding in generateEventAt
+    belowThreshold,         // s below the photopion threshold in eventgen
+    reggeonImpossible,      // gamma_h: no valence quark combination found
+    conservationViolated,   // check_event
+    unknownFlavour,         // lund_put
+    unknownPDGID,           // ICON_PDG_SIB
+    tauDecay,               // LUDECY: tau decay not available
+    jetsetWarning,          // LUERRM, MERR <= 10
+    jetsetError,            // LUERRM, MERR > 10
+    nMessageIDs
+  };
+  typedef std::function<void(level_type, message_id, const std::string&)> callback_type;
+
+  // messages below level are only counted; silent: nothing is reported
+  void setLevel(level_type minLevel) { level = minLevel; }
+  level_type getLevel() const { return level; }
+  // reports per message kind, < 0: no limit
+  void setMaxReports(long long n) { maxReports = n; }
+  // e.g. for a logging framework. Called from the thread generating the event.
+  void setCallback(callback_type function) { callback = function; }
+
+  long long getCount(message_id id) const { return counts[id]; }
+  void resetCounts();
+
+  // counts the message; true if it is to be reported
+  bool count(level_type messageLevel, message_id id) {
+    const long long n = ++counts[id];
+    return messageLevel >= level && (maxReports < 0 || n <= maxReports);
+  }
+  void report(level_type messageLevel, message_id id, const std::string& message) const;
+
+ private:
+  level_type level = warning;
+  long long maxReports = 10;
+  callback_type callback;
+  long long counts[nMessageIDs] = {0};
+};
+
+#endif
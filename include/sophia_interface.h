@@ -7,10 +7,18 @@
 #include <initializer_list>
 #include <iostream>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "sophia_crossection.h"
 #include "sophia_data.h"
+#include "sophia_diagnostics.h"
+#include "sophia_random.h"
+#include "sophia_rates.h"
+#include "sophia_record.h"
+#include "sophia_statistics.h"
 
+// the statistical weights of thinned events are in sophiaevent_buffer::weight only
 struct sophiaevent_output {
   double outPartP[5][2000];
   int outPartID[2000];
@@ -19,6 +27,39 @@ struct sophiaevent_output {
   int getPartID(int i) const { return outPartID[i]; }
 };
 
+// compact alternative to sophiaevent_output: only the Nout particles of the last event, as
+// struct of arrays. Meant to be reused; after the first few events no memory is allocated.
+struct sophiaevent_buffer {
+  int Nout = 0;
+  std::vector<double> px;  // GeV
+  std::vector<double> py;
+  std::vector<double> pz;
+  std::vector<double> E;
+  std::vector<double> m;
+  std::vector<int> pdgID;  // see ID_sophia_to_PDG
+  std::vector<double> weight;
+};
+
+// final particle as passed to the sink of visitEvent / streamEvent
+struct event_particle {
+  int pdgID;  // see ID_sophia_to_PDG
+  double px, py, pz, E, m;  // GeV, lab frame
+  double weight;
+};
+
+// selection of the final particles handed out: species (PDG IDs, empty: all) with E >= Emin
+struct particle_filter {
+  std::vector<int> pdgIDs;
+  double Emin = 0.;  // GeV
+
+  particle_filter() {}
+  particle_filter(std::initializer_list<int> ids, double Emin = 0.) : pdgIDs(ids), Emin(Emin) {}
+
+  bool accepts(int pdgID) const {
+    return pdgIDs.empty() || std::find(pdgIDs.begin(), pdgIDs.end(), pdgID) != pdgIDs.end();
+  }
+};
+
 struct DECPAR_zero_output {
   double P_out[5][10];
 };
@@ -30,8 +71,29 @@ struct DECPAR_nonZero_output {
 };
 
 struct PO_MSHELL_output {
-  std::vector<double> P1;
-  std::vector<double> P2;
+  double P1[4];
+  double P2[4];
+};
+
+struct PO_TRANS_output {
+  double X;
+  double Y;
+  double Z;
+};
+
+struct valences_output {
+  int IFL1;
+  int IFL2;
+};
+
+struct LUPTDI_output {
+  double PX;
+  double PY;
+};
+
+struct LUKFDI_output {
+  int KFL3;
+  int KF;
 };
 
 struct dec_proc2_output {
@@ -80,60 +142,200 @@ double gaussInt(Integrand&& integrand, double A, double B) {
   return XR * SS;
 }
 
-int ID_sophia_to_PDG(int sophiaID);
-
-class sophia_interface {
+// The JETSET/SOPHIA parameters modified at run time are inherited from sophia_parameters,
+// thus each instance has its own copy of them, see sophia_data.h.
+//
+// An instance is meant to be reused: construct one engine (per thread), then call
+// sophiaevent() for every event. Its event records start small and grow with the largest event
+// seen (see sophia_record.h). reset() cheaply clears the event records between events if a
+// clean record is wanted; sophiaevent() itself does not need it.
+class sophia_interface : public sophia_parameters {
  public:
+  explicit sophia_interface(int seed = sophia_random::legacySeed) : randomGenerator(seed) {
+    MSTU[3] = K.getCapacity();
+  }
+  explicit sophia_interface(const sophia_parameters& parameters,
+                            int seed = sophia_random::legacySeed)
+      : sophia_parameters(parameters), randomGenerator(seed) {
+    MSTU[3] = K.getCapacity();
+  }
+
+  // RNG state of this instance. Instances do not share random numbers, thus each engine
+  // (e.g. one per thread) has to be seeded on its own, see sophia_random::setSubstream.
+  // With the default seed the sequence of the original SOPHIA is reproduced.
+  sophia_random randomGenerator;
+  void setSeed(int seed) { randomGenerator.setSeed(seed); }
+  void setSubstream(unsigned long long runSeed, unsigned long long stream) {
+    randomGenerator.setSubstream(runSeed, stream);
+  }
+  // RANMAR (default) or the faster, block-buffered XOSHIRO256; restarts from the current seed
+  void setRandomAlgorithm(sophia_random::algorithm_type algorithm) {
+    randomGenerator.setAlgorithm(algorithm);
+  }
+
+  // counters and timers of this engine since construction or resetStatistics(), see
+  // sophia_statistics.h. Not affected by setParameters/reset.
+  sophia_statistics statistics;
+  const sophia_statistics& getStatistics() const { return statistics; }
+  void resetStatistics() { statistics.reset(); }
+
+  // warnings and errors of this engine: levels, counters, rate limit and an optional callback,
+  // see sophia_diagnostics.h. Not affected by setParameters/reset.
+  sophia_diagnostics diagnostics;
+
+  // optional: take the cross sections from the shared crossection_table::instance() instead of
+  // evaluating the parametrisation on every call. Faster, but results differ slightly from the
+  // analytic (default) mode, see sophia_crossection.h. Not affected by setParameters/reset.
+  void useTabulatedCrossections(bool tabulated) {
+    crossectionTable = tabulated ? &crossection_table::instance() : nullptr;
+  }
+  const crossection_table* crossectionTable = nullptr;
+
+  // optional: sample s by inversion of the shared functs_table::instance(). Draws one random
+  // number per event from the exact distribution functs(s) over [smin, smax] instead of the
+  // original quadrature + rejection/power-law scheme, so events differ from the default mode.
+  void useTabulatedSampling(bool tabulated) {
+    functsTable = tabulated ? &functs_table::instance() : nullptr;
+  }
+  const functs_table* functsTable = nullptr;
+
+  // optional: keep the production vertices and lifetimes of the JETSET record in V. SOPHIA's
+  // output does not use them and the events are the same without; V is then neither allocated
+  // nor filled (LUSHOW, which needs it as work space, allocates it when called). The decay
+  // volume cuts MSTJ(22) = 3, 4, which SOPHIA does not use, need the vertices.
+  // Not affected by setParameters/reset.
+  void useVertices(bool vertices);
+  bool trackVertices = false;
+
+  // optional: fragment the one or two quark - diquark strings of gamma_h with LUSTRF_twoParton
+  // and a plain decay loop instead of the general LUEXEC chain (LUPREP, LUSTRF, showers,
+  // junctions, Bose-Einstein effects), see fragmentSimpleStrings. Strings that LUPREP would
+  // collapse into one or two hadrons and engines with vertices take the general path.
+  // Not affected by setParameters/reset.
+  void useSimpleStrings(bool simple) { simpleStrings = simple; }
+  bool simpleStrings = false;
+
+  // restore the state of a freshly constructed engine with the given parameters (RNG untouched)
+  void setParameters(const sophia_parameters& parameters);
+
+  // clear the rows of K, P, V (first N) and p, LLIST, weight (first np) that the last event
+  // used. Rows beyond are never read before being written.
+  void reset();
+
   void debug(std::string, bool stopProgram = false);
   void debugNonLUND(std::string, bool stopProgram = false);
 
-  // JETSET
-  int N;
-  int K[5][4000];
-  double P[5][4000];
-  double V[5][4000];
+  // JETSET record LUJETS of MSTU[3] = K.getCapacity() entries. It grows by doubling up to
+  // maxRecordSize, the limit of the colour flow codes K[3], K[4] (MSTU[4] * index).
+  static const int initialRecordSize = 256;
+  static const int maxRecordSize = 10000;
+  int N = 0;
+  event_record<int, 5> K{initialRecordSize};
+  event_record<double, 5> P{initialRecordSize};
+  event_record<double, 5> V;  // empty unless trackVertices or LUSHOW was called
+  // room for entries 1 ... n and the MSTU[31] saved at the end by LUEDIT(21), i.e.
+  // MSTU[3] >= n + MSTU[31], growing the record if needed. false: maxRecordSize is too small.
+  // The memory checks of the JETSET routines.
+  bool LUJETS_reserve(int n);
 
   void LU2ENT(int KF1, int KF2, double PECM);  // prototype qq interaction method;
   void LUEXEC();
   void LUDECY(int IP);
   void LUDECY_setupPartonShowerEvolution(int IP, int NSAV, int MMAT, int ND, int MMIX);
   void LUSTRF(int IP);
+  // LUSTRF for the string of the two light partons IP, IP + 1
+  void LUSTRF_twoParton(int IP);
   void LUINDF(int IP);
   void LUPREP(int IP);
   void LUPREP_checkFlavour(int IP);
   double LUZDIS(int KFL1, int KFL2, double PR);
-  std::vector<double> LUPTDI(int KFL);
-  std::vector<int> LUKFDI(int KFL1, int KFL2);
+  LUPTDI_output LUPTDI(int KFL);
+  LUKFDI_output LUKFDI(int KFL1, int KFL2);
   void LUEDIT(int MEDIT);
   void LUSHOW(int IP1, int IP2, double QMAX);
   void LUBOEI(int NSAV);
   void LUJOIN(int NJOIN, int IJOIN[]);
-  void LUERRM(int MERR, std::string CHMESS);
+  void LUERRM(int MERR, const char* CHMESS);  // no std::string: called during event generation
   void LUROBO(double THE, double PHI, double BEX, double BEY, double BEZ);
   void LUDBRB(int IMIN, int IMAX, double THE, double PHI, double DBX, double DBY, double DBZ,
               bool skip = false);
   int KLU(int I, int J);
-  double RLU(bool isCalledByRNDM = false);  // defalut, internal RNG. To be removed later.
+  double RLU();  // JETSET's internal RNG, draws from randomGenerator like RNDM
   double ULMASS(int KF);
   double ULANGL(double X, double Y);
   double PLU(int I, int J);
-  int LUCHGE(int KF);
-  int LUCOMP(int KF);
+  // pure functions of KF, answered from a table built at start-up for |KF| < 10000
+  static int LUCHGE(int KF);
+  static int LUCOMP(int KF);
+
+  // JETSET state of this instance (formerly file-scope statics)
+  bool lund_frag_isInitialized = false;
+  // allowed decay channels of the particle being decayed; the default tables have at most 76
+  // channels per particle
+  static const int maxDecayChannels = 128;
+  int LUDECY_channels[maxDecayChannels];
 
   // SOPHIA
-  int np;
-  double p[5][2000];
-  int LLIST[2000];
+  int Ic = 0;  // counter of gamma_h calls, used for diagnostics in check_event
+  int np = 0;
+  // particles 0 ... np - 1, capacity growing as needed (reserveParticles)
+  static const int initialParticles = 256;
+  event_record<double, 5> p{initialParticles};
+  std::vector<int> LLIST = std::vector<int>(initialParticles, 0);
+  std::vector<double> weight = std::vector<double>(initialParticles, 0.);  // see thinEvent
+  // room for at least n particles
+  void reserveParticles(int n);
+  int lastImode = -1;   // interaction mode of the last event (dec_inter3), -1: no interaction
 
   sophiaevent_output sophiaevent(bool onProton, double Ein, double eps,
                                  bool declareChargedPionsStable = false);
+  // same, but writes only the produced particles into a reusable buffer. Returns Nout.
+  int sophiaevent(bool onProton, double Ein, double eps, sophiaevent_buffer& output,
+                  bool declareChargedPionsStable = false);
+  // samples the event without copying it: result in p, LLIST and np
+  void generateEvent(bool onProton, double Ein, double eps, bool declareChargedPionsStable);
+  // event-keyed reproduction: event "event" of run runSeed is generated from RNG substream
+  // (runSeed, event) by a reset engine, thus any single event is regenerated in constant time.
+  // These are the events of generateBatch(..., runSeed, ..., chunkSize = 1).
+  void regenerateEvent(bool onProton, double Ein, double eps, unsigned long long runSeed,
+                       unsigned long long event, bool declareChargedPionsStable = false) {
+    reset();
+    setSubstream(runSeed, event);
+    generateEvent(onProton, Ein, eps, declareChargedPionsStable);
+  }
+  // photon energy and s sampled together from a photon field (see sophia_rates.h) instead of
+  // a given eps. Returns the photon energy.
+  double generateEvent(bool onProton, double Ein, const photon_field_sampler& sampler,
+                       bool declareChargedPionsStable);
+  int sophiaevent(bool onProton, double Ein, const photon_field_sampler& sampler,
+                  sophiaevent_buffer& output, bool declareChargedPionsStable = false);
+  // event for a given s, shared by both generateEvent
+  void generateEventAt(int L0, double E0, double eps, double s);
+  // p, LLIST and np into output, PDG IDs. Returns Nout.
+  int copyEvent(sophiaevent_buffer& output) const;
+  // calls sink(const event_particle&) for the particles of the last event passing filter,
+  // straight from p and LLIST. Returns the number of particles passed to sink.
+  template <typename Sink>
+  int visitEvent(const particle_filter& filter, Sink&& sink) const;
+  // generateEvent + visitEvent: nothing is copied for the particles filtered out
+  template <typename Sink>
+  int streamEvent(bool onProton, double Ein, double eps, const particle_filter& filter,
+                  Sink&& sink, bool declareChargedPionsStable = false) {
+    generateEvent(onProton, Ein, eps, declareChargedPionsStable);
+    return visitEvent(filter, std::forward<Sink>(sink));
+  }
   void eventgen(int L0, double E0, double eps, double theta);
+  // Hillas thinning of the final particles (lab frame), last step of eventgen: a particle
+  // below its thinningEnergy Eth survives with probability E / Eth and gets weight Eth / E.
+  // The weighted energy flow is conserved on average. Without thinning all weights are 1 and
+  // no random number is drawn.
+  void thinEvent();
   void gamma_h(double Ecm, int ip1, int Imode);
   void DECSIB();
   DECPAR_zero_output DECPAR_zero(double P0[5], int ND, int LL[10]);
   DECPAR_nonZero_output DECPAR_nonZero(int LA, double P0[5]);
   PO_MSHELL_output PO_MSHELL(double PA1[4], double PA2[4], double XM1, double XM2);
-  std::vector<int> valences(int ip);
+  valences_output valences(int ip);
   void check_event(int Ic, double Esum, double PXsum, double PYsum, double PZsum, int IQchr,
                    int IQbar);
   int dec_res2(double eps_prime, int IRESMAX, int L0);
@@ -142,28 +344,49 @@ class sophia_interface {
   int dec_inter3(double eps_prime, int L0);
   double sample_s(double eps, int L0, double Ein);
   double functs(double s, int L0);
+  // nucleon-photon cross section in mubarn, from the table if enabled (see below)
   double crossection(double x, int NDIR, int NL0);
+  static double crossection_analytic(double x, int NDIR, int NL0);
+  // all channels NDIR at once, from one evaluation of the parametrisation (or table lookup)
+  crossection_output crossections(double x, int NL0);
+  static crossection_output crossections_analytic(double x, int NL0);
   dec_proc2_output dec_proc2(double x, int IRES, int L0);
-  double singleback(double x);
-  double twoback(double x);
+  static double singleback(double x);
+  static double twoback(double x);
   double scatterangle(int IRES, int L0);
   double probangle(int IRES, int L0, double z);
   PO_ALTRA_output PO_ALTRA(double GA, double BGX, double BGY, double BGZ, double PCX, double PCY,
                            double PCZ, double EC);
-  std::vector<double> PO_TRANS(double XO, double YO, double ZO, double CDE, double SDE, double CFE,
-                               double SFE);
+  PO_TRANS_output PO_TRANS(double XO, double YO, double ZO, double CDE, double SDE, double CFE,
+                           double SFE);
   PO_SELSX2_output PO_SELSX2(double XMIN[2], double XMAX[2], double AS1, double AS2);
   double PO_RNDBET(double GAM, double ETA);
   double PO_RNDGAM(double ETA);
   void lund_frag(double SQS);
+  // LUEXEC for records of one or two strings of two light partons each (useSimpleStrings).
+  // false: another configuration, left to LUEXEC
+  bool fragmentSimpleStrings();
   void lund_put(int I, int IFL, double PX, double PY, double PZ, double EE);
   lund_get_output lund_get(int I);
   int ICON_PDG_SIB(int ID);
   double PO_XLAM(double X, double Y, double Z);
   double RNDM();
-  double Pl(double x, double xth, double xmax, double alpha);
-  double Ef(double x, double th, double w);
-  double breitwigner(double sigma_0, double Gamma, double DMM, double eps_prime);
+  static double Pl(double x, double xth, double xmax, double alpha);
+  static double Ef(double x, double th, double w);
+  static double breitwigner(double sigma_0, double Gamma, double DMM, double eps_prime);
 };
 
+template <typename Sink>
+int sophia_interface::visitEvent(const particle_filter& filter, Sink&& sink) const {
+  int nPassed = 0;
+  for (int i = 0; i < np; ++i) {
+    if (p[3][i] < filter.Emin) continue;  // cheapest test first
+    const int pdgID = ID_sophia_to_PDG(LLIST[i]);
+    if (!filter.accepts(pdgID)) continue;
+    sink(event_particle{pdgID, p[0][i], p[1][i], p[2][i], p[3][i], p[4][i], weight[i]});
+    nPassed++;
+  }
+  return nPassed;
+}
+
 #endif
@@ -0,0 +1,106 @@
+#ifndef SOPHIA_IO_H
+#define SOPHIA_IO_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "sophia_batch.h"
+#include "sophia_interface.h"
+
+/*
+    Compact binary event files, a replacement of the former CSV output of execute_sophia.
+
+    layout (native byte order, i.e. little endian on all supported platforms):
+      header       sophiafile_header, 96 bytes
+      data         particle columns in blocks of blockSize particles. Each block holds its n
+                   particles (n = blockSize except for the last one) as column arrays
+                     int32 pdgID[n], px[n], py[n], pz[n], E[n], m[n], weight[n]
+                   with momenta and statistical weights (1 without thinning) as float64, or
+                   as float32 if singlePrecision is set.
+      index        uint64 eventStart[nEvents + 1]: particles of event k are the particles
+                   eventStart[k] ... eventStart[k + 1] - 1 of the file, at byte indexOffset
+
+    All block sizes follow from the header, thus the file can be memory-mapped and every
+    particle addressed directly. sophia_reader does the same with block-wise buffered reads.
+*/
+
+struct sophiafile_header {
+  char magic[8] = {'S', 'O', 'P', 'H', 'I', 'A', 'E', 'V'};
+  uint32_t version = 1;
+  uint32_t singlePrecision = 0;  // 1: momenta stored as float32
+  uint32_t blockSize = 65536;    // particles per block
+  int32_t L0 = 13;               // incident nucleon: 13 proton, 14 neutron
+  int32_t chargedPionsStable = 0;
+  uint32_t reserved = 0;
+  double Ein = 0.;  // GeV
+  double eps = 0.;  // GeV
+  uint64_t seed = 0;
+  uint64_t nEvents = 0;     // set by sophia_writer::close
+  uint64_t nParticles = 0;  // set by sophia_writer::close
+  uint64_t indexOffset = 0;  // set by sophia_writer::close
+  uint64_t reserved2[2] = {0, 0};
+};
+
+class sophia_writer {
+ public:
+  // the counters of header are ignored, they are filled in by close()
+  sophia_writer(const std::string& filename, const sophiafile_header& header);
+  ~sophia_writer();
+
+  // append the last event generated by SI, or all events of a batch
+  void write(const sophia_interface& SI);
+  void write(const sophiabatch_output& sbo);
+
+  // write the last block, the index and the final header. Called by the destructor as well.
+  void close();
+
+ private:
+  void addParticle(int sophiaID, double px, double py, double pz, double E, double m,
+                   double weight);
+  void endEvent() { eventStart.push_back(nParticles); }
+  void flushBlock();
+
+  std::ofstream file;
+  sophiafile_header header;
+  uint64_t nParticles = 0;
+  std::vector<uint64_t> eventStart;
+  std::vector<int32_t> blockID;
+  std::vector<double> blockP[6];  // px, py, pz, E, m, weight
+  std::vector<float> buffer;      // float32 conversion
+  bool isOpen = false;
+};
+
+class sophia_reader {
+ public:
+  explicit sophia_reader(const std::string& filename);
+
+  const sophiafile_header& getHeader() const { return header; }
+  long long getNEvents() const { return header.nEvents; }
+  int getNout(long long event) const;
+  // first particle of event, counted over the whole file
+  uint64_t getEventStart(long long event) const { return eventStart.at(event); }
+
+  // PDG ID, px, py, pz, E, m (j = 0 ... 4) and weight of particle i of an event
+  int getPdgID(long long event, int i);
+  double getPartP(long long event, int i, int j);
+  double getWeight(long long event, int i);
+
+  // a whole event, as written by sophia_interface::sophiaevent. Returns Nout.
+  int readEvent(long long event, sophiaevent_buffer& output);
+
+ private:
+  void loadBlock(uint64_t block);
+  void locate(long long event, int i, uint64_t& block, uint64_t& index);
+
+  std::ifstream file;
+  sophiafile_header header;
+  std::vector<uint64_t> eventStart;
+  uint64_t loadedBlock = ~uint64_t(0);
+  std::vector<int32_t> blockID;
+  std::vector<double> blockP[6];  // px, py, pz, E, m, weight
+  std::vector<float> buffer;
+};
+
+#endif
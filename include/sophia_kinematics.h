@@ -0,0 +1,30 @@
+#ifndef SOPHIA_KINEMATICS_H
+#define SOPHIA_KINEMATICS_H
+
+/*
+    Rotations and Lorentz boosts of a contiguous range of particles in a component-major
+    record (px[i], py[i], pz[i], E[i] as in the event records p, P and V).
+
+    Every particle is transformed with the same operations in the same order as the former
+    per-particle code (PO_TRANS + PO_ALTRA, the boost loops of LUDBRB and DECPAR_nonZero),
+    thus results are bit-identical to it. On x86-64 an AVX2 version (4 particles per step,
+    multiplications, additions and divisions only, no FMA) is chosen at run time if the CPU
+    supports it; otherwise, and on other platforms, a plain loop that compilers vectorise.
+*/
+
+// PO_TRANS rotation (by de around y, then by fe around z; cde = cos(de), ...) followed by the
+// PO_ALTRA boost with Lorentz factor GA and GA * beta = (BGX, BGY, BGZ), as used in eventgen
+void rotateBoost(double* px, double* py, double* pz, double* E, int n, double CDE, double SDE,
+                 double CFE, double SFE, double GA, double BGX, double BGY, double BGZ);
+
+// boost with velocity (BX, BY, BZ) and Lorentz factor GA, as in LUDBRB and DECPAR_nonZero:
+//   p += GA * (GA * (B p) / (1 + GA) + E) * B,   E = GA * (E + B p)
+// particles with status[i] <= 0 are left alone (status may be nullptr: all particles)
+void boost(double* px, double* py, double* pz, double* E, int n, double BX, double BY,
+           double BZ, double GA, const int* status = nullptr);
+
+// the AVX2 versions are used (can be switched off, e.g. for comparisons)
+bool kinematicsUsesAVX2();
+void setKinematicsAVX2(bool enable);
+
+#endif
@@ -0,0 +1,110 @@
+#ifndef SOPHIA_PARTICLES_H
+#define SOPHIA_PARTICLES_H
+
+#include <stdexcept>
+
+/*
+    Properties of the 49 SOPHIA particles (list in sophia_data.h) as compile-time constants,
+    entry i - 1 belongs to SOPHIA ID i. Negative IDs denote the antibaryons, see LBARP.
+
+    The FORTRAN arrays AM, ICHP, IBAR and LBARP are these columns, thus e.g. AM[L0 - 1] with a
+    known L0 is folded by the compiler. getParticle, sophiaToPDG and PDGToSophia are constexpr
+    as well; ID_sophia_to_PDG, the conversion of the output, is one table load.
+    Only the stability flags (IDB) are changed at run time; every engine has its own copy of
+    them, see sophia_parameters.
+*/
+
+struct particle_data {
+  double mass;       // GeV
+  int charge;        // units of e
+  int baryon;        // baryon number
+  int pdgID;         // PDG Monte Carlo ID (p: 2212)
+  int antiparticle;  // SOPHIA ID
+};
+
+struct particle_table {
+  static const int nParticles = 49;
+
+  static constexpr double mass[49] = {0., 0.511e-3, 0.511e-3, 0.10566, 0.10566, 0.13497, 0.13957,
+                                      0.13957, 0.49365, 0.49365, 0.49767, 0.49767, 0.93827, 0.93957,
+                                      0., 0., 0., 0., 0.93827, 0.93957, 0.49767, 0.49767, 0.54880,
+                                      0.95750, 0.76830, 0.76830, 0.76860, 0.89183, 0.89183, 0.89610,
+                                      0.89610, 0.78195, 1.01941, 1.18937, 1.19255, 1.19743, 1.31490,
+                                      1.32132, 1.11563, 1.23100, 1.23500, 1.23400, 1.23300, 1.38280,
+                                      1.38370, 1.38720, 1.53180, 1.53500, 1.67243};
+  static constexpr int charge[49] = {0, 1, -1, 1, -1, 0, 1, -1, 1, -1, 0, 0, 1, 0, 0, 0, 0, 0, -1,
+                                     0, 0, 0, 0, 0, 1, -1, 0, 1, -1, 0, 0, 0, 0, 1, 0, -1, 0, -1, 0,
+                                     2, 1, 0, -1, 1, 0, -1, 0, -1, -1};
+  static constexpr int baryon[49] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, -1, -1,
+                                     0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
+                                     1, 1, 1, 1, 1, 1, 1, 1};
+  static constexpr int pdgID[49] = {22, -11, 11, -13, 13, 111, 211, -211, 321, -321, 130, 310, 2212,
+                                    2112, 12, -12, 14, -14, -2212, -2112, 311, -311, 221, 331, 213,
+                                    -213, 113, 323, -323, 313, -313, 223, 333, 3222, 3212, 3112,
+                                    3322, 3312, 3122, 2224, 2214, 2114, 1114, 3224, 3214, 3114,
+                                    3324, 3314, 3334};
+  static constexpr int antiparticle[49] = {1, 3, 2, 5, 4, 6, 8, 7, 10, 9, 11, 12, -13, -14, 16, 15,
+                                           18, 17, 13, 14, 22, 21, 23, 24, 26, 25, 27, 29, 28, 31,
+                                           30, 32, 33, -34, -35, -36, -37, -38, -39, -40, -41, -42,
+                                           -43, -44, -45, -46, -47, -48, -49};
+  // ID_sophia_to_PDG: PDG IDs with nucleons as nuclei (p: 1000010010), index SOPHIA ID + 49,
+  // 0: no such particle
+  static constexpr int outputID[99] = {-3334, -3314, -3324, -3114, -3214, -3224, -1114, -2114,
+                                       -2214, -2224, -3122, -3312, -3322, -3112, -3212, -3222, 0, 0,
+                                       0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                                       -1000000010, -1000010010, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                                       0, 22, -11, 11, -13, 13, 111, 211, -211, 321, -321, 130, 310,
+                                       1000010010, 1000000010, 12, -12, 14, -14, -1000010010,
+                                       -1000000010, 311, -311, 221, 331, 213, -213, 113, 323, -323,
+                                       313, -313, 223, 333, 3222, 3212, 3112, 3322, 3312, 3122,
+                                       2224, 2214, 2114, 1114, 3224, 3214, 3114, 3324, 3314, 3334};
+};
+
+// the FORTRAN names
+constexpr const double* AM = particle_table::mass;           // masses in GeV
+constexpr const int* ICHP = particle_table::charge;          // charges
+constexpr const int* IBAR = particle_table::baryon;          // baryon numbers
+constexpr const int* LBARP = particle_table::antiparticle;  // SOPHIA IDs of the antiparticles.
+                                                             // Antibaryons: negative IDs
+
+constexpr bool isSophiaID(int sophiaID) {
+  return sophiaID >= -particle_table::nParticles && sophiaID <= particle_table::nParticles &&
+         particle_table::outputID[sophiaID + particle_table::nParticles] != 0;
+}
+
+// properties of sophiaID; antibaryons get the negated quantum numbers
+constexpr particle_data getParticle(int sophiaID) {
+  if (!isSophiaID(sophiaID)) throw std::runtime_error("getParticle: unknown particle ID");
+  const int i = (sophiaID < 0 ? -sophiaID : sophiaID) - 1;
+  const int sign = (sophiaID < 0) ? -1 : 1;
+  return particle_data{particle_table::mass[i], sign * particle_table::charge[i],
+                       sign * particle_table::baryon[i], sign * particle_table::pdgID[i],
+                       (sophiaID < 0) ? -sophiaID : particle_table::antiparticle[i]};
+}
+
+constexpr int sophiaToPDG(int sophiaID) { return getParticle(sophiaID).pdgID; }
+
+// inverse of sophiaToPDG as in ICON_PDG_SIB: baryons by |pdgID| with the sign of pdgID, thus
+// -2212 gives -13 (not 19). 0 if there is no such SOPHIA particle.
+constexpr int PDGToSophia(int pdgID) {
+  const bool isBaryon = pdgID > 1000 || pdgID < -1000;
+  const int id = (isBaryon && pdgID < 0) ? -pdgID : pdgID;
+  for (int i = 0; i < particle_table::nParticles; ++i) {
+    if (particle_table::pdgID[i] == id) return (isBaryon && pdgID < 0) ? -(i + 1) : i + 1;
+  }
+  return 0;
+}
+
+// SOPHIA ID to the PDG ID of the output, nucleons as nuclei (p: 1000010010, n: 1000000010)
+inline int ID_sophia_to_PDG(int sophiaID) {
+  if (sophiaID < -particle_table::nParticles || sophiaID > particle_table::nParticles ||
+      particle_table::outputID[sophiaID + particle_table::nParticles] == 0)
+    throw std::runtime_error("ID_sophia_to_PDG: unkown particle ID");
+  return particle_table::outputID[sophiaID + particle_table::nParticles];
+}
+
+static_assert(getParticle(13).mass == 0.93827 && sophiaToPDG(-13) == -2212, "particle table");
+static_assert(PDGToSophia(2212) == 13 && PDGToSophia(-2212) == -13 && PDGToSophia(-211) == 8,
+              "particle table");
+
+#endif
@@ -0,0 +1,122 @@
+#ifndef SOPHIA_RANDOM_H
+#define SOPHIA_RANDOM_H
+
+/*
+    Random number generator state of one SOPHIA/JETSET engine.
+
+    This is the RANMAR algorithm (G. Marsaglia, A. Zaman and W.W. Tsang) as implemented in
+    JETSET's RLU. It used to live in file-scope statics, so all sophia_interface objects of a
+    process shared (and corrupted) one stream. Every engine now owns one of these.
+
+    legacy mode: constructing with the default seed 19780503 reproduces bit by bit the sequence
+    of the original FORTRAN SOPHIA and of the former global RLU.
+
+    seeds: RANMAR accepts seeds in [0, maxSeed]. Distinct seeds give distinct, non-overlapping
+    (for all practical purposes) sequences. setSubstream(runSeed, stream) selects substream
+    "stream" (e.g. a thread, chunk or event index) of run runSeed. For RANMAR this is the seed
+    substreamSeed(runSeed, 0), skipped ahead to stream 2^44 (plus a 2^88 offset from the run
+    hash): every substream has 2^44 numbers of its own, and the streams of one run never
+    coincide (stream < maxStreams). Two run seeds share streams only if 62 bits of their
+    hashes agree.
+
+    algorithms: RANMAR (default, bit-exact legacy) draws one number at a time. XOSHIRO256 is
+    xoshiro256++ (D. Blackman, S. Vigna) in four interleaved lanes which fills a block of
+    bufferSize uniforms at once in a branch-free loop; RLU() then only reads the next entry.
+    Its uniforms are multiples of 2^-52 in (0, 1). The sequences of the two algorithms for the
+    same seed are unrelated.
+
+    random access: skip(n) advances RANMAR by n raw generator steps without drawing them, in
+    O(97^2 log n) operations (jump polynomial of its lagged Fibonacci recurrence). A raw step
+    is one RLU() call unless RANMAR rejects its result (0 or 1, probability 2^-24), which
+    takes another step; skip(n) thus equals n RLU() calls only if none of them is rejected.
+    Positions count raw steps, so a state recorded as getPosition() is restored by
+    setSeed(seed) + skip(position) in any case. Event-keyed
+    streams are setSubstream(runSeed, event) per event, about 30 us for RANMAR (the jump).
+    With XOSHIRO256, setSubstream derives the full state from (runSeed, stream) instead.
+*/
+class sophia_random {
+ public:
+  static const int legacySeed = 19780503;
+  static const int maxSeed = 900000000;
+  static const int bufferSize = 256;  // uniforms per block, XOSHIRO256 only
+  static const int lanes = 4;
+  static const int streamBits = 44;  // RANMAR: numbers per substream 2^streamBits
+  static const unsigned long long maxStreams = 1ULL << streamBits;
+
+  enum algorithm_type { RANMAR, XOSHIRO256 };
+
+  explicit sophia_random(int seed = legacySeed, algorithm_type algorithm = RANMAR);
+
+  // switch the algorithm and restart it from the current seed
+  void setAlgorithm(algorithm_type algorithm);
+  algorithm_type getAlgorithm() const { return algorithm; }
+
+  // restart the generator from the beginning of the sequence belonging to seed
+  void setSeed(int seed);
+  // restart the generator from the beginning of substream "stream" of run "runSeed"; RANMAR
+  // needs stream < maxStreams
+  void setSubstream(unsigned long long runSeed, unsigned long long stream);
+  int getSeed() const { return seed; }
+
+  // RANMAR only: advance by n raw steps, i.e. getPosition() by n. The skipped steps count as
+  // drawn numbers (getCount() += n), as their rejections are not known without drawing.
+  void skip(unsigned long long n);
+  // steps of the generator since the last (re-)seeding: getCount() plus the internal
+  // rejections of RANMAR (probability 2^-24 per number)
+  long long getPosition() const {
+    return (algorithm == XOSHIRO256) ? getCount() : getCount() + nRejected;
+  }
+
+  // number of random numbers drawn since the last (re-)seeding
+  long long getCount() const {
+    if (algorithm == XOSHIRO256) return bufferSize * (nBlocks - 1) + bufferIndex;
+    return 1000000000LL * (MRLU[1] - 1) + MRLU[2];
+  }
+
+  // uniform random number in (0, 1), endpoints excluded
+  double RLU() {
+    if (algorithm == RANMAR) return RLU_RANMAR();
+    if (bufferIndex == bufferSize) fillBuffer();
+    return buffer[bufferIndex++];
+  }
+  double operator()() { return RLU(); }
+
+  // seed in [0, maxSeed] derived from (runSeed, stream); the RANMAR substreams of run runSeed
+  // start from substreamSeed(runSeed, 0)
+  static int substreamSeed(unsigned long long runSeed, unsigned long long stream);
+  // 64 bit hash of (a, b), the splitmix64 finalizer
+  static unsigned long long hash(unsigned long long a, unsigned long long b);
+
+ private:
+  double RLU_RANMAR();
+  void fillBuffer();
+
+  void restart();
+  void initRANMAR();
+  void jumpToRun();
+  void jumpToStream();
+
+  algorithm_type algorithm;
+  int seed;
+  // last setSubstream, which has precedence over seed for XOSHIRO256
+  bool isSubstream = false;
+  unsigned long long substreamKey[2];
+
+  // RANMAR
+  int MRLU[6];
+  double RRLU[100];
+  long long nRejected;
+  // RANMAR state at the offset of run runStateKey, the start of its substreams
+  bool hasRunState = false;
+  unsigned long long runStateKey;
+  int runMRLU[6];
+  double runRRLU[100];
+
+  // XOSHIRO256: state word j of lane l in state[j][l]
+  unsigned long long state[4][lanes];
+  double buffer[bufferSize];
+  int bufferIndex;
+  long long nBlocks;  // blocks filled since seeding
+};
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef SOPHIA_RATES_H
+#define SOPHIA_RATES_H
+
+#include <string>
+#include <vector>
+
+/*
+    Photo-pion interaction rates of nucleons in isotropic photon fields, from the same total
+    cross section (crossection_analytic, NDIR = 3) that the event generation samples:
+
+      rate(gamma) = 1 / (2 gamma^2) int deps n(eps) / eps^2 I(2 gamma eps)
+      I(x)        = int_xth^x dx' x' sigma(x')
+
+    with the photon energy eps in the lab frame, x = eps_prime in the nucleon rest frame and
+    the threshold xth. I(x) does not depend on the photon field, it is integrated once per
+    nucleon when the interaction_rate is constructed (cumulative Gauss-Legendre table, as
+    functs_table). The outer integral uses the gaussInt nodes in ln(eps) on every interval of
+    the photon field table (split to at most 0.1 in ln(eps)), weighted with n(eps) once per
+    field and reused for all Lorentz factors.
+
+    units: eps in GeV, n(eps) in 1 / (GeV cm^3), rates in 1 / cm.
+*/
+
+// isotropic photon field: spectral number density n(eps), log-log interpolated, 0 outside
+struct photon_field {
+  std::vector<double> eps;      // GeV, ascending
+  std::vector<double> density;  // n(eps) in 1 / (GeV cm^3), > 0
+
+  double getDensity(double e) const;
+
+  // Planck spectrum of temperature T (K), e.g. 2.7255 for the CMB
+  static photon_field blackBody(double temperature, int nPoints = 1000);
+};
+
+class interaction_rate {
+ public:
+  // - L0: 13 proton, 14 neutron
+  explicit interaction_rate(int L0, int pointsPerDecade = 500, double xMax = 1e12);
+
+  // I(x) in GeV^2 mubarn, see above
+  double innerIntegral(double x) const;
+
+  // rate in 1 / cm of a nucleon with Lorentz factor gamma
+  double rate(const photon_field& field, double gamma) const;
+
+  // rates for many Lorentz factors in parallel (nThreads <= 0: all hardware threads)
+  std::vector<double> rates(const photon_field& field, const std::vector<double>& gamma,
+                            int nThreads = 0) const;
+
+  int getL0() const { return L0; }
+  double getXth() const { return xth; }  // threshold eps_prime
+
+ private:
+  int L0;
+  double xth;
+  double xMax;
+  double lnXth;
+  double invStep;
+  int nPoints;
+  std::vector<double> x;           // grid, log spaced from xth to xMax
+  std::vector<double> integrand;   // x sigma(x) at the grid points
+  std::vector<double> cumulative;  // I at the grid points
+};
+
+/*
+    Photon energies of photo-pion interactions in a photon field. For a nucleon with Lorentz
+    factor gamma the interacting photon follows the integrand of the rate,
+      p(eps) ~ n(eps) / eps^2 I(2 gamma eps),
+    whose cumulative over ln(eps) is tabulated once per field on a grid of Lorentz factors.
+    Sampling is a bisection in the cumulative interpolated linearly in ln(gamma), then ln(eps)
+    uniform inside the interval found (at most 0.05 wide). s for the photon energy then follows
+    from functs_table, see sophia_interface::generateEvent.
+*/
+class photon_field_sampler {
+ public:
+  explicit photon_field_sampler(const photon_field& field, double gammaMin = 1e6,
+                                double gammaMax = 1e14, int pointsPerDecade = 20);
+
+  // eps in GeV for nucleon L0 (13 proton, 14 neutron), from two uniform random numbers
+  double sampleEps(int L0, double gamma, double r1, double r2) const;
+
+  double getGammaMin() const { return gammaNode.front(); }
+  double getGammaMax() const { return gammaNode.back(); }
+
+ private:
+  std::vector<double> gammaNode;
+  double lnGammaMin;
+  double invStep;
+  std::vector<double> lnLow, lnHigh;  // ln(eps) intervals
+  double xth[2];
+  // per nucleon: cumulative[i * (lnLow.size() + 1) + j], up to interval j at gammaNode[i]
+  std::vector<double> cumulative[2];
+};
+
+// text table "gamma  rate_proton  rate_neutron" with rates in 1 / Mpc, as used by CRPropa
+void writeRateTable(const std::string& filename, const photon_field& field,
+                    const std::vector<double>& gamma, int nThreads = 0);
+
+#endif
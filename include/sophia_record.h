@@ -0,0 +1,43 @@
+#ifndef SOPHIA_RECORD_H
+#define SOPHIA_RECORD_H
+
+#include <algorithm>
+#include <vector>
+
+/*
+    Event record with the layout of the JETSET/SOPHIA common blocks: record[j][i] is field j of
+    entry i (e.g. px, py, pz, E, m), the entries of one field are contiguous. It replaces the
+    fixed arrays K[5][4000], P[5][4000], V[5][4000] and p[5][2000]: the capacity starts small
+    and grows on demand, so that an engine holds (and touches) only the rows its events need.
+
+    grow() keeps the first nLow and the last nHigh entries of every field, the latter at the
+    end of the new capacity. New entries are zero. Pointers into the record become invalid.
+*/
+template <typename T, int nFields>
+class event_record {
+ public:
+  explicit event_record(int capacity = 0) : capacity(capacity), data(nFields * capacity, T()) {}
+
+  T* operator[](int j) { return data.data() + j * capacity; }
+  const T* operator[](int j) const { return data.data() + j * capacity; }
+  int getCapacity() const { return capacity; }
+
+  void grow(int newCapacity, int nLow, int nHigh = 0) {
+    if (newCapacity <= capacity) return;
+    std::vector<T> newData(nFields * newCapacity, T());
+    for (int j = 0; j < nFields; ++j) {
+      const T* field = data.data() + j * capacity;
+      T* newField = newData.data() + j * newCapacity;
+      std::copy(field, field + nLow, newField);
+      std::copy(field + capacity - nHigh, field + capacity, newField + newCapacity - nHigh);
+    }
+    data.swap(newData);
+    capacity = newCapacity;
+  }
+
+ private:
+  int capacity;
+  std::vector<T> data;
+};
+
+#endif
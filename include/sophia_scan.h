@@ -0,0 +1,65 @@
+#ifndef SOPHIA_SCAN_H
+#define SOPHIA_SCAN_H
+
+#include <string>
+#include <vector>
+
+#include "sophia_batch.h"
+
+/*
+    Parameter scans over (nucleon, Ein, eps) grids that are spread over several processes
+    (ranks), e.g. the nodes of a cluster. Used by scan_sophia (src/scan_sophia.cpp).
+
+    Every grid point is a run of generateSpectra with its own seed scanSeed(runSeed, point).
+    Its RNG substreams are those of that run seed (see sophia_random.h): the points of a scan
+    share them only if 62 bits of the hashes of their seeds agree, even for RANMAR.
+    The run is cut into jobs of at most eventsPerJob events at multiples of the chunk size,
+    which are distributed over the ranks by estimated cost (estimateCost times events, longest
+    job first to the least loaded rank). The jobs of a rank are generated with all its threads.
+
+    Job boundaries depend on the input only, and merging the job spectra of a point in job
+    order gives the spectra of the whole run (see generateSpectra). The merged result is
+    therefore the same for any number of ranks and threads.
+*/
+
+struct scan_job {
+  int point;       // index in the grid
+  int firstEvent;  // events firstEvent ... firstEvent + nEvents - 1 of the run of point
+  int nEvents;
+  double cost;  // estimated, in units of a resonance event
+};
+
+// all combinations nucleon x Ein x eps, eps running fastest
+std::vector<interaction_request> scanGrid(const std::vector<double>& Ein,
+                                          const std::vector<double>& eps, bool protons = true,
+                                          bool neutrons = true);
+
+// seed of the run of grid point "point", independent of runSeed + point (a 64 bit hash)
+unsigned long long scanSeed(unsigned long long runSeed, int point);
+
+// nEventsPerPoint events per point in jobs of at most eventsPerJob events; jobs of one point are
+// consecutive. eventsPerJob is rounded up to a multiple of chunkSize.
+std::vector<scan_job> scanJobs(const std::vector<interaction_request>& points,
+                               int nEventsPerPoint, int eventsPerJob,
+                               int chunkSize = batchChunkSize);
+
+// rank (0 ... size - 1) of every job
+std::vector<int> assignJobs(const std::vector<scan_job>& jobs, int size);
+
+// spectra of job (booking as in generateSpectra)
+sophia_spectra runJob(const std::vector<interaction_request>& points, const scan_job& job,
+                      int nThreads, unsigned long long runSeed, const sophia_spectra& booking,
+                      bool declareChargedPionsStable = false,
+                      const sophia_parameters& parameters = sophia_parameters(),
+                      int chunkSize = batchChunkSize);
+
+// the merged spectra of every point, from the job spectra in job order
+std::vector<sophia_spectra> mergeJobs(const std::vector<scan_job>& jobs,
+                                      const std::vector<sophia_spectra>& jobSpectra,
+                                      size_t nPoints);
+
+// file names of the outputs: prefix.job<j>.txt and prefix.point<k>.txt
+std::string jobFileName(const std::string& prefix, int job);
+std::string pointFileName(const std::string& prefix, int point);
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef SOPHIA_SPECTRA_H
+#define SOPHIA_SPECTRA_H
+
+#include <string>
+#include <vector>
+
+#include "sophia_interface.h"
+
+/*
+    Energy spectra of the secondaries, accumulated straight from the event record instead of
+    writing every particle to a file and binning afterwards.
+
+    binning: nBins logarithmic bins of x = E / Ein in [xMin, xMax], per booked species (PDG IDs
+    as in ID_sophia_to_PDG) and per interaction mode Imode 0 ... 6 of dec_inter3. Each bin
+    holds the sum of the particle weights (1 without thinning) and of their squares; particles
+    outside [xMin, xMax) and unbooked species are not counted.
+
+    Histograms with the same booking are added with merge(). generateSpectra (sophia_batch.h)
+    fills one of them per worker thread and merges them at the end.
+*/
+class sophia_spectra {
+ public:
+  static const int nModes = 7;
+
+  // pdgIDs empty: the stable particles of SOPHIA, i.e. photons, e+-, neutrinos, (anti-)nucleons
+  // and pions (if declared stable)
+  explicit sophia_spectra(const std::vector<int>& pdgIDs = std::vector<int>(), int nBins = 100,
+                          double xMin = 1e-8, double xMax = 1.);
+
+  // particles of the last event of SI, whose nucleon had energy Ein (GeV)
+  void fill(const sophia_interface& SI, double Ein);
+  // add the entries of other, which must have the same booking
+  void merge(const sophia_spectra& other);
+  void clear();
+
+  int getNBins() const { return nBins; }
+  double getXMin() const { return xMin; }
+  double getXMax() const { return xMax; }
+  // lower edge of bin i, i = nBins: upper edge of the last bin
+  double getEdge(int i) const;
+  const std::vector<int>& getPdgIDs() const { return pdgIDs; }
+
+  long long getNEvents() const { return nEvents; }
+  long long getNEvents(int Imode) const { return nEventsMode[Imode]; }
+  // sum of weights in bin i of species pdgID, one interaction mode or all (Imode < 0)
+  double getSum(int pdgID, int i, int Imode = -1) const;
+  double getSumSquares(int pdgID, int i, int Imode = -1) const;
+  // flat access, entry ((species * nModes) + Imode) * nBins + i
+  const std::vector<double>& getSums() const { return sum; }
+  const std::vector<double>& getSumsSquares() const { return sum2; }
+
+  // text table of the non-empty bins: pdgID Imode xLow xHigh sum sumSquares, after three
+  // comment lines with the booking and the event counts
+  void write(const std::string& filename) const;
+  // a file of write(), exactly
+  static sophia_spectra read(const std::string& filename);
+
+ private:
+  int species(int pdgID) const;
+
+  std::vector<int> pdgIDs;
+  int nBins;
+  double xMin, xMax;
+  double binsPerLn;  // nBins / ln(xMax / xMin)
+  // species index per SOPHIA ID + 49, -1: not booked
+  int speciesOfID[2 * particle_table::nParticles + 1];
+
+  long long nEvents = 0;
+  long long nEventsMode[nModes] = {0};
+  std::vector<double> sum;
+  std::vector<double> sum2;
+};
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef SOPHIA_STATISTICS_H
+#define SOPHIA_STATISTICS_H
+
+#include <chrono>
+
+/*
+    Run-time statistics of one engine: how often the samplers reject, which interaction modes
+    occur, how often the fragmentation fails and where the time goes.
+
+    The counting is done via SOPHIA_STAT(statement) which compiles to nothing if
+    SOPHIA_NO_STATISTICS is defined (cmake -DENABLE_STATISTICS=OFF). The struct itself always
+    exists, it then simply stays zero.
+
+    Times are inclusive wall clock times in seconds, thus tEventgen contains tFragmentation and
+    tDecay.
+*/
+#ifdef SOPHIA_NO_STATISTICS
+#define SOPHIA_STAT(statement)
+#else
+#define SOPHIA_STAT(statement) statement
+#endif
+
+struct sophia_statistics {
+  long long nEvents = 0;           // generateEvent calls
+  long long nRandom = 0;           // random numbers drawn inside generateEvent
+  long long nSample = 0;           // sample_s calls
+  long long nSampleRejected = 0;   // rejected trials of the sample_s rejection method
+  long long nImode[7] = {0};       // interaction modes chosen by dec_inter3, see eventgen
+  long long nGammaRetries = 0;     // restarts of the string setup in gamma_h
+  long long nSelsxRejected = 0;    // rejected string end trials in PO_SELSX2
+  long long nFragmentation = 0;    // lund_frag calls
+  long long nFragmentationFailed = 0;  // lund_frag calls rejected by JETSET (MSTU(24) != 0)
+  long long nDecays = 0;           // particles decayed by DECSIB
+
+  double tSample = 0.;         // sample_s
+  double tEventgen = 0.;       // eventgen
+  double tFragmentation = 0.;  // lund_frag
+  double tDecay = 0.;          // DECSIB
+
+  void reset() { *this = sophia_statistics(); }
+};
+
+// adds the lifetime of the object to seconds
+class sophia_timer {
+ public:
+  explicit sophia_timer(double& seconds)
+      : seconds(seconds), start(std::chrono::steady_clock::now()) {}
+  ~sophia_timer() {
+    seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  }
+
+ private:
+  double& seconds;
+  std::chrono::steady_clock::time_point start;
+};
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef SOPHIA_YIELD_H
+#define SOPHIA_YIELD_H
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "sophia_interface.h"
+
+/*
+    Fast yield mode: secondaries as energy fractions of the incident nucleon, drawn from a
+    precomputed library of full SOPHIA events instead of running the event generation
+    (lund_frag, LUEXEC, DECSIB) for every interaction.
+
+    For each point of a log grid in eps_prime (photon energy in the nucleon rest frame)
+    build() generates eventsPerPoint events with the full generator for an ultra-relativistic
+    nucleon (Ein = 1e12 GeV, where the energy fractions depend on eps_prime only) and stores
+    PDG ID and x = E / Ein of all final particles. The channel mix of dec_inter3 (Imode), the
+    correlations between the secondaries and energy conservation are thus kept per event.
+    sample() picks one of the two neighbouring grid points with linear weights in
+    ln(eps_prime) and one of its events.
+
+    file (native byte order): yieldfile_header, uint64 eventStart[nPoints * eventsPerPoint + 1],
+    int32 pdgID[nParticles], float32 x[nParticles].
+*/
+
+struct yieldfile_header {
+  char magic[8] = {'S', 'O', 'P', 'H', 'I', 'A', 'Y', 'T'};
+  uint32_t version = 1;
+  int32_t L0 = 13;  // 13 proton, 14 neutron
+  int32_t chargedPionsStable = 0;
+  uint32_t nPoints = 0;
+  uint32_t eventsPerPoint = 0;
+  uint32_t reserved = 0;
+  double epsPrimeMin = 0.;  // GeV
+  double epsPrimeMax = 0.;  // GeV
+  uint64_t seed = 0;
+  uint64_t nParticles = 0;
+};
+
+// secondaries of one interaction
+struct yield_event {
+  int Nout = 0;
+  std::vector<int> pdgID;
+  std::vector<double> x;  // E / Ein
+};
+
+class yield_table {
+ public:
+  // e.g. from file
+  explicit yield_table(const std::string& filename);
+
+  // - the grid starts at the threshold if epsPrimeMin is below it
+  // - nThreads <= 0: use all hardware threads. Grid point i is generated from RNG substream
+  //   (seed, i), thus the table does not depend on nThreads.
+  static yield_table build(int L0, bool declareChargedPionsStable, double epsPrimeMin = 0.,
+                           double epsPrimeMax = 1e4, int pointsPerDecade = 20,
+                           int eventsPerPoint = 1000, unsigned long long seed = 1,
+                           int nThreads = 0);
+
+  void save(const std::string& filename) const;
+
+  // event for eps_prime from two uniform random numbers. Returns Nout.
+  int sample(double epsPrime, double r1, double r2, yield_event& output) const;
+
+  const yieldfile_header& getHeader() const { return header; }
+  double getEpsPrime(int point) const { return std::exp(lnEpsPrimeMin + point / invStep); }
+
+ private:
+  yield_table() {}
+  void setGrid();
+
+  yieldfile_header header;
+  double lnEpsPrimeMin = 0.;
+  double invStep = 0.;
+  std::vector<uint64_t> eventStart;
+  std::vector<int32_t> pdgID;
+  std::vector<float> x;
+};
+
+// as sophiaevent, but s from sample_s and the secondaries from table. The nucleon type and
+// stable pion setting are the ones of the table. Returns Nout, energies in output.x * Ein.
+// With SI.useTabulatedSampling(true) this is ~100 times faster than multipion sophiaevent.
+int sampleYield(sophia_interface& SI, const yield_table& table, double Ein, double eps,
+                yield_event& output);
+
+#endif
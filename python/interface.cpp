@@ -1,9 +1,55 @@
+#include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
 
+#include "sophia_batch.h"
 #include "sophia_interface.h"
 
 namespace py = pybind11;
 
+// flat NumPy arrays, one entry per particle: event index, PDG id, px, py, pz, E, m (GeV), weight
+static py::dict batchToNumpy(const sophiabatch_output& sbo) {
+	const size_t n = sbo.partID.size();
+	py::array_t<int> event(n);
+	py::array_t<int> pdgID(n);
+	int* eventData = event.mutable_data();
+	int* pdgData = pdgID.mutable_data();
+	for (int k = 0; k < sbo.nEvents; ++k) {
+		for (int i = sbo.eventStart[k]; i < sbo.eventStart[k + 1]; ++i) {
+			eventData[i] = k;
+			pdgData[i] = ID_sophia_to_PDG(sbo.partID[i]);
+		}
+	}
+	py::dict arrays;
+	arrays["event"] = event;
+	arrays["pdgID"] = pdgID;
+	const char* names[5] = {"px", "py", "pz", "E", "m"};
+	for (int j = 0; j < 5; ++j) {
+		arrays[names[j]] = py::array_t<double>(n, sbo.partP[j].data());
+	}
+	arrays["weight"] = py::array_t<double>(n, sbo.partWeight.data());
+	return arrays;
+}
+
+// sums (and sums of squared weights) as arrays [species, Imode, bin], bin edges in x = E / Ein
+static py::dict spectraToNumpy(const sophia_spectra& spectra) {
+	const std::vector<size_t> shape = {spectra.getPdgIDs().size(),
+		static_cast<size_t>(sophia_spectra::nModes), static_cast<size_t>(spectra.getNBins())};
+	py::array_t<double> edges(spectra.getNBins() + 1);
+	double* edgeData = edges.mutable_data();
+	for (int i = 0; i <= spectra.getNBins(); ++i) edgeData[i] = spectra.getEdge(i);
+	std::vector<long long> nEventsMode(sophia_spectra::nModes);
+	for (int m = 0; m < sophia_spectra::nModes; ++m) nEventsMode[m] = spectra.getNEvents(m);
+	py::dict arrays;
+	arrays["pdgID"] = spectra.getPdgIDs();
+	arrays["edges"] = edges;
+	arrays["sum"] = py::array_t<double>(shape, spectra.getSums().data());
+	arrays["sumSquares"] = py::array_t<double>(shape, spectra.getSumsSquares().data());
+	arrays["nEvents"] = spectra.getNEvents();
+	arrays["nEventsMode"] = nEventsMode;
+	return arrays;
+}
+
 PYBIND11_MODULE(pysophia, m) {
 	m.doc() = "SophiaNext python binding";
 	py::class_<sophiaevent_output, std::shared_ptr<sophiaevent_output>>(m, "SophiaEventOutput")
@@ -11,12 +57,126 @@ PYBIND11_MODULE(pysophia, m) {
 		.def_readonly("Nout", &sophiaevent_output::Nout)
 		.def("getPartP", &sophiaevent_output::getPartP)
 		.def("getPartID", &sophiaevent_output::getPartID);
+	py::class_<sophia_statistics>(m, "SophiaStatistics")
+		.def_readonly("nEvents", &sophia_statistics::nEvents)
+		.def_readonly("nRandom", &sophia_statistics::nRandom)
+		.def_readonly("nSample", &sophia_statistics::nSample)
+		.def_readonly("nSampleRejected", &sophia_statistics::nSampleRejected)
+		.def_property_readonly("nImode", [](const sophia_statistics& stat) {
+			return std::vector<long long>(stat.nImode, stat.nImode + 7);
+		})
+		.def_readonly("nGammaRetries", &sophia_statistics::nGammaRetries)
+		.def_readonly("nSelsxRejected", &sophia_statistics::nSelsxRejected)
+		.def_readonly("nFragmentation", &sophia_statistics::nFragmentation)
+		.def_readonly("nFragmentationFailed", &sophia_statistics::nFragmentationFailed)
+		.def_readonly("nDecays", &sophia_statistics::nDecays)
+		.def_readonly("tSample", &sophia_statistics::tSample)
+		.def_readonly("tEventgen", &sophia_statistics::tEventgen)
+		.def_readonly("tFragmentation", &sophia_statistics::tFragmentation)
+		.def_readonly("tDecay", &sophia_statistics::tDecay);
+	py::enum_<sophia_random::algorithm_type>(m, "RandomAlgorithm")
+		.value("RANMAR", sophia_random::RANMAR)
+		.value("XOSHIRO256", sophia_random::XOSHIRO256);
 	py::class_<sophia_interface, std::shared_ptr<sophia_interface>>(m, "SophiaInterface")
-		.def(py::init<>())
-		.def("sophiaevent", &sophia_interface::sophiaevent,
+		.def(py::init<int>(), py::arg("seed") = static_cast<int>(sophia_random::legacySeed))
+		.def("setSeed", &sophia_interface::setSeed, py::arg("seed"))
+		.def("setSubstream", &sophia_interface::setSubstream,
+			py::arg("runSeed"),
+			py::arg("stream"))
+		.def("setRandomAlgorithm", &sophia_interface::setRandomAlgorithm, py::arg("algorithm"))
+		.def("reset", &sophia_interface::reset)
+		// Hillas thinning below E (GeV) for all species, or for one SOPHIA ID
+		.def("setThinningEnergy",
+			static_cast<void (sophia_parameters::*)(double)>(&sophia_parameters::setThinningEnergy),
+			py::arg("E"))
+		.def("setThinningEnergy",
+			static_cast<void (sophia_parameters::*)(int, double)>(
+				&sophia_parameters::setThinningEnergy),
+			py::arg("sophiaID"),
+			py::arg("E"))
+		.def("getStatistics", &sophia_interface::getStatistics)
+		.def("resetStatistics", &sophia_interface::resetStatistics)
+		.def("sophiaevent",
+			static_cast<sophiaevent_output (sophia_interface::*)(bool, double, double, bool)>(
+				&sophia_interface::sophiaevent),
 			py::arg("onProton"),
 			py::arg("Ein"),
 			py::arg("eps"),
+			py::arg("declareChargedPionsStable") = false)
+		// nEvents events of this engine (its random sequence continues) as NumPy arrays
+		.def("sophiaevents",
+			[](sophia_interface& SI, bool onProton, double Ein, double eps, int nEvents,
+					bool declareChargedPionsStable) {
+				sophiabatch_output sbo;
+				{
+					py::gil_scoped_release release;
+					for (int k = 0; k < nEvents; ++k) {
+						SI.generateEvent(onProton, Ein, eps, declareChargedPionsStable);
+						sbo.append(SI);
+					}
+				}
+				return batchToNumpy(sbo);
+			},
+			py::arg("onProton"),
+			py::arg("Ein"),
+			py::arg("eps"),
+			py::arg("nEvents"),
 			py::arg("declareChargedPionsStable") = false);
-}
 
+	// parallel generation, see sophia_batch.h. Result does not depend on nThreads.
+	// Only particles with E >= Emin and a PDG ID in pdgIDs (empty: all) are returned.
+	// thinningEnergy > 0: Hillas thinning of all species below it, see the "weight" array.
+	m.def("generateBatch",
+		[](bool onProton, double Ein, double eps, int nEvents, int nThreads,
+				unsigned long long seed, bool declareChargedPionsStable,
+				const std::vector<int>& pdgIDs, double Emin, double thinningEnergy) {
+			particle_filter filter;
+			filter.pdgIDs = pdgIDs;
+			filter.Emin = Emin;
+			sophia_parameters parameters;
+			parameters.setThinningEnergy(thinningEnergy);
+			sophiabatch_output sbo;
+			{
+				py::gil_scoped_release release;
+				sbo = generateBatch(onProton, Ein, eps, nEvents, nThreads, seed, filter,
+					declareChargedPionsStable, parameters);
+			}
+			return batchToNumpy(sbo);
+		},
+		py::arg("onProton"),
+		py::arg("Ein"),
+		py::arg("eps"),
+		py::arg("nEvents"),
+		py::arg("nThreads") = 0,
+		py::arg("seed") = 1,
+		py::arg("declareChargedPionsStable") = false,
+		py::arg("pdgIDs") = std::vector<int>(),
+		py::arg("Emin") = 0.,
+		py::arg("thinningEnergy") = 0.);
+
+	// histograms of secondary energies per species and Imode, see sophia_spectra.h
+	m.def("generateSpectra",
+		[](bool onProton, double Ein, double eps, int nEvents, int nThreads,
+				unsigned long long seed, bool declareChargedPionsStable,
+				const std::vector<int>& pdgIDs, int nBins, double xMin, double xMax) {
+			const sophia_spectra booking(pdgIDs, nBins, xMin, xMax);
+			sophia_spectra spectra;
+			{
+				py::gil_scoped_release release;
+				spectra = generateSpectra(onProton, Ein, eps, nEvents, nThreads, seed, booking,
+					declareChargedPionsStable);
+			}
+			return spectraToNumpy(spectra);
+		},
+		py::arg("onProton"),
+		py::arg("Ein"),
+		py::arg("eps"),
+		py::arg("nEvents"),
+		py::arg("nThreads") = 0,
+		py::arg("seed") = 1,
+		py::arg("declareChargedPionsStable") = false,
+		py::arg("pdgIDs") = std::vector<int>(),
+		py::arg("nBins") = 100,
+		py::arg("xMin") = 1e-8,
+		py::arg("xMax") = 1.);
+}
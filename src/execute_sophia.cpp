@@ -1,7 +1,8 @@
-#include <fstream>
 #include <iostream>
 
+#include "sophia_batch.h"
 #include "sophia_interface.h"
+#include "sophia_io.h"
 
 int main() {
   std::cout.precision(10);
@@ -13,36 +14,38 @@ int main() {
   bool declareChargedPionsStable = true;
   // bool declareChargedPionsStable = false;
 
-  std::ofstream outfile;
-  outfile.open("outData.csv");
-
-  outfile << "eventID\t"
-          << "partID\t"
-          << "EGeV\n";
-
   int nEvent = 10000;
-  for (int k = 0; k < nEvent; ++k) {
-    sophia_interface SI;
-
-    // std::cout << "Event # " << k + 1 << std::endl;
-
-    sophiaevent_output seo = SI.sophiaevent(onProton, Ein, eps, declareChargedPionsStable);
-
-    // std::cout << "\nevent result # " << (k + 1) << std::endl;
-    int Nout = seo.Nout;
-    // std::cout << "N = " <<Nout << std::endl;
-    for (int i = 0; i < Nout; ++i) {
-      //     std::cout << "ID = " << ID_sophia_to_PDG(seo.outPartID[i]) << std::endl;
-      for (int j = 0; j < 5; ++j) {
-        // if (j == 3) std::cout << seo.outPartP[j][i] << std::endl;
-        if (j == 3) {
-          int eventID = k + 1;
-          outfile << eventID << "\t" << ID_sophia_to_PDG(seo.outPartID[i]) << "\t"
-                  << seo.outPartP[j][i] << "\n";
-        }
-      }
-    }
-    // std::cout << "\n---------------------------------" << std::endl;
-  }
-  outfile.close();
+  int nThreads = 0;  // 0 = all hardware threads. The result does not depend on this number.
+  unsigned long long seed = 1;
+
+  // To reproduce the original (FORTRAN) SOPHIA sequence, generate the events serially with a
+  // single engine instead. Construct it once, outside the event loop, and reuse it:
+  //   sophia_interface SI;
+  //   for (...) {
+  //     sophiaevent_output seo = SI.sophiaevent(onProton, Ein, eps, declareChargedPionsStable);
+  //     SI.reset();  // optional, clears the event records used by this event
+  //   }
+  // If only the energy spectra of the secondaries are needed, histogram them in memory instead
+  // of storing every particle (sophia_spectra.h):
+  //   sophia_spectra spectra = generateSpectra(onProton, Ein, eps, nEvent, nThreads, seed,
+  //                                            sophia_spectra(), declareChargedPionsStable);
+  //   spectra.write("outSpectra.txt");
+  sophiabatch_output sbo =
+      generateBatch(onProton, Ein, eps, nEvent, nThreads, seed, declareChargedPionsStable);
+
+  // binary event file with PDG IDs, momenta and weights, read it back with sophia_reader
+  // (sophia_io.h)
+  sophiafile_header header;
+  header.L0 = onProton ? 13 : 14;
+  header.chargedPionsStable = declareChargedPionsStable;
+  header.Ein = Ein;
+  header.eps = eps;
+  header.seed = seed;
+  header.singlePrecision = 0;  // 1: store momenta and weights as float32, halves the file size
+  sophia_writer writer("outData.sophia", header);
+  writer.write(sbo);
+  writer.close();
+
+  std::cout << "wrote " << sbo.partID.size() << " particles of " << nEvent
+            << " events to outData.sophia" << std::endl;
 }
@@ -0,0 +1,114 @@
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "sophia_scan.h"
+
+#ifdef SOPHIA_MPI
+#include <mpi.h>
+#else
+// rank and size from the first of these variables which the launcher sets
+static void rankFromEnvironment(int& rank, int& size) {
+  const char* names[4][2] = {{"SOPHIA_RANK", "SOPHIA_SIZE"},
+                             {"OMPI_COMM_WORLD_RANK", "OMPI_COMM_WORLD_SIZE"},
+                             {"PMI_RANK", "PMI_SIZE"},
+                             {"SLURM_PROCID", "SLURM_NTASKS"}};
+  for (int i = 0; i < 4; ++i) {
+    const char* r = std::getenv(names[i][0]);
+    const char* s = std::getenv(names[i][1]);
+    if (r && s) {
+      rank = std::atoi(r);
+      size = std::atoi(s);
+      return;
+    }
+  }
+}
+#endif
+
+/*
+    Grid scan on many processes, see sophia_scan.h.
+
+      scan_sophia [rank size]   generate the jobs of rank, write prefix.job<j>.txt
+      scan_sophia merge         merge the job files into prefix.point<k>.txt per grid point
+
+    Without arguments rank and size are taken from the environment (SOPHIA_RANK/SOPHIA_SIZE,
+    Open MPI, PMI or SLURM), i.e. "mpirun -n 8 scan_sophia" or "srun -n 8 scan_sophia" work
+    without MPI; the merge is then started once all ranks are done. Built with MPI
+    (cmake -DENABLE_MPI=ON), rank 0 merges after the last rank has finished.
+    The output does not depend on the number of ranks or threads. Every rank runs all hardware
+    threads of its node: start one rank per node and keep the launcher from pinning it to a
+    single core (e.g. mpirun --bind-to none).
+*/
+int main(int argc, char** argv) {
+  const std::vector<double> Ein = {1e9, 1e10, 1e11, 1e12};  // GeV
+  const std::vector<double> eps = {1e-9, 1e-8, 1e-7};        // GeV
+  const std::vector<interaction_request> points = scanGrid(Ein, eps, true, true);
+  const bool declareChargedPionsStable = false;
+  const int nEventsPerPoint = 100000;
+  const int eventsPerJob = 10000;
+  const unsigned long long seed = 1;
+  const int nThreads = 0;  // 0 = all hardware threads of the node
+  const sophia_spectra booking;  // default species, 100 bins in x = E / Ein in [1e-8, 1]
+  const std::string prefix = "scanSophia";
+
+  int rank = 0;
+  int size = 1;
+  const bool merge = (argc == 2 && std::string(argv[1]) == "merge");
+#ifdef SOPHIA_MPI
+  MPI_Init(&argc, &argv);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+#else
+  rankFromEnvironment(rank, size);
+  if (argc == 3) {
+    rank = std::atoi(argv[1]);
+    size = std::atoi(argv[2]);
+  }
+#endif
+  if (!merge && (size <= 0 || rank < 0 || rank >= size)) {
+    std::cerr << "usage: scan_sophia [rank size] | scan_sophia merge" << std::endl;
+    return 1;
+  }
+
+  const std::vector<scan_job> jobs = scanJobs(points, nEventsPerPoint, eventsPerJob);
+  if (!merge) {
+    const std::vector<int> jobRank = assignJobs(jobs, size);
+    for (size_t j = 0; j < jobs.size(); ++j) {
+      if (jobRank[j] != rank) continue;
+      runJob(points, jobs[j], nThreads, seed, booking, declareChargedPionsStable)
+          .write(jobFileName(prefix, static_cast<int>(j)));
+    }
+    std::cout << "rank " << rank << " of " << size << ": jobs done" << std::endl;
+  }
+
+#ifdef SOPHIA_MPI
+  MPI_Barrier(MPI_COMM_WORLD);
+  const bool doMerge = (rank == 0);
+#else
+  const bool doMerge = merge || size == 1;
+#endif
+  if (doMerge) {
+    std::vector<sophia_spectra> jobSpectra;
+    for (size_t j = 0; j < jobs.size(); ++j) {
+      jobSpectra.push_back(sophia_spectra::read(jobFileName(prefix, static_cast<int>(j))));
+    }
+    const std::vector<sophia_spectra> spectra = mergeJobs(jobs, jobSpectra, points.size());
+    std::ofstream index(prefix + ".points.txt");
+    index.precision(10);
+    index << "# point onProton Ein eps (GeV), spectra in " << pointFileName(prefix, 0)
+          << " ...\n";
+    for (size_t k = 0; k < points.size(); ++k) {
+      spectra[k].write(pointFileName(prefix, static_cast<int>(k)));
+      index << k << ' ' << points[k].onProton << ' ' << points[k].Ein << ' ' << points[k].eps
+            << '\n';
+    }
+    std::cout << "merged " << jobs.size() << " jobs into " << points.size() << " grid points"
+              << std::endl;
+  }
+
+#ifdef SOPHIA_MPI
+  MPI_Finalize();
+#endif
+  return 0;
+}
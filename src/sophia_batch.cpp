@@ -0,0 +1,256 @@
+#include "sophia_batch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+void sophiabatch_output::append(const sophia_interface& SI) {
+  if (eventStart.empty()) eventStart.push_back(0);
+  const int np = SI.np;
+  partID.insert(partID.end(), &SI.LLIST[0], &SI.LLIST[0] + np);
+  for (int j = 0; j < 5; ++j) {
+    partP[j].insert(partP[j].end(), &SI.p[j][0], &SI.p[j][0] + np);
+  }
+  partWeight.insert(partWeight.end(), &SI.weight[0], &SI.weight[0] + np);
+  eventStart.push_back(static_cast<int>(partID.size()));
+  nEvents++;
+}
+
+void sophiabatch_output::append(const sophia_interface& SI, const particle_filter& filter) {
+  if (eventStart.empty()) eventStart.push_back(0);
+  for (int i = 0; i < SI.np; ++i) {
+    if (SI.p[3][i] < filter.Emin || !filter.accepts(ID_sophia_to_PDG(SI.LLIST[i]))) continue;
+    partID.push_back(SI.LLIST[i]);
+    for (int j = 0; j < 5; ++j) {
+      partP[j].push_back(SI.p[j][i]);
+    }
+    partWeight.push_back(SI.weight[i]);
+  }
+  eventStart.push_back(static_cast<int>(partID.size()));
+  nEvents++;
+}
+
+// number of worker threads for nChunks chunks, nThreads <= 0: all hardware threads
+static int workerCount(int nThreads, int nChunks) {
+  if (nThreads <= 0) nThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  return std::max(1, std::min(nThreads, nChunks));
+}
+
+// Generates the chunks order[0], order[1], ... on nThreads (see workerCount) workers;
+// generateChunk(SI, c, iThread) generates chunk c on worker iThread. Every chunk starts from a
+// freshly configured engine on substream (seed, c).
+template <typename ChunkGenerator>
+static void runChunks(const std::vector<int>& order, int nThreads, unsigned long long seed,
+                      const sophia_parameters& parameters, ChunkGenerator&& generateChunk) {
+  const int nChunks = static_cast<int>(order.size());
+  std::atomic<int> next(0);
+  std::vector<std::exception_ptr> errors(nThreads);
+
+  auto worker = [&](int iThread) {
+    try {
+      // ~16 kB, one per worker
+      std::unique_ptr<sophia_interface> SI(new sophia_interface(parameters));
+      for (int k = next++; k < nChunks; k = next++) {
+        const int c = order[k];
+        // same engine state at the start of every chunk, regardless of the worker
+        SI->setParameters(parameters);
+        SI->reset();
+        SI->setSubstream(seed, c);
+        generateChunk(*SI, c, iThread);
+      }
+    } catch (...) {
+      errors[iThread] = std::current_exception();
+      next = nChunks;  // let the other workers stop early
+    }
+  };
+
+  if (nThreads == 1) {
+    worker(0);
+  } else {
+    std::vector<std::thread> pool;
+    for (int t = 0; t < nThreads; ++t) pool.emplace_back(worker, t);
+    for (std::thread& thread : pool) thread.join();
+  }
+  for (std::exception_ptr& error : errors) {
+    if (error) std::rethrow_exception(error);
+  }
+}
+
+// as runChunks, generateChunk(SI, c, chunk) fills chunk c. The chunks are generated
+// independently and concatenated in order afterwards.
+template <typename ChunkGenerator>
+static std::vector<sophiabatch_output> generateChunks(const std::vector<int>& order,
+                                                      int nThreads, unsigned long long seed,
+                                                      const sophia_parameters& parameters,
+                                                      ChunkGenerator&& generateChunk) {
+  std::vector<sophiabatch_output> chunks(order.size());
+  runChunks(order, workerCount(nThreads, static_cast<int>(order.size())), seed, parameters,
+            [&](sophia_interface& SI, int c, int) { generateChunk(SI, c, chunks[c]); });
+  return chunks;
+}
+
+static sophiabatch_output mergeChunks(const std::vector<sophiabatch_output>& chunks) {
+  sophiabatch_output sbo;
+  size_t nParticles = 0;
+  for (const sophiabatch_output& chunk : chunks) {
+    sbo.nEvents += chunk.nEvents;
+    nParticles += chunk.partID.size();
+  }
+  sbo.eventStart.reserve(sbo.nEvents + 1);
+  sbo.partID.reserve(nParticles);
+  for (int j = 0; j < 5; ++j) sbo.partP[j].reserve(nParticles);
+  sbo.partWeight.reserve(nParticles);
+
+  sbo.eventStart.push_back(0);
+  for (const sophiabatch_output& chunk : chunks) {
+    const int offset = sbo.eventStart.back();
+    for (int k = 1; k < chunk.nEvents + 1; ++k) {
+      sbo.eventStart.push_back(offset + chunk.eventStart[k]);
+    }
+    sbo.partID.insert(sbo.partID.end(), chunk.partID.begin(), chunk.partID.end());
+    for (int j = 0; j < 5; ++j) {
+      sbo.partP[j].insert(sbo.partP[j].end(), chunk.partP[j].begin(), chunk.partP[j].end());
+    }
+    sbo.partWeight.insert(sbo.partWeight.end(), chunk.partWeight.begin(),
+                          chunk.partWeight.end());
+  }
+  return sbo;
+}
+
+// filter == nullptr: all particles
+static sophiabatch_output generateFilteredBatch(bool onProton, double Ein, double eps,
+                                                int nEvents, int nThreads,
+                                                unsigned long long seed,
+                                                const particle_filter* filter,
+                                                bool declareChargedPionsStable,
+                                                const sophia_parameters& parameters,
+                                                int chunkSize) {
+  if (nEvents < 0) throw std::runtime_error("generateBatch: negative number of events.");
+  if (chunkSize <= 0) throw std::runtime_error("generateBatch: chunkSize has to be positive.");
+
+  std::vector<int> order((nEvents + chunkSize - 1) / chunkSize);
+  for (size_t c = 0; c < order.size(); ++c) order[c] = static_cast<int>(c);
+
+  auto generateChunk = [&](sophia_interface& SI, int c, sophiabatch_output& chunk) {
+    const int first = c * chunkSize;
+    const int last = std::min(nEvents, first + chunkSize);
+    for (int k = first; k < last; ++k) {
+      // read the particles straight from the engine, no intermediate sophiaevent_output
+      SI.generateEvent(onProton, Ein, eps, declareChargedPionsStable);
+      if (filter) {
+        chunk.append(SI, *filter);
+      } else {
+        chunk.append(SI);
+      }
+    }
+  };
+  return mergeChunks(generateChunks(order, nThreads, seed, parameters, generateChunk));
+}
+
+sophiabatch_output generateBatch(bool onProton, double Ein, double eps, int nEvents, int nThreads,
+                                 unsigned long long seed, bool declareChargedPionsStable,
+                                 const sophia_parameters& parameters, int chunkSize) {
+  return generateFilteredBatch(onProton, Ein, eps, nEvents, nThreads, seed, nullptr,
+                               declareChargedPionsStable, parameters, chunkSize);
+}
+
+sophiabatch_output generateBatch(bool onProton, double Ein, double eps, int nEvents, int nThreads,
+                                 unsigned long long seed, const particle_filter& filter,
+                                 bool declareChargedPionsStable,
+                                 const sophia_parameters& parameters, int chunkSize) {
+  return generateFilteredBatch(onProton, Ein, eps, nEvents, nThreads, seed, &filter,
+                               declareChargedPionsStable, parameters, chunkSize);
+}
+
+double estimateCost(const interaction_request& request) {
+  const int L0 = request.onProton ? 13 : 14;
+  const double pm = AM[L0 - 1];
+  // s is sampled from (s - pm^2) sigma(s) up to pm^2 + 4 Ein eps: typically the upper half
+  const double epsPrime = request.Ein * request.eps / pm;
+  const double s = pm * pm + 2. * pm * epsPrime;
+  if (!(s > 1.1646)) return 1.;  // below threshold, no event
+  const crossection_output xco = sophia_interface::crossections_analytic(epsPrime, L0);
+  // probability of fragmentation (Imode 0 and 5), see dec_inter3
+  const double fFragmentation = (xco.sigma[3] > 0.) ? 1. - xco.sigma[9] / xco.sigma[3] : 0.;
+  // lund_frag + LUEXEC relative to RES_DECAY3 + DECSIB, fitted to benchmarkSophia
+  const double fragmentationCost = 1. + 1.2 * std::log(std::max(std::sqrt(s), 1.));
+  return 1. + fFragmentation * fragmentationCost;
+}
+
+sophiabatch_output generateInteractions(const interaction_request* requests, size_t nRequests,
+                                        int nThreads, unsigned long long seed,
+                                        bool declareChargedPionsStable,
+                                        const particle_filter& filter,
+                                        const sophia_parameters& parameters, double chunkCost) {
+  if (!(chunkCost > 0.))
+    throw std::runtime_error("generateInteractions: chunkCost has to be positive.");
+
+  // consecutive chunks of about chunkCost, i.e. independent of nThreads
+  std::vector<size_t> chunkStart(1, 0);
+  std::vector<double> cost;
+  double sum = 0.;
+  for (size_t i = 0; i < nRequests; ++i) {
+    sum += estimateCost(requests[i]);
+    if (sum >= chunkCost || i + 1 == nRequests) {
+      chunkStart.push_back(i + 1);
+      cost.push_back(sum);
+      sum = 0.;
+    }
+  }
+  // most expensive chunks first: the short ones fill the gaps at the end
+  std::vector<int> order(cost.size());
+  for (size_t c = 0; c < order.size(); ++c) order[c] = static_cast<int>(c);
+  std::stable_sort(order.begin(), order.end(), [&cost](int a, int b) { return cost[a] > cost[b]; });
+
+  const bool filtered = !filter.pdgIDs.empty() || filter.Emin > 0.;
+  auto generateChunk = [&](sophia_interface& SI, int c, sophiabatch_output& chunk) {
+    for (size_t i = chunkStart[c]; i < chunkStart[c + 1]; ++i) {
+      const interaction_request& request = requests[i];
+      SI.generateEvent(request.onProton, request.Ein, request.eps, declareChargedPionsStable);
+      if (filtered) {
+        chunk.append(SI, filter);
+      } else {
+        chunk.append(SI);
+      }
+    }
+  };
+  return mergeChunks(generateChunks(order, nThreads, seed, parameters, generateChunk));
+}
+
+sophia_spectra generateSpectra(bool onProton, double Ein, double eps, int nEvents, int nThreads,
+                               unsigned long long seed, const sophia_spectra& booking,
+                               bool declareChargedPionsStable,
+                               const sophia_parameters& parameters, int chunkSize,
+                               int firstEvent) {
+  if (nEvents < 0) throw std::runtime_error("generateSpectra: negative number of events.");
+  if (chunkSize <= 0) throw std::runtime_error("generateSpectra: chunkSize has to be positive.");
+  if (firstEvent < 0 || firstEvent % chunkSize != 0)
+    throw std::runtime_error("generateSpectra: firstEvent has to be a multiple of chunkSize.");
+
+  // the chunks of events firstEvent ... firstEvent + nEvents - 1
+  const int firstChunk = firstEvent / chunkSize;
+  std::vector<int> order((nEvents + chunkSize - 1) / chunkSize);
+  for (size_t c = 0; c < order.size(); ++c) order[c] = firstChunk + static_cast<int>(c);
+  const int endEvent = firstEvent + nEvents;
+
+  // one histogram per worker, no locking; merged in worker order at the end
+  sophia_spectra empty(booking);
+  empty.clear();
+  nThreads = workerCount(nThreads, static_cast<int>(order.size()));
+  std::vector<sophia_spectra> spectra(nThreads, empty);
+  auto generateChunk = [&](sophia_interface& SI, int c, int iThread) {
+    const int first = c * chunkSize;
+    const int last = std::min(endEvent, first + chunkSize);
+    for (int k = first; k < last; ++k) {
+      SI.generateEvent(onProton, Ein, eps, declareChargedPionsStable);
+      spectra[iThread].fill(SI, Ein);
+    }
+  };
+  runChunks(order, nThreads, seed, parameters, generateChunk);
+  for (int t = 1; t < nThreads; ++t) spectra[0].merge(spectra[t]);
+  return spectra[0];
+}
@@ -0,0 +1,222 @@
+#include "sophia_crossection.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "sophia_interface.h"
+
+// points where the parametrisation of crossection_analytic has a kink or a step
+static const double kinks[] = {0.15, 0.152, 0.322, 0.4, 0.5, 0.53, 0.6, 0.85, 10.};
+// kinks behind which a term rises like a power > 0 of (x - kink): Pl in singleback/twoback and
+// pow(x - .85, .75). Behind these the grid is refined by short segments of refinedPoints points.
+static const double steepKinks[] = {0.152, 0.4, 0.85};
+static const int refinedPoints = 32;
+
+crossection_table::crossection_table(int pointsPerDecade, int pointsPerDecadeHigh, double xMax)
+    : xMax(xMax) {
+  if (pointsPerDecade < 1 || pointsPerDecadeHigh < 1 || xMax <= 10.)
+    throw std::runtime_error("crossection_table: invalid grid specified.");
+  const double inf = std::numeric_limits<double>::infinity();
+  const double sth = 1.1646;  // same threshold as in crossection_analytic
+
+  for (int L = 0; L < 2; ++L) {
+    const int NL0 = 13 + L;
+    const double pm = AM[NL0 - 1];
+    double xth = (sth - pm * pm) / 2. / pm;
+    while (pm * pm + 2. * pm * xth < sth) xth = std::nextafter(xth, inf);
+    xThreshold[L] = xth;
+
+    std::vector<double> bounds(1, xth);
+    for (double kink : kinks) {
+      if (kink > xth) bounds.push_back(kink);
+    }
+    std::vector<double> refined;
+    for (double kink : steepKinks) {
+      for (double d = 1e-5; d < 2e-2; d *= 10.) refined.push_back(kink * (1. + d));
+    }
+    bounds.insert(bounds.end(), refined.begin(), refined.end());
+    bounds.push_back(xMax);
+    std::sort(bounds.begin(), bounds.end());
+
+    for (size_t iseg = 0; iseg + 1 < bounds.size(); ++iseg) {
+      segment seg;
+      seg.xLow = bounds[iseg];
+      seg.xHigh = bounds[iseg + 1];
+      const double lnRange = std::log(seg.xHigh / seg.xLow);
+      const int density = (seg.xHigh > 10.) ? pointsPerDecadeHigh : pointsPerDecade;
+      const bool isRefined = std::find(refined.begin(), refined.end(), seg.xHigh) != refined.end();
+      seg.nPoints =
+          std::max(isRefined ? refinedPoints : 2,
+                   static_cast<int>(std::ceil(density * lnRange / std::log(10.))) + 1);
+      const double step = lnRange / (seg.nPoints - 1);
+      seg.lnXLow = std::log(seg.xLow);
+      seg.invStep = 1. / step;
+      seg.value.resize(seg.nPoints * nChannels);
+      for (int i = 0; i < seg.nPoints; ++i) {
+        double x = std::exp(seg.lnXLow + i * step);
+        // the lowest point is the limit from above of the analytic cross section, the
+        // highest point its value at the segment end, thus steps are reproduced as well
+        if (i == 0) x = (iseg == 0) ? seg.xLow : std::nextafter(seg.xLow, inf);
+        if (i == seg.nPoints - 1) x = seg.xHigh;
+        const crossection_output xco = sophia_interface::crossections_analytic(x, NL0);
+        std::copy(xco.sigma, xco.sigma + nChannels, &seg.value[i * nChannels]);
+      }
+      segments[L].push_back(seg);
+    }
+  }
+}
+
+const crossection_table& crossection_table::instance() {
+  static const crossection_table table;
+  return table;
+}
+
+double crossection_table::crossection(double x, int NDIR, int NL0) const {
+  if (NL0 != 13 && NL0 != 14)
+    throw std::runtime_error("crossection: particle ID incorrectly specified.");
+  if (NDIR < 0 || NDIR >= nChannels)
+    throw std::runtime_error("wrong input NDIR in crossection.f !");
+  const int L = NL0 - 13;
+  if (x < xThreshold[L]) return 0.;
+  if (x > xMax) return sophia_interface::crossection_analytic(x, NDIR, NL0);
+
+  const std::vector<segment>& segs = segments[L];
+  size_t iseg = 0;
+  while (x > segs[iseg].xHigh) ++iseg;
+  const segment& seg = segs[iseg];
+
+  const double u = (std::log(x) - seg.lnXLow) * seg.invStep;
+  const int i = std::min(std::max(static_cast<int>(u), 0), seg.nPoints - 2);
+  const double f = u - i;
+  const double* v = &seg.value[i * nChannels + NDIR];
+  return (1. - f) * v[0] + f * v[nChannels];
+}
+
+crossection_output crossection_table::crossections(double x, int NL0) const {
+  if (NL0 != 13 && NL0 != 14)
+    throw std::runtime_error("crossection: particle ID incorrectly specified.");
+  const int L = NL0 - 13;
+  crossection_output xco;
+  if (x < xThreshold[L]) return xco;
+  if (x > xMax) return sophia_interface::crossections_analytic(x, NL0);
+
+  const std::vector<segment>& segs = segments[L];
+  size_t iseg = 0;
+  while (x > segs[iseg].xHigh) ++iseg;
+  const segment& seg = segs[iseg];
+
+  const double u = (std::log(x) - seg.lnXLow) * seg.invStep;
+  const int i = std::min(std::max(static_cast<int>(u), 0), seg.nPoints - 2);
+  const double f = u - i;
+  const double* v = &seg.value[i * nChannels];
+  for (int NDIR = 0; NDIR < nChannels; ++NDIR) {
+    xco.sigma[NDIR] = (1. - f) * v[NDIR] + f * v[NDIR + nChannels];
+  }
+  return xco;
+}
+
+double crossection_table::maxDeviation() const {
+  double deviation = 0.;
+  for (int L = 0; L < 2; ++L) {
+    for (const segment& seg : segments[L]) {
+      for (int i = 0; i + 1 < seg.nPoints; ++i) {
+        const double x = std::exp(seg.lnXLow + (i + 0.5) / seg.invStep);
+        const double total = sophia_interface::crossection_analytic(x, 3, 13 + L);
+        if (total <= 0.) continue;
+        for (int NDIR = 0; NDIR < nChannels; ++NDIR) {
+          const double exact = sophia_interface::crossection_analytic(x, NDIR, 13 + L);
+          deviation = std::max(deviation, std::fabs(crossection(x, NDIR, 13 + L) - exact) / total);
+        }
+      }
+    }
+  }
+  return deviation;
+}
+
+const double functs_table::sMin = 1.1646;
+
+// as sophia_interface::functs, but always from the analytic cross section
+static double functsAnalytic(double s, int L0) {
+  const double pm = 0.93827;  // Gev/c^2, for both nucleons as in functs
+  const double factor = s - pm * pm;
+  return factor * sophia_interface::crossection_analytic(factor / 2. / pm, 3, L0);
+}
+
+functs_table::functs_table(int pointsPerDecade, double sMax) : sMax(sMax) {
+  if (pointsPerDecade < 1 || sMax <= sMin)
+    throw std::runtime_error("functs_table: invalid grid specified.");
+  const double lnRange = std::log(sMax / sMin);
+  nPoints = std::max(2, static_cast<int>(std::ceil(pointsPerDecade * lnRange / std::log(10.))) + 1);
+  lnSMin = std::log(sMin);
+  const double step = lnRange / (nPoints - 1);
+  invStep = 1. / step;
+
+  sNode.resize(nPoints);
+  for (int i = 0; i < nPoints; ++i) sNode[i] = std::exp(lnSMin + i * step);
+  sNode[0] = sMin;
+  sNode[nPoints - 1] = sMax;
+
+  for (int L = 0; L < 2; ++L) {
+    const int L0 = 13 + L;
+    functs[L].resize(nPoints);
+    cumulative[L].resize(nPoints);
+    cumulative[L][0] = 0.;
+    for (int i = 0; i < nPoints; ++i) {
+      functs[L][i] = functsAnalytic(sNode[i], L0);
+      if (i == 0) continue;
+      const double cell =
+          gaussInt([L0](double s) { return functsAnalytic(s, L0); }, sNode[i - 1], sNode[i]);
+      cumulative[L][i] = cumulative[L][i - 1] + cell;
+    }
+  }
+}
+
+const functs_table& functs_table::instance() {
+  static const functs_table table;
+  return table;
+}
+
+int functs_table::locate(double s, int L0, double& fraction) const {
+  const int L = L0 - 13;
+  const int i =
+      std::min(std::max(static_cast<int>((std::log(s) - lnSMin) * invStep), 0), nPoints - 2);
+  // functs linear in the cell: f(t) = f0 + a * t, t = s - sNode[i]
+  const double h = sNode[i + 1] - sNode[i];
+  const double f0 = functs[L][i];
+  const double a = (functs[L][i + 1] - f0) / h;
+  const double t = std::min(std::max(s - sNode[i], 0.), h);
+  const double area = (f0 + 0.5 * a * h) * h;
+  fraction = (area > 0.) ? (f0 + 0.5 * a * t) * t / area : t / h;
+  return i;
+}
+
+double functs_table::integral(double s, int L0) const {
+  if (L0 != 13 && L0 != 14) throw std::runtime_error("functs_table: invalid nucleon ID.");
+  if (s <= sMin) return 0.;
+  double fraction = 0.;
+  const int i = locate(s, L0, fraction);
+  const std::vector<double>& C = cumulative[L0 - 13];
+  return C[i] + fraction * (C[i + 1] - C[i]);
+}
+
+double functs_table::sample(double smax, int L0, double r) const {
+  const double target = r * integral(smax, L0);
+  const std::vector<double>& C = cumulative[L0 - 13];
+  // first cell whose upper end lies above target
+  const int i = std::min(static_cast<int>(std::upper_bound(C.begin() + 1, C.end(), target) -
+                                          C.begin()) - 1,
+                         nPoints - 2);
+  const double cell = C[i + 1] - C[i];
+  const double h = sNode[i + 1] - sNode[i];
+  const double q = (cell > 0.) ? (target - C[i]) / cell : 0.;
+  // invert the linear shape: f0 * t + a * t^2 / 2 = q * area
+  const int L = L0 - 13;
+  const double f0 = functs[L][i];
+  const double a = (functs[L][i + 1] - f0) / h;
+  const double qarea = q * (f0 + 0.5 * a * h) * h;
+  const double denominator = f0 + std::sqrt(std::max(f0 * f0 + 2. * a * qarea, 0.));
+  const double t = (denominator > 0.) ? 2. * qarea / denominator : q * h;
+  return std::min(sNode[i] + t, smax);
+}
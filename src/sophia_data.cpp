@@ -1,41 +1,45 @@
 #include "sophia_data.h"
 
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+
 /* SOPHIA data block */
 
 // block data DATDEC
-int FRES[49] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1,
+const int FRES[49] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1,
                 1, 1, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 0, 0, 0, 0, 0, 1};
-double XLIMRES[49] = {0.,    0.,   0.,    0.,   0., 0.,  0.,    0., 0., 0., 0., 0.,   0.,
+const double XLIMRES[49] = {0.,    0.,   0.,    0.,   0., 0.,  0.,    0., 0., 0., 0., 0.,   0.,
                       0.,    0.,   0.,    0.,   0., 0.,  0.,    0., 0., 0., 0., .275, .275,
                       .28,   0.,   0.,    0.,   0., .41, .9954, 0., 0., 0., 0., 0.,   0.,
                       1.078, 1.08, 1.078, 1.08, 0., 0.,  0.,    0., 0., 1.};
-double AMRESp[9] = {1.231, 1.440, 1.515, 1.525, 1.675, 1.680, 1.690, 1.895, 1.950};
-double AMRESn[9] = {1.231, 1.440, 1.515, 1.525, 1.675, 1.675, 1.690, 1.895, 1.950};
-int IDBRES1p[9] = {1, 3, 5, 7, 9, 11, 13, 15, 17};
-int IDBRES2p[9] = {0, 1, 6, 11, 14, 19, 24, 27, 32};
-int IDBRES3p[9] = {0, 0, 1, 0, 3, 9, 16, 21, 26};
-int IDBRES1n[9] = {1, 3, 5, 7, 9, 11, 13, 15, 17};
-int IDBRES2n[9] = {0, 1, 6, 11, 14, 19, 24, 27, 32};
-int IDBRES3n[9] = {0, 0, 1, 0, 3, 0, 9, 14, 19};
-double CBRRES1p[18] = {.667, 1.,   .667, 1.,   .667, 1.,   .667, 1.,   .667,
+const double AMRESp[9] = {1.231, 1.440, 1.515, 1.525, 1.675, 1.680, 1.690, 1.895, 1.950};
+const double AMRESn[9] = {1.231, 1.440, 1.515, 1.525, 1.675, 1.675, 1.690, 1.895, 1.950};
+const int IDBRES1p[9] = {1, 3, 5, 7, 9, 11, 13, 15, 17};
+const int IDBRES2p[9] = {0, 1, 6, 11, 14, 19, 24, 27, 32};
+const int IDBRES3p[9] = {0, 0, 1, 0, 3, 9, 16, 21, 26};
+const int IDBRES1n[9] = {1, 3, 5, 7, 9, 11, 13, 15, 17};
+const int IDBRES2n[9] = {0, 1, 6, 11, 14, 19, 24, 27, 32};
+const int IDBRES3n[9] = {0, 0, 1, 0, 3, 0, 9, 14, 19};
+const double CBRRES1p[18] = {.667, 1.,   .667, 1.,   .667, 1.,   .667, 1.,   .667,
                        1.,   .667, 1.,   .667, 1.,   .667, 1.,   .667, 1.};
-double CBRRES2p[36] = {.333, .5,   .750, .917, 1.,   .333, .5,   .75, .917, 1.,   .167, .25,
+const double CBRRES2p[36] = {.333, .5,   .750, .917, 1.,   .333, .5,   .75, .917, 1.,   .167, .25,
                        1.,   .567, .85,  .925, .975, 1.,   .433, .65, .825, .942, 1.,   .4,
                        .467, 1.,   .267, .4,   .64,  .68,  1.,   .4,  .6,   .76,  .787, 1.};
-double CBRRES3p[26] = {.333, 1., .467, .7, .775, .825, .85, 1., .367, .55,  .7, 1., .08,
+const double CBRRES3p[26] = {.333, 1., .467, .7, .775, .825, .85, 1., .367, .55,  .7, 1., .08,
                        .093, .2, .733, 1., .667, 1.,   .2,  .3, .46,  .487, .7, .9, 1.};
-double CBRRES1n[18] = {.667, 1.,   .667, 1.,   .667, 1.,   .667, 1.,   .667,
+const double CBRRES1n[18] = {.667, 1.,   .667, 1.,   .667, 1.,   .667, 1.,   .667,
                        1.,   .667, 1.,   .667, 1.,   .667, 1.,   .667, 1.};
-double CBRRES2n[36] = {.333, .5,   .750, .917, 1.,   .333, .5,   .75, .917, 1.,  .167, .25,
+const double CBRRES2n[36] = {.333, .5,   .750, .917, 1.,   .333, .5,   .75, .917, 1.,  .167, .25,
                        1.,   .567, .85,  .925, .975, 1.,   .267, .4,  .7,   .9,  1.,   .4,
                        .467, 1.,   .267, .4,   .64,  .68,  1.,   .4,  .6,   .76, .787, 1.};
-double CBRRES3n[22] = {.333, 1., .467, .7, .775, .825, .85, 1.,   .08, .093, .2,
+const double CBRRES3n[22] = {.333, 1., .467, .7, .775, .825, .85, 1.,   .08, .093, .2,
                        .733, 1., .667, 1., .2,   .3,   .46, .487, .7,  .9,   1.};
-int KDECRES1p[90] = {2, 0, 13, 6, 0, 2, 0, 14, 7, 0, 2, 0, 14, 7, 0, 2, 0, 13, 6, 0, 2, 0, 14, 7, 0,
+const int KDECRES1p[90] = {2, 0, 13, 6, 0, 2, 0, 14, 7, 0, 2, 0, 14, 7, 0, 2, 0, 13, 6, 0, 2, 0, 14, 7, 0,
                      2, 0, 13, 6, 0, 2, 0, 14, 7, 0, 2, 0, 13, 6, 0, 2, 0, 14, 7, 0, 2, 0, 13, 6, 0,
                      2, 0, 14, 7, 0, 2, 0, 13, 6, 0, 2, 0, 13, 6, 0, 2, 0, 14, 7, 0, 2, 0, 13, 6, 0,
                      2, 0, 14, 7, 0, 2, 0, 13, 6, 0, 2, 0, 14, 7, 0};
-int KDECRES2p[180] = {2, 0, 14, 7,  0, 2, 0, 13, 6, 0, 2, 0, 40, 8, 0, 2, 0, 41, 6, 0,
+const int KDECRES2p[180] = {2, 0, 14, 7,  0, 2, 0, 13, 6, 0, 2, 0, 40, 8, 0, 2, 0, 41, 6, 0,
                       2, 0, 42, 7,  0, 2, 0, 14, 7, 0, 2, 0, 13, 6, 0, 2, 0, 40, 8, 0,
                       2, 0, 41, 6,  0, 2, 0, 42, 7, 0, 2, 0, 14, 7, 0, 2, 0, 13, 6, 0,
                       2, 0, 13, 23, 0, 2, 0, 14, 7, 0, 2, 0, 13, 6, 0, 2, 0, 40, 8, 0,
@@ -44,18 +48,18 @@ int KDECRES2p[180] = {2, 0, 14, 7,  0, 2, 0, 13, 6, 0, 2, 0, 40, 8, 0, 2, 0, 41,
                       2, 0, 41, 6,  0, 2, 0, 42, 7, 0, 2, 0, 13, 6, 0, 2, 0, 14, 7, 0,
                       2, 0, 40, 8,  0, 2, 0, 41, 6, 0, 2, 0, 42, 7, 0, 2, 0, 13, 6, 0,
                       2, 0, 14, 7,  0, 2, 0, 40, 8, 0, 2, 0, 41, 6, 0, 2, 0, 42, 7, 0};
-int KDECRES3p[130] = {2,  0,  13, 27, 0,  2,  0,  14, 25, 0,  2,  0,  14, 7,  0,  2,  0,  13, 6,
+const int KDECRES3p[130] = {2,  0,  13, 27, 0,  2,  0,  14, 25, 0,  2,  0,  14, 7,  0,  2,  0,  13, 6,
                       0,  2,  0,  40, 8,  0,  2,  0,  41, 6,  0,  2,  0,  42, 7,  0,  2,  0,  39,
                       9,  0,  2,  0,  14, 7,  0,  2,  0,  13, 6,  0,  2,  0,  13, 27, 0,  2,  0,
                       14, 25, 0,  2,  0,  40, 8,  0,  2,  0,  41, 6,  0,  2,  0,  42, 7,  0,  2,
                       0,  13, 27, 0,  2,  0,  14, 25, 0,  2,  0,  13, 27, 0,  2,  0,  14, 25, 0,
                       2,  0,  13, 6,  0,  2,  0,  14, 7,  0,  2,  0,  40, 8,  0,  2,  0,  41, 6,
                       0,  2,  0,  42, 7,  0,  2,  0,  13, 27, 0,  2,  0,  14, 25, 0};
-int KDECRES1n[90] = {2, 0, 14, 6, 0, 2, 0, 13, 8, 0, 2, 0, 13, 8, 0, 2, 0, 14, 6, 0, 2, 0, 13, 8, 0,
+const int KDECRES1n[90] = {2, 0, 14, 6, 0, 2, 0, 13, 8, 0, 2, 0, 13, 8, 0, 2, 0, 14, 6, 0, 2, 0, 13, 8, 0,
                      2, 0, 14, 6, 0, 2, 0, 13, 8, 0, 2, 0, 14, 6, 0, 2, 0, 13, 8, 0, 2, 0, 14, 6, 0,
                      2, 0, 13, 8, 0, 2, 0, 14, 6, 0, 2, 0, 14, 6, 0, 2, 0, 13, 8, 0, 2, 0, 14, 6, 0,
                      2, 0, 13, 8, 0, 2, 0, 14, 6, 0, 2, 0, 13, 8, 0};
-int KDECRES2n[180] = {2, 0, 13, 8,  0, 2, 0, 14, 6, 0, 2, 0, 43, 7, 0, 2, 0, 42, 6, 0,
+const int KDECRES2n[180] = {2, 0, 13, 8,  0, 2, 0, 14, 6, 0, 2, 0, 43, 7, 0, 2, 0, 42, 6, 0,
                       2, 0, 41, 8,  0, 2, 0, 13, 8, 0, 2, 0, 14, 6, 0, 2, 0, 43, 7, 0,
                       2, 0, 42, 6,  0, 2, 0, 41, 8, 0, 2, 0, 13, 8, 0, 2, 0, 14, 6, 0,
                       2, 0, 14, 23, 0, 2, 0, 13, 8, 0, 2, 0, 14, 6, 0, 2, 0, 43, 7, 0,
@@ -64,27 +68,27 @@ int KDECRES2n[180] = {2, 0, 13, 8,  0, 2, 0, 14, 6, 0, 2, 0, 43, 7, 0, 2, 0, 42,
                       2, 0, 42, 6,  0, 2, 0, 41, 8, 0, 2, 0, 14, 6, 0, 2, 0, 13, 8, 0,
                       2, 0, 43, 7,  0, 2, 0, 42, 6, 0, 2, 0, 41, 8, 0, 2, 0, 14, 6, 0,
                       2, 0, 13, 8,  0, 2, 0, 43, 7, 0, 2, 0, 42, 6, 0, 2, 0, 41, 8, 0};
-int KDECRES3n[110] = {2,  0,  14, 27, 0,  2,  0,  13, 26, 0,  2,  0,  13, 8,  0,  2,  0,  14, 6,
+const int KDECRES3n[110] = {2,  0,  14, 27, 0,  2,  0,  13, 26, 0,  2,  0,  13, 8,  0,  2,  0,  14, 6,
                       0,  2,  0,  43, 7,  0,  2,  0,  42, 6,  0,  2,  0,  41, 8,  0,  2,  0,  39,
                       21, 0,  2,  0,  43, 7,  0,  2,  0,  42, 6,  0,  2,  0,  41, 8,  0,  2,  0,
                       14, 27, 0,  2,  0,  13, 26, 0,  2,  0,  14, 27, 0,  2,  0,  13, 26, 0,  2,
                       0,  14, 6,  0,  2,  0,  13, 8,  0,  2,  0,  43, 7,  0,  2,  0,  42, 6,  0,
                       2,  0,  41, 8,  0,  2,  0,  14, 27, 0,  2,  0,  13, 26, 0};
-double RESLIMp[36] = {0., 0.,  0.,   0.,  0., .54, 10.,  0.,  0., .54, 1.09, 10.,
+const double RESLIMp[36] = {0., 0.,  0.,   0.,  0., .54, 10.,  0.,  0., .54, 1.09, 10.,
                       0., .71, 10.,  0.,  0., .54, .918, 10., 0., .54, 1.09, 10.,
                       0., .54, 1.09, 10., 0., .54, 1.09, 10., 0., .54, 1.09, 10.};
-double RESLIMn[36] = {0., .0,  .0,   .0,  0., .54, 10.,  0.,  0., .54, 1.09, 10.,
+const double RESLIMn[36] = {0., .0,  .0,   .0,  0., .54, 10.,  0.,  0., .54, 1.09, 10.,
                       0., .71, 10.,  0.,  0., .54, .918, 10., 0., .54, 10.,  0.,
                       0., .54, 1.09, 10., 0., .54, 1.09, 10., 0., .54, 1.09, 10.};
-int ELIMITSp[9] = {0, 3, 4, 3, 4, 4, 4, 4, 4};
-int ELIMITSn[9] = {0, 3, 4, 3, 4, 3, 4, 4, 4};
-double BGAMMAp[9] = {5.6, 0.5, 4.6, 2.5, 1.0, 2.1, 2.0, 0.2, 1.0};
-double RATIOJp[9] = {1., 0.5, 1., 0.5, 0.5, 1.5, 1., 1.5, 2.};
-double WIDTHp[9] = {.11, .35, .11, .10, .16, .125, .29, .35, .3};
-double BGAMMAn[9] = {6.1, 0.3, 4.0, 2.5, 0., 0.2, 2.0, 0.2, 1.0};
-double RATIOJn[9] = {1., 0.5, 1., 0.5, 0.5, 1.5, 1., 1.5, 2.};
-double WIDTHn[9] = {.11, .35, .11, .10, .16, .15, .29, .35, .3};
-double CBR[102] = {
+const int ELIMITSp[9] = {0, 3, 4, 3, 4, 4, 4, 4, 4};
+const int ELIMITSn[9] = {0, 3, 4, 3, 4, 3, 4, 4, 4};
+const double BGAMMAp[9] = {5.6, 0.5, 4.6, 2.5, 1.0, 2.1, 2.0, 0.2, 1.0};
+const double RATIOJp[9] = {1., 0.5, 1., 0.5, 0.5, 1.5, 1., 1.5, 2.};
+const double WIDTHp[9] = {.11, .35, .11, .10, .16, .125, .29, .35, .3};
+const double BGAMMAn[9] = {6.1, 0.3, 4.0, 2.5, 0., 0.2, 2.0, 0.2, 1.0};
+const double RATIOJn[9] = {1., 0.5, 1., 0.5, 0.5, 1.5, 1., 1.5, 2.};
+const double WIDTHn[9] = {.11, .35, .11, .10, .16, .15, .29, .35, .3};
+const double CBR[102] = {
     1.,     1.,     1.,     0.,     1.,     1.,     0.6351, 0.8468, 0.9027, 0.9200, 0.9518, 1.,
     0.6351, 0.8468, 0.9027, 0.9200, 0.9518, 1.,     0.2160, 0.3398, 0.4748, 0.6098, 0.8049, 1.,
     0.6861, 1.,     0.,     0.,     0.,     0.5,    1.,     0.5,    1.,     0.3890, 0.7080, 0.9440,
@@ -94,16 +98,10 @@ double CBR[102] = {
     0.5160, 1.,     1.,     1.,     1.,     1.,     0.6410, 1.,     1.,     0.67,   1.,     0.33,
     1.,     1.,     0.88,   0.94,   1.,     0.88,   0.94,   1.,     0.88,   0.94,   1.,     0.33,
     1.,     0.67,   1.,     0.678,  0.914,  1.};
-double AM[49] = {0.,      0.511e-3, 0.511e-3, 0.10566, 0.10566, 0.13497, 0.13957, 0.13957, 0.49365,
-                 0.49365, 0.49767,  0.49767,  0.93827, 0.93957, 0.,      0.,      0.,      0.,
-                 0.93827, 0.93957,  0.49767,  0.49767, 0.54880, 0.95750, 0.76830, 0.76830, 0.76860,
-                 0.89183, 0.89183,  0.89610,  0.89610, 0.78195, 1.01941, 1.18937, 1.19255, 1.19743,
-                 1.31490, 1.32132,  1.11563,  1.23100, 1.23500, 1.23400, 1.23300, 1.38280, 1.38370,
-                 1.38720, 1.53180,  1.53500,  1.67243};
-int IDB[49] = {0,  0,  0,  1,  2,  3,  5,  6,  7,  13, 19, 25, 0,  0,  0,  0,  0,
+const int IDB[49] = {0,  0,  0,  1,  2,  3,  5,  6,  7,  13, 19, 25, 0,  0,  0,  0,  0,
                0,  0,  0,  30, 32, 34, 40, 46, 47, 48, 49, 60, 62, 64, 66, 69, 73,
                75, 76, 77, 78, 79, 81, 82, 84, 86, 87, 90, 93, 96, 98, 100};
-int KDEC[612] = {3, 1, 15, 2,  18, 0, 3, 1, 16, 3,  17, 0, 2, 0, 1,  1,  0, 0, 0, 0, 0,  0,  0,  0,
+const int KDEC[612] = {3, 1, 15, 2,  18, 0, 3, 1, 16, 3,  17, 0, 2, 0, 1,  1,  0, 0, 0, 0, 0,  0,  0,  0,
                  2, 0, 4,  17, 0,  0, 2, 0, 5,  18, 0,  0, 2, 0, 4,  17, 0, 0, 2, 0, 7,  6,  0,  0,
                  3, 0, 7,  7,  8,  0, 3, 0, 7,  6,  6,  0, 3, 1, 17, 4,  6, 0, 3, 1, 15, 2,  6,  0,
                  2, 0, 5,  18, 0,  0, 2, 0, 8,  6,  0,  0, 3, 0, 8,  8,  7, 0, 3, 0, 8,  6,  6,  0,
@@ -129,14 +127,13 @@ int KDEC[612] = {3, 1, 15, 2,  18, 0, 3, 1, 16, 3,  17, 0, 2, 0, 1,  1,  0, 0, 0
                  2, 0, 39, 8,  0,  0, 2, 0, 35, 8,  0,  0, 2, 0, 36, 6,  0, 0, 2, 0, 37, 6,  0,  0,
                  2, 0, 38, 7,  0,  0, 2, 0, 37, 8,  0,  0, 2, 0, 38, 6,  0, 0, 2, 0, 39, 10, 0,  0,
                  2, 0, 37, 8,  0,  0, 2, 0, 38, 6,  0,  0};
-int LBARP[49] = {1,   3,   2,   5,   4,   6,   8,   7,   10,  9,   11,  12,  -13, -14, 16, 15, 18,
-                 17,  13,  14,  22,  21,  23,  24,  26,  25,  27,  29,  28,  31,  30,  32, 33, -34,
-                 -35, -36, -37, -38, -39, -40, -41, -42, -43, -44, -45, -46, -47, -48, -49};
-int ICHP[49] = {0, 1,  -1, 1,  -1, 0, 1, -1, 1,  -1, 0, 0,  1, 0,  0, 0, 0,
-                0, -1, 0,  0,  0,  0, 0, 1,  -1, 0,  1, -1, 0, 0,  0, 0, 1,
-                0, -1, 0,  -1, 0,  2, 1, 0,  -1, 1,  0, -1, 0, -1, -1};
-int IBAR[49] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, -1, -1, 0, 0, 0, 0, 0,
-                0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,  1,  1, 1, 1, 1};
+
+constexpr double particle_table::mass[49];
+constexpr int particle_table::charge[49];
+constexpr int particle_table::baryon[49];
+constexpr int particle_table::pdgID[49];
+constexpr int particle_table::antiparticle[49];
+constexpr int particle_table::outputID[99];
 
 // block data PARAM_INI: This block data contains default values of the parameters used in
 // fragmentation
@@ -146,7 +143,7 @@ int IBAR[49] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, -1, -1, 0,
 // block data LUDATA. Purpose: to give default values to parameters and particle and decay data.
 
 // LUDAT1, containing status codes and most parameters.
-int MSTU[200] = {
+const int MSTU[200] = {
     0,  0,  0, 4000, 10000, 500, 2000, 0,    0, 2,  6,   1, 1, 0, 1, 1, 0, 0, 0, 0, 2, 10, 0, 0, 1,
     10, 0,  0, 0,    0,     0,   0,    0,    0, 0,  0,   0, 0, 0, 0, 2, 2, 1, 4, 2, 1, 1,  0, 0, 0,
     25, 24, 0, 1,    0,     0,   0,    0,    0, 0,  0,   0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  0, 0, 0,
@@ -155,7 +152,7 @@ int MSTU[200] = {
     0,  0,  0, 0,    0,     0,   0,    0,    0, 0,  0,   0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  0, 0, 0,
     0,  0,  0, 0,    0,     0,   0,    0,    0, 0,  0,   0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  0, 0, 0,
     0,  0,  0, 0,    0,     7,   408,  1995, 8, 23, 700, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,  0, 0, 0};
-double PARU[200] = {
+const double PARU[200] = {
     3.1415927, 6.2831854,  0.1973, 5.068,    0.3894, 2.568,      0.,  0.,  0.,  0.,   0.001,
     0.09,      0.01,       0.,     0.,       0.,     0.,         0.,  0.,  0.,  0.,   0.,
     0.,        0.,         0.,     0.,       0.,     0.,         0.,  0.,  0.,  0.,   0.,
@@ -175,7 +172,7 @@ double PARU[200] = {
     1.0,       0.,         0.,     0.,       1.0,    1.0,        1.0, 0.0, 0.0, 1.0,  1.0,
     0.0,       0.,         0.,     0.,       0.,     0.,         0.,  1.0, 0.,  0.,   0.,
     0.,        0.};
-int MSTJ[200] = {1, 3, 0, 0, 0, 0, 0, 0, 0, 0, 4, 2, 0, 1, 0, 0, 0, 0, 0, 0, 2, 1, 1, 2, 1,
+const int MSTJ[200] = {1, 3, 0, 0, 0, 0, 0, 0, 0, 0, 4, 2, 0, 1, 0, 0, 0, 0, 0, 0, 2, 1, 1, 2, 1,
                  2, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 2, 4, 2, 5, 3, 3, 0, 0, 0,
                  0, 3, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
                  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
@@ -183,7 +180,7 @@ int MSTJ[200] = {1, 3, 0, 0, 0, 0, 0, 0, 0, 0, 4, 2, 0, 1, 0, 0, 0, 0, 0, 0, 2,
                  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
                  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
                  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
-double PARJ[200] = {
+const double PARJ[200] = {
     0.10, 0.30,  0.40,   0.05,     0.50,     0.50,     0.50,  0.,   0.,    0.,   0.50, 0.60,  0.75,
     0.,   0.,    0.,     0.,       1.0,      1.0,      0.,    0.36, 1.0,   0.01, 2.0,  1.0,   0.4,
     0.,   0.,    0.,     0.,       0.10,     1.0,      0.8,   1.5,  0.,    2.0,  0.2,  2.5,   0.6,
@@ -203,7 +200,7 @@ double PARJ[200] = {
 
 // LUDAT2, with particle data and flavour treatment parameters.
 
-int KCHG[3][500] = {
+const int KCHG[3][500] = {
     {-1, 2, -1, 2,  -1, 2,  -1, 2, 0,  0,  -3, 0,  -3, 0,  -3, 0, -3, 0,  0, 0,  0, 0, 0, 3,  0,
      0,  0, 0,  0,  0,  0,  0,  0, 3,  0,  0,  3,  0,  -1, 0,  0, 0,  0,  0, 0,  0, 0, 0, 0,  0,
      0,  0, 0,  0,  0,  0,  0,  0, 0,  0,  0,  0,  0,  0,  0,  0, 0,  0,  0, 0,  0, 0, 0, 0,  0,
@@ -257,7 +254,7 @@ int KCHG[3][500] = {
      0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
      0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
      0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}};
-double PMAS[4][500] = {
+const double PMAS[4][500] = {
     {0.0099, 0.0056, 0.199,  1.35,    5.,     160.,   250.,   250.,   0.,     0.,      0.00051,
      0.,     0.1057, 0.,     1.777,   0.,     250.,   0.,     0.,     0.,     0.,      0.,
      91.187, 80.25,  80.,    0.,      0.,     0.,     0.,     0.,     0.,     500.,    900.,
@@ -421,7 +418,7 @@ double PMAS[4][500] = {
      0.,     0.,     0.,    0.,    0.,    0.,       0.,    0.,   0., 0.,    0., 0.,    0.,
      0.,     0.,     0.,    0.,    0.,    0.,       0.,    0.,   0., 0.,    0., 0.,    0.,
      0.,     0.,     0.,    0.,    0.,    0.}};
-double PARF[2000] = {
+const double PARF[2000] = {
     0.5,  0.25,  0.5,   0.25,   1.,     0.5,    0.,  0.,     0.,     0.,     0.5, 0., 0.5, 0.,
     1.,   1.,    0.,    0.,     0.,     0.,     0.5, 0.,     0.5,    0.,     1.,  1., 0.,  0.,
     0.,   0.,    0.5,   0.,     0.5,    0.,     1.,  1.,     0.,     0.,     0.,  0., 0.5, 0.,
@@ -429,7 +426,7 @@ double PARF[2000] = {
     0.,   0.,    0.,    0.,     0.75,   0.5,    0.,  0.1667, 0.0833, 0.1667, 0.,  0., 0.,  0.,
     0.,   0.,    1.,    0.3333, 0.6667, 0.3333, 0.,  0.,     0.,     0.,     0.,  0., 0.,  0.,
     0.,   0.,    0.,    0.,     0.,     0.,     0.,  0.,     0.,     0.,     0.,  0., 0.,  0.,
-    0.,   0.,    0.325, 0.325,  0.5,    1.6,    5.0, 0.,     0.,     0.,     0.,  0., 0.,  0.11,
+    0.,   0.,    0.325, 0.325,  0.5,    1.6,    5.0, 160.,   250.,   250.,   0.,  0., 0.,  0.11,
     0.16, 0.048, 0.50,  0.45,   0.55,   0.60,   0.,  0.,     0.2,    0.1,    0.,  0., 0.,  0.,
     0.,   0.,    0.,    0.,     0.,     0.,     0.,  0.,     0.,     0.,     0.,  0., 0.,  0.,
     0.,   0.,    0.,    0.,     0.,     0.,     0.,  0.,     0.,     0.,     0.,  0., 0.,  0.,
@@ -568,7 +565,7 @@ double PARF[2000] = {
 
 // block data LUDAT3 with particle decay parameters and data.
 
-int MDCY[3][500] = {
+const int MDCY[3][500] = {
     {0, 0, 0, 0, 0, 1, 1, 1, 0, 0, 0, 0, 0, 0, 1, 0, 1, 0, 0, 0, 0, 0, 1, 1, 1, 0, 0, 0, 0, 0, 0, 1,
      0, 1, 0, 0, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
      0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0,
@@ -637,7 +634,7 @@ int MDCY[3][500] = {
      0, 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, 0,  0,  0, 0,  0, 0, 0, 0, 0,  0,  0,  0,
      0, 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, 0,  0,  0, 0,  0, 0, 0, 0, 0,  0,  0,  0,
      0, 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, 0,  0,  0, 0,  0, 0, 0, 0, 0,  0,  0,  0}};
-int MDME[2][2000] = {
+const int MDME[2][2000] = {
     {1,  1,  1,  1,  1,  1,  -1, 1,  1,  1,  1,  1,  1,  1,  -1, 1,  1,  1,  1,  1,  1,  1,  -1, 1,
      1,  1,  1,  1,  1,  1,  -1, 1,  1,  1,  1,  1,  1,  1,  -1, 1,  1,  1,  1,  1,  1,  1,  -1, 1,
      -1, 1,  1,  1,  1,  1,  1,  1,  1,  -1, -1, 1,  1,  1,  1,  1,  1,  1,  1,  -1, -1, 1,  1,  1,
@@ -827,7 +824,7 @@ int MDME[2][2000] = {
      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
      0,   0,   0,   0,   0}};
-double BRAT[2000] = {
+const double BRAT[2000] = {
     0.,      0.,      0.,      0.,      0.,      0.,      0.,     0.,     0.,     0.,      0.,
     0.,      0.,      0.,      0.,      0.,      0.,      0.,     0.,     0.,     0.,      0.,
     0.,      0.,      0.,      0.,      0.,      0.,      0.,     0.,     0.,     0.,      0.,
@@ -1003,7 +1000,7 @@ double BRAT[2000] = {
     0.,      0.,      0.,      0.,      0.,      0.,      0.,     0.,     0.,     0.,      0.,
     0.,      0.,      0.,      0.,      0.,      0.,      0.,     0.,     0.,     0.,      0.,
     0.,      0.};
-int KFDP[5][2000] = {
+const int KFDP[5][2000] = {
     {21,    22,    23,     -24,   -24,  -24,   -24,   25,   21,   22,   23,   24,   24,
      24,    24,    25,     21,    22,   23,    -24,   -24,  -24,  -24,  25,   21,   22,
      23,    24,    24,     24,    24,   25,    21,    22,   23,   -24,  -24,  -24,  -24,
@@ -1684,3 +1681,35 @@ int KFDP[5][2000] = {
      0,    0,   0,   0,   0,    0,   0,   0,    0,   0,    0,   0, 0, 0, 0, 0, 0, 0, 0, 0,   0, 0,
      0,    0,   0,   0,   0,    0,   0,   0,    0,   0,    0,   0, 0, 0, 0, 0, 0, 0, 0, 0,   0, 0,
      0,    0,   0,   0,   0,    0,   0,   0,    0,   0,    0,   0, 0, 0, 0, 0, 0, 0, 0, 0}};
+
+/* per-engine parameters */
+
+sophia_parameters::sophia_parameters() {
+  std::copy(&::MSTU[0], &::MSTU[0] + 200, &MSTU[0]);
+  std::copy(&::PARU[0], &::PARU[0] + 200, &PARU[0]);
+  std::copy(&::MSTJ[0], &::MSTJ[0] + 200, &MSTJ[0]);
+  std::copy(&::PARJ[0], &::PARJ[0] + 200, &PARJ[0]);
+  std::copy(&::MDCY[0][0], &::MDCY[0][0] + 3 * 500, &MDCY[0][0]);
+  std::copy(&::IDB[0], &::IDB[0] + 49, &IDB[0]);
+  setThinningEnergy(0.);
+}
+
+void sophia_parameters::setChargedPionsStable(bool stable) {
+  for (int i = 5; i < 8; ++i) {
+    IDB[i] = stable ? 0 : ::IDB[i];  // pi0, pi+, pi-
+  }
+}
+
+void sophia_parameters::setThinningEnergy(double E) {
+  if (!(E >= 0.)) throw std::runtime_error("setThinningEnergy: negative energy.");
+  std::fill(&thinningEnergy[0], &thinningEnergy[0] + 49, E);
+  thinning = E > 0.;
+}
+
+void sophia_parameters::setThinningEnergy(int sophiaID, double E) {
+  if (!isSophiaID(sophiaID)) throw std::runtime_error("setThinningEnergy: unknown particle ID.");
+  if (!(E >= 0.)) throw std::runtime_error("setThinningEnergy: negative energy.");
+  thinningEnergy[std::abs(sophiaID) - 1] = E;
+  thinning = std::any_of(&thinningEnergy[0], &thinningEnergy[0] + 49,
+                         [](double level) { return level > 0.; });
+}
@@ -0,0 +1,23 @@
+#include "sophia_diagnostics.h"
+
+#include <iostream>
+#include <mutex>
+
+void sophia_diagnostics::resetCounts() {
+  for (long long& n : counts) n = 0;
+}
+
+void sophia_diagnostics::report(level_type messageLevel, message_id id,
+                                const std::string& message) const {
+  std::string text = message;
+  if (maxReports >= 0 && counts[id] == maxReports)
+    text += " (further messages of this kind are suppressed)";
+  if (callback) {
+    callback(messageLevel, id, text);
+    return;
+  }
+  // std::cout is shared by all engines
+  static std::mutex outputMutex;
+  std::lock_guard<std::mutex> lock(outputMutex);
+  std::cout << text << '\n';
+}
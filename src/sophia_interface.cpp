@@ -1,7 +1,9 @@
 #include "sophia_interface.h"
+#include "sophia_kinematics.h"
 
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <functional>
 #include <initializer_list>
 #include <iostream>
@@ -44,7 +46,7 @@ void sophia_interface::debug(std::string errm, bool stopProgram) {
       std::cout << K[j][i] << "\tK|P\t" << P[j][i] << std::endl;
     }
   }
-  std::cout << "test random number: " << RNDM() << std::endl;
+  std::cout << "random numbers drawn: " << randomGenerator.getCount() << std::endl;
   std::cout << "------------------------------------" << std::endl;
   if (stopProgram) throw std::runtime_error("stopped by debug.");
 }
@@ -59,11 +61,74 @@ void sophia_interface::debugNonLUND(std::string errm, bool stopProgram) {
       std::cout << "|P\t" << p[j][i] << std::endl;
     }
   }
-  std::cout << "test random number: " << RNDM() << std::endl;
+  std::cout << "random numbers drawn: " << randomGenerator.getCount() << std::endl;
   std::cout << "------------------------------------" << std::endl;
   if (stopProgram) throw std::runtime_error("stopped by debugNonLUND.");
 }
 
+const int sophia_interface::initialRecordSize;
+const int sophia_interface::maxRecordSize;
+const int sophia_interface::initialParticles;
+const int sophia_interface::maxDecayChannels;
+
+void sophia_interface::setParameters(const sophia_parameters& parameters) {
+  static_cast<sophia_parameters&>(*this) = parameters;
+  MSTU[3] = K.getCapacity();
+  lund_frag_isInitialized = false;
+  Ic = 0;
+}
+
+void sophia_interface::reset() {
+  const int NUSED = std::min(std::max(N, 0), K.getCapacity());
+  const int NV = std::min(NUSED, V.getCapacity());
+  for (int j = 0; j < 5; ++j) {
+    std::fill(K[j], K[j] + NUSED, 0);
+    std::fill(P[j], P[j] + NUSED, 0.);
+    std::fill(V[j], V[j] + NV, 0.);
+  }
+  N = 0;
+
+  const int npUsed = std::min(std::max(np, 0), p.getCapacity());
+  for (int j = 0; j < 5; ++j) {
+    std::fill(p[j], p[j] + npUsed, 0.);
+  }
+  std::fill(LLIST.begin(), LLIST.begin() + npUsed, 0);
+  std::fill(weight.begin(), weight.begin() + npUsed, 0.);
+  np = 0;
+  lastImode = -1;
+}
+
+void sophia_interface::useVertices(bool vertices) {
+  trackVertices = vertices;
+  if (vertices) {
+    V.grow(K.getCapacity(), 0);
+  } else {
+    V = event_record<double, 5>();
+  }
+}
+
+bool sophia_interface::LUJETS_reserve(int n) {
+  const int needed = n + MSTU[31];
+  if (needed <= MSTU[3]) return true;
+  if (MSTU[3] >= maxRecordSize) return false;
+  const int capacity = std::min(std::max(2 * MSTU[3], needed), maxRecordSize);
+  // entries beyond N may already be in use by the caller, keep all below the saved ones
+  const int nLow = MSTU[3] - MSTU[31];
+  K.grow(capacity, nLow, MSTU[31]);
+  P.grow(capacity, nLow, MSTU[31]);
+  if (V.getCapacity() > 0) V.grow(capacity, nLow, MSTU[31]);
+  MSTU[3] = capacity;
+  return needed <= MSTU[3];
+}
+
+void sophia_interface::reserveParticles(int n) {
+  if (n <= p.getCapacity()) return;
+  const int capacity = std::max(2 * p.getCapacity(), n);
+  p.grow(capacity, p.getCapacity());
+  LLIST.resize(capacity, 0);
+  weight.resize(capacity, 0.);
+}
+
 sophiaevent_output sophia_interface::sophiaevent(bool onProton, double Ein, double eps,
                                                  bool declareChargedPionsStable) {
   // ****************************************************************************
@@ -83,42 +148,114 @@ sophiaevent_output sophia_interface::sophiaevent(bool onProton, double Ein, doub
   //  OutPartID = ID list of output particles (PDG IDs)
   //  Nout = number of output particles
   // ****************************************************************************
-  const double pi = 3.141592653;
+  generateEvent(onProton, Ein, eps, declareChargedPionsStable);
 
-  if (declareChargedPionsStable) {
-    IDB[5] = 0;  // pi0 = stable
-    IDB[6] = 0;  // pi+ = stable
-    IDB[7] = 0;  // pi- = stable
+  // generate output
+  sophiaevent_output seo;
+  if (np > 2000) throw std::runtime_error("sophiaevent: more than 2000 particles, use a buffer.");
+  for (int i = 0; i < np; ++i) {
+    for (int j = 0; j < 5; ++j) {
+      seo.outPartP[j][i] = p[j][i];
+    }
+    seo.outPartID[i] = LLIST[i];
   }
+  seo.Nout = np;
+  return seo;
+}
+
+int sophia_interface::sophiaevent(bool onProton, double Ein, double eps,
+                                  sophiaevent_buffer& output, bool declareChargedPionsStable) {
+  // as above, but copies only the np produced particles; the output particle IDs are PDG IDs
+  generateEvent(onProton, Ein, eps, declareChargedPionsStable);
+  return copyEvent(output);
+}
+
+int sophia_interface::sophiaevent(bool onProton, double Ein, const photon_field_sampler& sampler,
+                                  sophiaevent_buffer& output, bool declareChargedPionsStable) {
+  generateEvent(onProton, Ein, sampler, declareChargedPionsStable);
+  return copyEvent(output);
+}
+
+int sophia_interface::copyEvent(sophiaevent_buffer& output) const {
+  output.Nout = np;
+  output.px.resize(np);
+  output.py.resize(np);
+  output.pz.resize(np);
+  output.E.resize(np);
+  output.m.resize(np);
+  output.pdgID.resize(np);
+  output.weight.resize(np);
+  std::copy(&p[0][0], &p[0][0] + np, output.px.begin());
+  std::copy(&p[1][0], &p[1][0] + np, output.py.begin());
+  std::copy(&p[2][0], &p[2][0] + np, output.pz.begin());
+  std::copy(&p[3][0], &p[3][0] + np, output.E.begin());
+  std::copy(&p[4][0], &p[4][0] + np, output.m.begin());
+  std::copy(&weight[0], &weight[0] + np, output.weight.begin());
+  for (int i = 0; i < np; ++i) {
+    output.pdgID[i] = ID_sophia_to_PDG(LLIST[i]);
+  }
+  return np;
+}
+
+void sophia_interface::generateEvent(bool onProton, double Ein, double eps,
+                                     bool declareChargedPionsStable) {
+  // pi+-0 stable or not; applies to this instance only
+  setChargedPionsStable(declareChargedPionsStable);
+  SOPHIA_STAT(statistics.nEvents++);
+  SOPHIA_STAT(const long long count0 = randomGenerator.getCount());
 
   int L0 = onProton ? 13 : 14;
   double E0 = Ein;
-  double pm = AM[L0 - 1];
   double s = sample_s(eps, L0, E0);
+  generateEventAt(L0, E0, eps, s);
+  SOPHIA_STAT(statistics.nRandom += randomGenerator.getCount() - count0);
+}
+
+double sophia_interface::generateEvent(bool onProton, double Ein,
+                                       const photon_field_sampler& sampler,
+                                       bool declareChargedPionsStable) {
+  setChargedPionsStable(declareChargedPionsStable);
+  SOPHIA_STAT(statistics.nEvents++);
+  SOPHIA_STAT(const long long count0 = randomGenerator.getCount());
+
+  const int L0 = onProton ? 13 : 14;
+  const double pm = AM[L0 - 1];
+  const double r1 = RNDM();
+  const double r2 = RNDM();
+  const double eps = sampler.sampleEps(L0, Ein / pm, r1, r2);
+  // s from the cumulative table, no rejection; sample_s at the edges of the table
+  const functs_table& table = functs_table::instance();
+  const double smax = pm * pm + 2. * eps * (Ein + std::sqrt(Ein * Ein - pm * pm));
+  double s = 0.;
+  if (smax > functs_table::sMin + 1e-8 && smax <= table.getSMax()) {
+    SOPHIA_STAT(statistics.nSample++);
+    s = table.sample(smax, L0, RNDM());
+  } else {
+    s = sample_s(eps, L0, Ein);
+  }
+  generateEventAt(L0, Ein, eps, s);
+  SOPHIA_STAT(statistics.nRandom += randomGenerator.getCount() - count0);
+  return eps;
+}
+
+void sophia_interface::generateEventAt(int L0, double E0, double eps, double s) {
+  const double pi = 3.141592653;
+  double pm = AM[L0 - 1];
   double Pp = std::sqrt(E0 * E0 - pm * pm);
   double theta = ((pm * pm - s) / 2. / eps + E0) / Pp;
   if (theta > 1.) {
-    std::cout << "sophiaevent: theta > 1.: " << theta << std::endl;
+    SOPHIA_DIAG(diagnostics, sophia_diagnostics::warning, sophia_diagnostics::thetaOutOfRange,
+                "sophiaevent: theta > 1.: " << theta);
     theta = 0.;
   } else if (theta < -1.) {
-    std::cout << "sophiaevent: theta < -1.: " << theta << std::endl;
+    SOPHIA_DIAG(diagnostics, sophia_diagnostics::warning, sophia_diagnostics::thetaOutOfRange,
+                "sophiaevent: theta < -1.: " << theta);
     theta = 180.;
   } else {
     theta = std::acos(theta) * 180. / pi;
   }
 
   eventgen(L0, E0, eps, theta);
-
-  // generate output
-  sophiaevent_output seo;
-  for (int i = 0; i < np; ++i) {
-    for (int j = 0; j < 5; ++j) {
-      seo.outPartP[j][i] = p[j][i];
-    }
-    seo.outPartID[i] = LLIST[i];
-  }
-  seo.Nout = np;
-  return seo;
 }
 
 void sophia_interface::eventgen(int L0, double E0, double eps, double theta) {
@@ -135,6 +272,7 @@ void sophia_interface::eventgen(int L0, double E0, double eps, double theta) {
   //  P(2000,5) = 5-momentum of produced particles
   //  LLIST(2000) = code numbers of produced particles
   //  NP = number of produced particles
+  //  weight(2000) = statistical weights, see thinEvent
   // ***************************************************************
   // ** Date: 20/01/98       **
   // ** correct.:19/02/98    **
@@ -143,6 +281,7 @@ void sophia_interface::eventgen(int L0, double E0, double eps, double theta) {
   // ** authors: A.Muecke    **
   // **          R.Engel     **
   // **************************
+  SOPHIA_STAT(sophia_timer timer(statistics.tEventgen));
   const int IRESMAX = 9;
   const double pi = 3.1415926;
 
@@ -234,9 +373,11 @@ void sophia_interface::eventgen(int L0, double E0, double eps, double theta) {
   // check for threshold:
   const double sth = 1.1646;
   if (s < sth) {
-    std::cout << "input energy below threshold for photopion production! sqrt(s) = " << std::sqrt(s)
-              << std::endl;
+    SOPHIA_DIAG(diagnostics, sophia_diagnostics::warning, sophia_diagnostics::belowThreshold,
+                "input energy below threshold for photopion production! sqrt(s) = "
+                    << std::sqrt(s));
     np = 0;
+    lastImode = -1;
     return;
   }
 
@@ -252,6 +393,8 @@ void sophia_interface::eventgen(int L0, double E0, double eps, double theta) {
   // ********************************************************************
 
   int Imode = dec_inter3(eps_prime, L0);
+  lastImode = Imode;
+  SOPHIA_STAT(if (Imode >= 0 && Imode <= 6) statistics.nImode[Imode]++);
   // ******* PARTICLE PRODUCTION *****************
   if (Imode <= 5) {
     // direct/multipion/diffractive scattering production channel:
@@ -304,24 +447,36 @@ void sophia_interface::eventgen(int L0, double E0, double eps, double theta) {
   np = istable;
 
   // transformation from CM-system to lab-system:
-  for (int I = 0; I < np; ++I) {
-    std::vector<double> PO_TRANS_output = PO_TRANS(p[0][I], p[1][I], p[2][I], COD, SID, COF, SIF);
-    PC[0] = PO_TRANS_output[0];
-    PC[1] = PO_TRANS_output[1];
-    PC[2] = PO_TRANS_output[2];
-    PC[3] = p[3][I];
-    PO_ALTRA_output poa =
-        PO_ALTRA(GamBet[3], GamBet[0], GamBet[1], GamBet[2], PC[0], PC[1], PC[2], PC[3]);
-    p[0][I] = poa.PX;
-    p[1][I] = poa.PY;
-    p[2][I] = poa.PZ;
-    p[3][I] = poa.E;
-  }
+  // (PO_TRANS followed by PO_ALTRA for all particles)
+  rotateBoost(p[0], p[1], p[2], p[3], np, COD, SID, COF, SIF, GamBet[3], GamBet[0], GamBet[1],
+              GamBet[2]);
+  thinEvent();
 
   return;
 }
 
-static int Ic = 0;
+void sophia_interface::thinEvent() {
+  std::fill(&weight[0], &weight[0] + np, 1.);
+  if (!thinning) return;
+  int nKept = 0;
+  for (int i = 0; i < np; ++i) {
+    const double Eth = thinningEnergy[std::abs(LLIST[i]) - 1];
+    if (p[3][i] < Eth) {
+      if (RNDM() * Eth >= p[3][i]) continue;  // dropped with probability 1 - E / Eth
+      weight[i] = Eth / p[3][i];
+    }
+    LLIST[nKept] = LLIST[i];
+    for (int j = 0; j < 5; ++j) p[j][nKept] = p[j][i];
+    weight[nKept] = weight[i];
+    nKept++;
+  }
+  for (int i = nKept; i < np; ++i) {
+    LLIST[i] = 0;
+    for (int j = 0; j < 5; ++j) p[j][i] = 0.;
+  }
+  np = nKept;
+}
+
 void sophia_interface::gamma_h(double Ecm, int ip1, int Imode) {
   // **********************************************************************
   //
@@ -607,6 +762,7 @@ void sophia_interface::gamma_h(double Ecm, int ip1, int Imode) {
 
       // avoid infinite looping
       itry++;
+      SOPHIA_STAT(if (itry > 1) statistics.nGammaRetries++);
       if (itry > 50) {
         throw std::runtime_error("gamma_h: more than 50 internal rejections");
       }
@@ -614,16 +770,17 @@ void sophia_interface::gamma_h(double Ecm, int ip1, int Imode) {
       // simulate reggeon (one-string topology)
       if (RNDM() < prob_reg) {
         for (int i = 0; i < 1000; ++i) {
-          std::vector<int> valences_output1 = valences(ip1);
-          Ifl1a = valences_output1[0];
-          Ifl1b = valences_output1[1];
-          std::vector<int> valences_output2 = valences(ip2);
-          Ifl2a = valences_output2[0];
-          Ifl2b = valences_output2[1];
+          valences_output vo1 = valences(ip1);
+          Ifl1a = vo1.IFL1;
+          Ifl1b = vo1.IFL2;
+          valences_output vo2 = valences(ip2);
+          Ifl2a = vo2.IFL1;
+          Ifl2b = vo2.IFL2;
           if (Ifl1b == -Ifl2b) break;
           if (i == 999) {
-            std::cout << "gamma_h: simulation of reggeon impossible:" << ip1 << ", " << ip2
-                      << std::endl;
+            SOPHIA_DIAG(diagnostics, sophia_diagnostics::warning,
+                        sophia_diagnostics::reggeonImpossible,
+                        "gamma_h: simulation of reggeon impossible:" << ip1 << ", " << ip2);
             repeat100 = true;
             break;
           }
@@ -674,12 +831,12 @@ void sophia_interface::gamma_h(double Ecm, int ip1, int Imode) {
 
         // simulate pomeron (two-string topology)
       } else {
-        std::vector<int> valences_output1 = valences(ip1);
-        int Ifl1a = valences_output1[0];
-        int Ifl1b = valences_output1[1];
-        std::vector<int> valences_output2 = valences(ip2);
-        int Ifl2a = valences_output2[0];
-        int Ifl2b = valences_output2[1];
+        valences_output vo1 = valences(ip1);
+        int Ifl1a = vo1.IFL1;
+        int Ifl1b = vo1.IFL2;
+        valences_output vo2 = valences(ip2);
+        int Ifl2a = vo2.IFL1;
+        int Ifl2b = vo2.IFL2;
         if (Ifl1a * Ifl2a < 0) {
           int j = Ifl2a;
           Ifl2a = Ifl2b;
@@ -1164,13 +1321,14 @@ void sophia_interface::DECSIB() {
   // decayed particle have the code increased by 10000
   // (taken from SIBYLL 1.7, R.E. 04/98)
   // ***********************************************************************
-  int LLIST1[2000] = {0};
+  SOPHIA_STAT(sophia_timer timer(statistics.tDecay));
   double P0[5] = {0.};
   int NN = 1;
   while (NN <= np) {
     int L = LLIST[NN - 1];
     if (L == 0) throw std::runtime_error("DECSIB: L is never supposed to be zero.");
     if (IDB[std::abs(L) - 1] > 0) {
+      SOPHIA_STAT(statistics.nDecays++);
       for (int K = 0; K < 5; ++K) {
         P0[K] = p[K][NN - 1];
       }
@@ -1178,12 +1336,12 @@ void sophia_interface::DECSIB() {
       int ND = dno.ND;
       int sgn = (LLIST[NN - 1] < 0) ? -1 : 1;
       LLIST[NN - 1] += sgn * 10000;
+      reserveParticles(np + ND);
       for (int J = 0; J < ND; ++J) {
         for (int K = 0; K < 5; ++K) {
           p[K][np + J] = dno.P_out[K][J];
         }
         LLIST[np + J] = dno.LL[J];
-        LLIST1[np + J] = NN;
       }
       np += ND;
     }
@@ -1206,7 +1364,7 @@ DECPAR_zero_output sophia_interface::DECPAR_zero(double P0[5], int ND, int LL[10
   const double PI = 3.1415927;
 
   // c.m.s. Momentum in two particle decays
-  std::function<double(double, double, double)> PAWT = [&](double A, double B, double C) {
+  auto PAWT = [&](double A, double B, double C) {
     return std::sqrt((A * A - (B + C) * (B + C)) * (A * A - (B - C) * (B - C))) / (2. * A);
   };
 
@@ -1376,7 +1534,7 @@ DECPAR_nonZero_output sophia_interface::DECPAR_nonZero(int LA, double P0[5]) {
   const double PI = 3.1415927;
 
   // c.m.s. Momentum in two particle decays
-  std::function<double(double, double, double)> PAWT = [&](double A, double B, double C) {
+  auto PAWT = [&](double A, double B, double C) {
     return std::sqrt((A * A - (B + C) * (B + C)) * (A * A - (B - C) * (B - C))) / (2. * A);
   };
 
@@ -1510,13 +1668,9 @@ DECPAR_nonZero_output sophia_interface::DECPAR_nonZero(int LA, double P0[5]) {
         BE[J] = PV[J][IL - 1] / PV[3][IL - 1];
       }
       double GA = PV[3][IL - 1] / PV[4][IL - 1];
-      for (int I = IL; I < ND + 1; ++I) {  // 340 (second)
-        double BEP = BE[0] * P_out[0][I - 1] + BE[1] * P_out[1][I - 1] + BE[2] * P_out[2][I - 1];
-        for (int J = 0; J < 3; ++J) {
-          P_out[J][I - 1] += GA * (GA * BEP / (1. + GA) + P_out[3][I - 1]) * BE[J];
-        }
-        P_out[3][I - 1] = GA * (P_out[3][I - 1] + BEP);
-      }
+      // 340 (second): particles IL..ND
+      boost(&P_out[0][IL - 1], &P_out[1][IL - 1], &P_out[2][IL - 1], &P_out[3][IL - 1],
+            ND - IL + 1, BE[0], BE[1], BE[2], GA);
     }
 
     // Weak decays
@@ -1541,13 +1695,7 @@ DECPAR_nonZero_output sophia_interface::DECPAR_nonZero(int LA, double P0[5]) {
       BE[J] = P0[J] / P0[3];
     }
     double GA = P0[3] / P0[4];
-    for (int I = 0; I < ND; ++I) {
-      double BEP = BE[0] * P_out[0][I] + BE[1] * P_out[1][I] + BE[2] * P_out[2][I];
-      for (int J = 0; J < 3; ++J) {
-        P_out[J][I] += GA * (GA * BEP / (1. + GA) + P_out[3][I]) * BE[J];
-      }
-      P_out[3][I] = GA * (P_out[3][I] + BEP);
-    }
+    boost(P_out[0], P_out[1], P_out[2], P_out[3], ND, BE[0], BE[1], BE[2], GA);
   }
 
   // labels for antiparticle decay
@@ -1576,8 +1724,9 @@ PO_MSHELL_output sophia_interface::PO_MSHELL(double PA1[4], double PA2[4], doubl
   //              P1,P2     changed momentum vectors
   // (taken from PHOJET 1.12, R.E. 08/98)
   // ********************************************************************
-  std::vector<double> P1;
-  std::vector<double> P2;
+  PO_MSHELL_output pmo;
+  double* P1 = pmo.P1;
+  double* P2 = pmo.P2;
 
   // Lorentz transformation into system CMS
   double PX = PA1[0] + PA2[0];
@@ -1592,10 +1741,10 @@ PO_MSHELL_output sophia_interface::PO_MSHELL(double PA1[4], double PA2[4], doubl
 
   PO_ALTRA_output pao = PO_ALTRA(GAM, -BGX, -BGY, -BGZ, PA1[0], PA1[1], PA1[2], PA1[3]);
   double PTOT1 = pao.P;
-  P1.push_back(pao.PX);
-  P1.push_back(pao.PY);
-  P1.push_back(pao.PZ);
-  P1.push_back(pao.E);
+  P1[0] = pao.PX;
+  P1[1] = pao.PY;
+  P1[2] = pao.PZ;
+  P1[3] = pao.E;
 
   // rotation angles
   const double DEPS = 1e-5;
@@ -1621,31 +1770,27 @@ PO_MSHELL_output sophia_interface::PO_MSHELL(double PA1[4], double PA2[4], doubl
   double EE2 = XMS - EE1;
 
   // back rotation
-  std::vector<double> PO_TRANS_output = PO_TRANS(0., 0., PCMP, COD, SID, COF, SIF);
-  double XX = PO_TRANS_output[0];
-  double YY = PO_TRANS_output[1];
-  double ZZ = PO_TRANS_output[2];
+  PO_TRANS_output pto = PO_TRANS(0., 0., PCMP, COD, SID, COF, SIF);
+  double XX = pto.X;
+  double YY = pto.Y;
+  double ZZ = pto.Z;
 
-  P1.clear();
   pao = PO_ALTRA(GAM, BGX, BGY, BGZ, XX, YY, ZZ, EE1);
-  P1.push_back(pao.PX);
-  P1.push_back(pao.PY);
-  P1.push_back(pao.PZ);
-  P1.push_back(pao.E);
+  P1[0] = pao.PX;
+  P1[1] = pao.PY;
+  P1[2] = pao.PZ;
+  P1[3] = pao.E;
 
   pao = PO_ALTRA(GAM, BGX, BGY, BGZ, -XX, -YY, -ZZ, EE2);
-  P2.push_back(pao.PX);
-  P2.push_back(pao.PY);
-  P2.push_back(pao.PZ);
-  P2.push_back(pao.E);
+  P2[0] = pao.PX;
+  P2[1] = pao.PY;
+  P2[2] = pao.PZ;
+  P2[3] = pao.E;
 
-  PO_MSHELL_output pmo;
-  pmo.P1 = P1;
-  pmo.P2 = P2;
   return pmo;
 }
 
-std::vector<int> sophia_interface::valences(int ip) {
+valences_output sophia_interface::valences(int ip) {
   // valence quark composition of various particles  (R.E. 03/98)
   // (with special treatment of photons)
 
@@ -1705,9 +1850,9 @@ std::vector<int> sophia_interface::valences(int ip) {
     ival2 = k;
   }
 
-  std::vector<int> output;
-  output.push_back(ival1);
-  output.push_back(ival2);
+  valences_output output;
+  output.IFL1 = ival1;
+  output.IFL2 = ival2;
   return output;
 }
 
@@ -1740,27 +1885,33 @@ void sophia_interface::check_event(int Ic, double Esum, double PXsum, double PYs
   }
 
   if (ichar != IQchr) {
-    std::cout << " charge conservation violated: Ic = " << Ic << std::endl;
+    SOPHIA_DIAG(diagnostics, sophia_diagnostics::error, sophia_diagnostics::conservationViolated,
+                " charge conservation violated: Ic = " << Ic);
     hasFailed = true;
   }
   if (ibary != IQbar) {
-    std::cout << " baryon number conservation violated: Ic = " << Ic << std::endl;
+    SOPHIA_DIAG(diagnostics, sophia_diagnostics::error, sophia_diagnostics::conservationViolated,
+                " baryon number conservation violated: Ic = " << Ic);
     hasFailed = true;
   }
   if (std::abs((px - PXsum) / std::max(PXsum, PTscale)) > 1.e-3) {
-    std::cout << " x momentum conservation violated: Ic = " << Ic << std::endl;
+    SOPHIA_DIAG(diagnostics, sophia_diagnostics::error, sophia_diagnostics::conservationViolated,
+                " x momentum conservation violated: Ic = " << Ic);
     hasFailed = true;
   }
   if (std::abs((py - PYsum) / std::max(PYsum, PTscale)) > 1.e-3) {
-    std::cout << " y momentum conservation violated: Ic = " << Ic << std::endl;
+    SOPHIA_DIAG(diagnostics, sophia_diagnostics::error, sophia_diagnostics::conservationViolated,
+                " y momentum conservation violated: Ic = " << Ic);
     hasFailed = true;
   }
   if (std::abs((pz - PZsum) / std::max(std::abs(PZsum), PLscale)) > 1.e-3) {
-    std::cout << " z momentum conservation violated: Ic = " << Ic << std::endl;
+    SOPHIA_DIAG(diagnostics, sophia_diagnostics::error, sophia_diagnostics::conservationViolated,
+                " z momentum conservation violated: Ic = " << Ic);
     hasFailed = true;
   }
   if (std::abs((ee - Esum) / std::max(Esum, 1.)) > 1.e-3) {
-    std::cout << " energy conservation violated: Ic = " << Ic << std::endl;
+    SOPHIA_DIAG(diagnostics, sophia_diagnostics::error, sophia_diagnostics::conservationViolated,
+                " energy conservation violated: Ic = " << Ic);
     hasFailed = true;
   }
   // debugNonLUND("check_event", false);
@@ -1778,10 +1929,11 @@ int sophia_interface::dec_res2(double eps_prime, int IRESMAX, int L0) {
   double prob_sum[9] = {0.};
 
   // sum of all resonances:
+  const crossection_output xco = crossections(eps_prime, L0);
   double sumres = 0.;
   for (int j = 1; j < IRESMAX + 1; ++j) {
     int j10 = j + 10;
-    sumres += crossection(eps_prime, j10, L0);
+    sumres += xco.sigma[j10];
     prob_sum[j - 1] = sumres;
   }
 
@@ -1977,14 +2129,16 @@ int sophia_interface::dec_inter3(double eps_prime, int L0) {
   // **********************
   int Imode = -1;
 
-  double tot = crossection(eps_prime, 3, L0);
+  // all channels in one evaluation
+  const crossection_output xco = crossections(eps_prime, L0);
+  double tot = xco.sigma[3];
   if (tot == 0.) tot = 1.;
-  const double prob1 = crossection(eps_prime, 1, L0) / tot;
-  const double prob2 = crossection(eps_prime, 7, L0) / tot;
-  const double prob3 = crossection(eps_prime, 2, L0) / tot;
-  const double prob4 = crossection(eps_prime, 8, L0) / tot;
-  const double prob5 = crossection(eps_prime, 9, L0) / tot;
-  const double prob6 = crossection(eps_prime, 0, L0) / tot;
+  const double prob1 = xco.sigma[1] / tot;
+  const double prob2 = xco.sigma[7] / tot;
+  const double prob3 = xco.sigma[2] / tot;
+  const double prob4 = xco.sigma[8] / tot;
+  const double prob5 = xco.sigma[9] / tot;
+  const double prob6 = xco.sigma[0] / tot;
   const double rn = RNDM();
   if (rn < prob1) {
     Imode = 6;  // --> resonance decay
@@ -2016,6 +2170,8 @@ double sophia_interface::sample_s(double eps, int L0, double Ein) {
   // ** Date: 20/01/98   **
   // ** author: A.Muecke **
   // **********************
+  SOPHIA_STAT(sophia_timer timer(statistics.tSample));
+  SOPHIA_STAT(statistics.nSample++);
   double s = 0.;
   double xmp = AM[L0 - 1];
   double Pp = std::sqrt(Ein * Ein - xmp * xmp);
@@ -2025,6 +2181,9 @@ double sophia_interface::sample_s(double eps, int L0, double Ein) {
     s = smin + RNDM() * 1e-6;
     return s;
   }
+  if (functsTable && smax <= functsTable->getSMax()) {
+    return functsTable->sample(smax, L0, RNDM());
+  }
 
   // determine which method applies: rejection or analyt. inversion:
   double s0 = 10.;
@@ -2047,6 +2206,7 @@ double sophia_interface::sample_s(double eps, int L0, double Ein) {
     // pmax is roughly p(s) at s=s0
     double pmax = 1300. / sintegr1;
     do {
+      SOPHIA_STAT(if (i_rept > 0) statistics.nSampleRejected++);
       // sample s random between smin ... s0 **
       if (i_rept >= 100000) return s;
       s = smin + RNDM() * (smax - smin);
@@ -2082,39 +2242,64 @@ double sophia_interface::functs(double s, int L0) {
 }
 
 double sophia_interface::crossection(double x, int NDIR, int NL0) {
-  // calculates crossection of Nucleon-gamma-interaction
-  // (see thesis of J.Rachen, p.45ff and corrections
-  // report from 27/04/98, 5/05/98, 22/05/98 of J.Rachen)
-  // ** Date: 20/01/98   **
-  // ** correct.:27/04/98**
-  // ** update: 23/05/98 **
-  // ** author: A.Muecke **
+  if (crossectionTable) return crossectionTable->crossection(x, NDIR, NL0);
+  return crossection_analytic(x, NDIR, NL0);
+}
 
+crossection_output sophia_interface::crossections(double x, int NL0) {
+  if (crossectionTable) return crossectionTable->crossections(x, NL0);
+  return crossections_analytic(x, NL0);
+}
+
+double sophia_interface::crossection_analytic(double x, int NDIR, int NL0) {
   if (NL0 != 13 && NL0 != 14)
     throw std::runtime_error("crossection: particle ID incorrectly specified.");
-  const double AM2 =
-      (NL0 == 13)
-          ? 0.880351
-          : 0.882792;  // used to be array AM2[49]. Only these two values of it are ever used.
-  double SIG0[9] = {0.};
-  double AMRES[9] = {0.};
-  double WIDTH[9] = {0.};
-
-  if (NL0 == 13) {
-    for (int i = 0; i < 9; ++i) {
-      SIG0[i] = 4.893089117 / AM2 * RATIOJp[i] * BGAMMAp[i];
-      AMRES[i] = AMRESp[i];
-      WIDTH[i] = WIDTHp[i];
-    }
-  }
+  if (NDIR < 0 || NDIR >= crossection_output::nChannels)
+    throw std::runtime_error("wrong input NDIR in crossection.f !");
+  return crossections_analytic(x, NL0).sigma[NDIR];
+}
 
-  if (NL0 == 14) {
+// resonance parameters of crossection, set up once per nucleon
+namespace {
+struct resonance_parameters {
+  double SIG0[9];
+  double AMRES[9];
+  double WIDTH[9];
+
+  explicit resonance_parameters(int NL0) {
+    const double AM2 =
+        (NL0 == 13)
+            ? 0.880351
+            : 0.882792;  // used to be array AM2[49]. Only these two values of it are ever used.
     for (int i = 0; i < 9; ++i) {
-      SIG0[i] = 4.893089117 / AM2 * RATIOJn[i] * BGAMMAn[i];
-      AMRES[i] = AMRESn[i];
-      WIDTH[i] = WIDTHn[i];
+      if (NL0 == 13) {
+        SIG0[i] = 4.893089117 / AM2 * RATIOJp[i] * BGAMMAp[i];
+        AMRES[i] = AMRESp[i];
+        WIDTH[i] = WIDTHp[i];
+      } else {
+        SIG0[i] = 4.893089117 / AM2 * RATIOJn[i] * BGAMMAn[i];
+        AMRES[i] = AMRESn[i];
+        WIDTH[i] = WIDTHn[i];
+      }
     }
   }
+};
+const resonance_parameters resonances[2] = {resonance_parameters(13), resonance_parameters(14)};
+}  // namespace
+
+template <int NL0>
+static crossection_output crossectionsAnalytic(double x) {
+  // calculates crossection of Nucleon-gamma-interaction
+  // (see thesis of J.Rachen, p.45ff and corrections
+  // report from 27/04/98, 5/05/98, 22/05/98 of J.Rachen)
+  // ** Date: 20/01/98   **
+  // ** correct.:27/04/98**
+  // ** update: 23/05/98 **
+  // ** author: A.Muecke **
+  const double* SIG0 = resonances[NL0 - 13].SIG0;
+  const double* AMRES = resonances[NL0 - 13].AMRES;
+  const double* WIDTH = resonances[NL0 - 13].WIDTH;
+  crossection_output xco;
 
   double sig_res[9] = {0.};
 
@@ -2122,7 +2307,7 @@ double sophia_interface::crossection(double x, int NDIR, int NL0) {
   const double pm = AM[NL0 - 1];
   const double s = pm * pm + 2. * pm * x;
   if (s < sth) {
-    return 0.;
+    return xco;
   }
   double cross_res = 0.;
   double cross_dir = 0.;
@@ -2130,31 +2315,30 @@ double sophia_interface::crossection(double x, int NDIR, int NL0) {
   double cross_dir2 = 0.;
   if (x <= 10.) {
     // RESONANCES:
-    cross_res = breitwigner(SIG0[0], WIDTH[0], AMRES[0], x) * Ef(x, 0.152, 0.17);
+    cross_res = sophia_interface::breitwigner(SIG0[0], WIDTH[0], AMRES[0], x) *
+                sophia_interface::Ef(x, 0.152, 0.17);
     sig_res[0] = cross_res;
 
     for (int Ni = 1; Ni < 9; ++Ni) {
-      sig_res[Ni] = breitwigner(SIG0[Ni], WIDTH[Ni], AMRES[Ni], x) * Ef(x, 0.15, 0.38);
+      sig_res[Ni] = sophia_interface::breitwigner(SIG0[Ni], WIDTH[Ni], AMRES[Ni], x) *
+                    sophia_interface::Ef(x, 0.15, 0.38);
       cross_res += sig_res[Ni];
     }
     // DIRECT CHANNEL:
     if (x > 0.1 && x < 0.6) {
-      cross_dir1 = singleback(x) + 40. * std::exp(-(x - 0.29) * (x - 0.29) / 0.002) -
+      cross_dir1 = sophia_interface::singleback(x) +
+                   40. * std::exp(-(x - 0.29) * (x - 0.29) / 0.002) -
                    15. * std::exp(-(x - 0.37) * (x - 0.37) / 0.002);
     } else {
-      cross_dir1 = singleback(x);
+      cross_dir1 = sophia_interface::singleback(x);
     }
-    cross_dir2 = twoback(x);
+    cross_dir2 = sophia_interface::twoback(x);
     cross_dir = cross_dir1 + cross_dir2;
   }
 
   // FRAGMENTATION 2:
-  double cross_frag2 = 0.;
-  if (NL0 == 13) {
-    cross_frag2 = 80.3 * Ef(x, 0.5, 0.1) * std::pow(s, -0.34);
-  } else if (NL0 == 14) {
-    cross_frag2 = 60.2 * Ef(x, 0.5, 0.1) * std::pow(s, -0.34);
-  }
+  const double sm034 = std::pow(s, -0.34);
+  double cross_frag2 = (NL0 == 13 ? 80.3 : 60.2) * sophia_interface::Ef(x, 0.5, 0.1) * sm034;
 
   // MULTIPION PRODUCTION/FRAGMENTATION 1 CROSS SECTION
   double cross_diffr = 0.;
@@ -2164,18 +2348,11 @@ double sophia_interface::crossection(double x, int NDIR, int NL0) {
   double cs_multi = 0.;
   if (x > 0.85) {
     double ss1 = (x - .85) / .69;
-    double ss2 = 0.;
-    if (NL0 == 13) {
-      ss2 = 29.3 * std::pow(s, -.34) + 59.3 * std::pow(s, .095);
-    } else if (NL0 == 14) {
-      ss2 = 26.4 * std::pow(s, -.34) + 59.3 * std::pow(s, .095);
-    }
+    double ss2 = (NL0 == 13 ? 29.3 : 26.4) * sm034 + 59.3 * std::pow(s, .095);
     cs_multidiff = (1. - std::exp(-ss1)) * ss2;
     cs_multi = 0.89 * cs_multidiff;
 
     // DIFFRACTIVE SCATTERING:
-    cross_diffr1 = .099 * cs_multidiff;
-    cross_diffr2 = .011 * cs_multidiff;
     cross_diffr = 0.11 * cs_multidiff;
 
     ss1 = std::pow((x - .85), .75) / .64;
@@ -2194,56 +2371,26 @@ double sophia_interface::crossection(double x, int NDIR, int NL0) {
     cs_multidiff = cs_multi + cross_diffr;
   }
 
-  double xSection = 0.;
-  switch (NDIR) {
-    case 0:
-      xSection = cross_res + cross_dir + cross_diffr + cross_frag2;
-      break;
-    case 1:
-      xSection = cross_res;
-      break;
-    case 2:
-      xSection = cross_res + cross_dir;
-      break;
-    case 3:
-      xSection = cross_res + cross_dir + cs_multidiff + cross_frag2;
-      break;
-    case 4:
-      xSection = cross_dir;
-      break;
-    case 5:
-      xSection = cs_multi;
-      break;
-    case 6:
-      xSection = cross_res + cross_dir2;
-      break;
-    case 7:
-      xSection = cross_res + cross_dir1;
-      break;
-    case 8:
-      xSection = cross_res + cross_dir + cross_diffr1;
-      break;
-    case 9:
-      xSection = cross_res + cross_dir + cross_diffr;
-      break;
-    case 10:
-      xSection = cross_diffr;
-      break;
-    case 11:
-    case 12:
-    case 13:
-    case 14:
-    case 15:
-    case 16:
-    case 17:
-    case 18:
-    case 19:
-      xSection = sig_res[NDIR - 11];
-      break;
-    default:
-      throw std::runtime_error("wrong input NDIR in crossection.f !");
-  }
-  return xSection;
+  double* xSection = xco.sigma;
+  xSection[0] = cross_res + cross_dir + cross_diffr + cross_frag2;
+  xSection[1] = cross_res;
+  xSection[2] = cross_res + cross_dir;
+  xSection[3] = cross_res + cross_dir + cs_multidiff + cross_frag2;
+  xSection[4] = cross_dir;
+  xSection[5] = cs_multi;
+  xSection[6] = cross_res + cross_dir2;
+  xSection[7] = cross_res + cross_dir1;
+  xSection[8] = cross_res + cross_dir + cross_diffr1;
+  xSection[9] = cross_res + cross_dir + cross_diffr;
+  xSection[10] = cross_diffr;
+  for (int i = 0; i < 9; ++i) xSection[11 + i] = sig_res[i];
+  return xco;
+}
+
+crossection_output sophia_interface::crossections_analytic(double x, int NL0) {
+  if (NL0 == 13) return crossectionsAnalytic<13>(x);
+  if (NL0 == 14) return crossectionsAnalytic<14>(x);
+  throw std::runtime_error("crossection: particle ID incorrectly specified.");
 }
 
 dec_proc2_output sophia_interface::dec_proc2(double x, int IRES, int L0) {
@@ -2520,8 +2667,8 @@ PO_ALTRA_output sophia_interface::PO_ALTRA(double GA, double BGX, double BGY, do
   return pao;
 }
 
-std::vector<double> sophia_interface::PO_TRANS(double XO, double YO, double ZO, double CDE,
-                                               double SDE, double CFE, double SFE) {
+PO_TRANS_output sophia_interface::PO_TRANS(double XO, double YO, double ZO, double CDE, double SDE,
+                                           double CFE, double SFE) {
   // *********************************************************************
   // rotation of coordinate frame (1) de rotation around y axis
   //                              (2) fe rotation around z axis
@@ -2531,10 +2678,10 @@ std::vector<double> sophia_interface::PO_TRANS(double XO, double YO, double ZO,
   double Y = CDE * SFE * XO + CFE * YO + SDE * SFE * ZO;
   double Z = -SDE * XO + CDE * ZO;
 
-  std::vector<double> output;
-  output.push_back(X);
-  output.push_back(Y);
-  output.push_back(Z);
+  PO_TRANS_output output;
+  output.X = X;
+  output.Y = Y;
+  output.Z = Z;
   return output;
 }
 
@@ -2554,10 +2701,12 @@ PO_SELSX2_output sophia_interface::PO_SELSX2(double XMIN[2], double XMAX[2], dou
   double X4 = 0.;
 
   for (int I = 0; I < 100; ++I) {
+    SOPHIA_STAT(if (I > 0) statistics.nSelsxRejected++);
     int ITRY1 = 0;
     do {
       X1 = PO_RNDBET(2.5, 0.5);
       ITRY1++;
+      SOPHIA_STAT(if (ITRY1 > 1) statistics.nSelsxRejected++);
       if (ITRY1 >= 50) {
         pso.isRejected = true;
         return pso;
@@ -2568,6 +2717,7 @@ PO_SELSX2_output sophia_interface::PO_SELSX2(double XMIN[2], double XMAX[2], dou
     do {
       X2 = PO_RNDBET(0.5, 0.5);
       ITRY2++;
+      SOPHIA_STAT(if (ITRY2 > 1) statistics.nSelsxRejected++);
       if (ITRY2 >= 50) {
         pso.isRejected = true;
         return pso;
@@ -2671,9 +2821,10 @@ double sophia_interface::PO_RNDGAM(double ETA) {
   return Y;
 }
 
-static bool lund_frag_isInitialized = false;
 void sophia_interface::lund_frag(double SQS) {
   // interface to Lund/Jetset fragmentation (R.E. 08/98)
+  SOPHIA_STAT(sophia_timer timer(statistics.tFragmentation));
+  SOPHIA_STAT(statistics.nFragmentation++);
   int KC = 0;
   if (lund_frag_isInitialized == false) {
     // no title page
@@ -2709,12 +2860,13 @@ void sophia_interface::lund_frag(double SQS) {
   int II = MSTU[20];
   MSTU[20] = 1;
 
-  LUEXEC();
+  if (!simpleStrings || !fragmentSimpleStrings()) LUEXEC();
 
   MSTU[20] = II;
 
   // event accepted?
   if (MSTU[23] != 0) {
+    SOPHIA_STAT(statistics.nFragmentationFailed++);
     np = -1;
     return;
   }
@@ -2722,6 +2874,7 @@ void sophia_interface::lund_frag(double SQS) {
   LUEDIT(1);
 
   np = KLU(0, 1);
+  reserveParticles(np);
 
   return;
 }
@@ -2755,7 +2908,8 @@ void sophia_interface::lund_put(int I, int IFL, double PX, double PY, double PZ,
       Il = 1103;
       break;
     default:
-      std::cout << "flavour code: " << IFL << std::endl;
+      SOPHIA_DIAG(diagnostics, sophia_diagnostics::error, sophia_diagnostics::unknownFlavour,
+                  "flavour code: " << IFL);
       throw std::runtime_error("lund_put: unknown flavor code");
   }
 
@@ -2797,31 +2951,15 @@ lund_get_output sophia_interface::lund_get(int I) {
 
 int sophia_interface::ICON_PDG_SIB(int ID) {
   // convert PDG particle codes to SIBYLL particle codes (R.E. 09/97)
-  int ITABLE[49] = {22,   -11,  11,   -13,  13,   111,  211,  -211, 321,       -321,
-                    130,  310,  2212, 2112, 12,   -12,  14,   -14,  -99999999, -99999999,
-                    311,  -311, 221,  331,  213,  -213, 113,  323,  -323,      313,
-                    -313, 223,  333,  3222, 3212, 3112, 3322, 3312, 3122,      2224,
-                    2214, 2114, 1114, 3224, 3214, 3114, 3324, 3314, 3334};
-
-  int IDPDG = ID;
-  int IDA = std::abs(ID);
-  int IS = IDPDG;
-  int IC = 1;
-  if (IDA > 1000) {
-    IS = IDA;
-    IC = (IDPDG < 0) ? -1 : 1;
-  }
-
-  for (int i = 0; i < 49; ++i) {
-    if (IS == ITABLE[i]) {
-      return (i + 1) * IC;
-    }
-  }
+  const int IDPDG = ID;
+  const int sophiaID = PDGToSophia(IDPDG);
+  if (sophiaID != 0) return sophiaID;
 
   if (IDPDG == 80000) {
     return 13;
   } else {
-    std::cout << "ICON_PDG_DTU: no particle found for " << IDPDG << std::endl;
+    SOPHIA_DIAG(diagnostics, sophia_diagnostics::warning, sophia_diagnostics::unknownPDGID,
+                "ICON_PDG_DTU: no particle found for " << IDPDG);
     return 0;
   }
 }
@@ -2867,9 +3005,8 @@ double sophia_interface::breitwigner(double sigma_0, double Gamma, double DMM, d
 
 double sophia_interface::RNDM() {
   // This is the RNG called by all other non-JETSET routines.
-  // The same as RLU from JETSET except for another seed.
-  bool isCalledByRNDM = true;
-  return RLU(isCalledByRNDM);
+  // The same as RLU from JETSET, drawing from the same generator.
+  return RLU();
 }
 
 void sophia_interface::LUEXEC() {
@@ -2963,7 +3100,7 @@ void sophia_interface::LUEXEC() {
       // Loop back if enough space left in LUJETS and no error abort.
       if (MSTU[23] != 0 && MSTU[20] >= 2) {
         // do nothing
-      } else if (IP < N && N < MSTU[3] - 20 - MSTU[31]) {
+      } else if (IP < N && LUJETS_reserve(N + 21)) {
         repeat150 = true;
         continue;
       } else if (IP < N) {
@@ -2996,6 +3133,84 @@ void sophia_interface::LUEXEC() {
   return;
 }
 
+bool sophia_interface::fragmentSimpleStrings() {
+  // The record has to hold one or two open strings of two light partons, 1 - 2 (and 3 - 4),
+  // joined by LUJOIN or listed as K(I,1) = 2, 1, none of which LUPREP would collapse, and the
+  // JETSET settings have to be string fragmentation without Bose-Einstein effects. Otherwise
+  // nothing is done.
+  if (trackVertices || MSTJ[0] != 1 || MSTJ[50] > 0 || MSTJ[91] != 0) return false;
+  if (N != 2 && N != 4) return false;
+  for (int IS = 0; IS < N; IS += 2) {
+    const bool joined = K[0][IS] == 3 && K[0][IS + 1] == 3 &&
+                        K[3][IS] + K[4][IS] == MSTU[4] * (IS + 2) &&
+                        K[3][IS + 1] + K[4][IS + 1] == MSTU[4] * (IS + 1);
+    if (!joined && (K[0][IS] != 2 || K[0][IS + 1] != 1)) return false;
+    int KQSUM = 0;
+    double DPS[5] = {0.};
+    for (int I = IS; I < IS + 2; ++I) {
+      const int KC = LUCOMP(K[1][I]);
+      if (KC == 0) return false;
+      const int KQ = KCHG[1][KC - 1];  // 1: quark, -1: diquark, 2: gluon
+      const int KFA = std::abs(K[1][I]);
+      if (KQ == 1 ? KFA > 3 : (KQ != -1 || KFA / 1000 > 3 || (KFA / 100) % 10 > 3)) return false;
+      KQSUM += K[1][I] < 0 ? -KQ : KQ;
+      for (int J = 0; J < 4; ++J) {
+        DPS[J] += P[J][I];
+      }
+      MSTJ[92] = 1;
+      DPS[4] += ULMASS(K[1][I]);
+    }
+    if (KQSUM != 0) return false;
+    const double PD =
+        std::sqrt(std::max(0., DPS[3] * DPS[3] - DPS[0] * DPS[0] - DPS[1] * DPS[1] -
+                                   DPS[2] * DPS[2])) -
+        DPS[4];
+    if (MSTJ[13] > 0 && PD < PARJ[31]) return false;
+  }
+
+  // Initialize and reset as LUEXEC.
+  MSTU[23] = 0;
+  MSTU[30]++;
+  MSTU[0] = 0;
+  MSTU[1] = 0;
+  MSTU[2] = 0;
+  if (MSTU[16] <= 0) MSTU[89] = 0;
+  PARU[20] = 0.;
+  for (int I = 0; I < N; ++I) {
+    PARU[20] += P[3][I];
+  }
+
+  // String fragmentation.
+  const int NP = N;
+  for (int IP = 1; IP < NP; IP += 2) {
+    LUSTRF_twoParton(IP);
+    if (MSTU[23] != 0) return true;
+  }
+
+  // Particle decays in the order of LUEXEC. The decay tables of the light hadrons have no
+  // partonic channels, thus there is nothing to fragment or shower.
+  for (int IP = NP + 1; IP < N + 1; ++IP) {
+    if (K[0][IP - 1] <= 0 || K[0][IP - 1] > 10) continue;
+    const int KC = LUCOMP(K[1][IP - 1]);
+    if (KC == 0) continue;
+    if (KCHG[1][KC - 1] != 0) {
+      LUERRM(12, "fragmentSimpleStrings: parton produced in a decay");
+      return true;
+    }
+    if (MSTJ[20] >= 1 && MDCY[0][KC - 1] >= 1) LUDECY(IP);
+    if (MSTJ[91] != 0) {
+      MSTJ[91] = 0;
+      LUERRM(12, "fragmentSimpleStrings: parton shower requested by a decay");
+      return true;
+    }
+    if (IP < N && !LUJETS_reserve(N + 21)) {
+      LUERRM(11, "fragmentSimpleStrings: no more memory left in LUJETS");
+      return true;
+    }
+  }
+  return true;
+}
+
 void sophia_interface::LUDECY(int IP) {
   // Purpose: to handle the decay of unstable particles.
   double VDCY[4] = {0.};
@@ -3012,14 +3227,14 @@ void sophia_interface::LUDECY(int IP) {
 
   // Functions: momentum in two-particle decays, four-product and
   // matrix element times phase space in weak decays.
-  std::function<double(double, double, double)> PAWT = [&](double A, double B, double C) {
+  auto PAWT = [&](double A, double B, double C) {
     return std::sqrt((A * A - (B + C) * (B + C)) * (A * A - (B - C) * (B - C))) / (2. * A);
   };
-  std::function<double(int, int)> FOUR = [&](int I, int J) {
+  auto FOUR = [&](int I, int J) {
     return P[3][I - 1] * P[3][J - 1] - P[0][I - 1] * P[0][J - 1] - P[1][I - 1] * P[1][J - 1] -
            P[2][I - 1] * P[2][J - 1];
   };
-  std::function<double(double, double)> HMEPS = [&](int HA, int HRQ) {
+  auto HMEPS = [&](int HA, int HRQ) {
     return ((1. - HRQ - HA) * (1. - HRQ - HA) + 3. * HA * (1. + HRQ - HA)) *
            std::sqrt((1. - HRQ - HA) * (1. - HRQ - HA) - 4. * HRQ * HA);
   };
@@ -3044,13 +3259,17 @@ void sophia_interface::LUDECY(int IP) {
   MSTJ[91] = 0;
 
   // Choose lifetime and determine decay vertex.
-  if (K[0][IP - 1] == 5) {
-    V[4][IP - 1] = 0.;
-  } else if (K[0][IP - 1] != 4) {
-    V[4][IP - 1] = -PMAS[3][KC - 1] * std::log(RLU());
-  }
-  for (int J = 0; J < 4; ++J) {
-    VDCY[J] = V[J][IP - 1] + V[4][IP - 1] * P[J][IP - 1] / P[4][IP - 1];
+  double TAU = 0.;
+  if (K[0][IP - 1] == 4) {
+    if (trackVertices) TAU = V[4][IP - 1];
+  } else if (K[0][IP - 1] != 5) {
+    TAU = -PMAS[3][KC - 1] * std::log(RLU());
+  }
+  if (trackVertices) {
+    V[4][IP - 1] = TAU;
+    for (int J = 0; J < 4; ++J) {
+      VDCY[J] = V[J][IP - 1] + TAU * P[J][IP - 1] / P[4][IP - 1];
+    }
   }
 
   // Determine whether decay allowed or not.
@@ -3148,9 +3367,9 @@ void sophia_interface::LUDECY(int IP) {
     // Call tau decay routine (if meaningful) and fill extra info.
     if (KFORIG != 0 || MSTJ[27] == 2) {
       int NDECAY = ITAU + IORIG + KFORIG;
-      std::cout
-          << "LUDECY: LUTAUD: if this message occurs, JETSET would have been terminated, failing."
-          << std::endl;
+      SOPHIA_DIAG(
+          diagnostics, sophia_diagnostics::warning, sophia_diagnostics::tauDecay,
+          "LUDECY: LUTAUD: if this message occurs, JETSET would have been terminated, failing.");
       for (int II = NSAV; II < NSAV + NDECAY; ++II) {
         K[0][II] = 1;
         K[2][II] = IP;
@@ -3190,11 +3409,13 @@ void sophia_interface::LUDECY(int IP) {
       }
 
       // Fill in position of decay vertex.
-      for (int Ii = NSAV; Ii < N; ++Ii) {
-        for (int J = 0; J < 4; ++J) {
-          V[J][Ii] = VDCY[J];
+      if (trackVertices) {
+        for (int Ii = NSAV; Ii < N; ++Ii) {
+          for (int J = 0; J < 4; ++J) {
+            V[J][Ii] = VDCY[J];
+          }
+          V[4][Ii] = 0.;
         }
-        V[4][Ii] = 0.;
       }
 
       LUDECY_setupPartonShowerEvolution(IP, NSAV, MMAT, ND, MMIX);
@@ -3207,7 +3428,7 @@ void sophia_interface::LUDECY(int IP) {
   if ((KFA == 511 || KFA == 531) && MSTJ[25] >= 1) {
     double XBBMIX = PARJ[75];
     if (KFA == 531) XBBMIX = PARJ[76];
-    if (std::pow(std::sin(0.5 * XBBMIX * V[4][IP - 1] / PMAS[3][KC - 1]), 2) > RLU()) MMIX = 1;
+    if (std::pow(std::sin(0.5 * XBBMIX * TAU / PMAS[3][KC - 1]), 2) > RLU()) MMIX = 1;
     if (MMIX == 1) KFS = -KFS;
   }
 
@@ -3236,13 +3457,17 @@ void sophia_interface::LUDECY(int IP) {
     KFSN = 1;
   }
 
-  // Sum branching ratios of allowed decay channels.
+  // Sum branching ratios of allowed decay channels. The allowed channels are kept in
+  // LUDECY_channels, such that the selection below walks only these.
   int NOPE = 0;
   double BRSU = 0.;
   for (int IDL = MDCY[1][KCA - 1]; IDL < MDCY[1][KCA - 1] + MDCY[2][KCA - 1]; ++IDL) {
     if (MDME[0][IDL - 1] != 1 && KFSP * MDME[0][IDL - 1] != 2 && KFSN * MDME[0][IDL - 1] != 3)
       continue;
     if (MDME[1][IDL - 1] > 100) continue;
+    if (NOPE == maxDecayChannels)
+      throw std::runtime_error("LUDECY: more allowed decay channels than maxDecayChannels");
+    LUDECY_channels[NOPE] = IDL;
     NOPE++;
     BRSU += BRAT[IDL - 1];
   }
@@ -3274,32 +3499,13 @@ void sophia_interface::LUDECY(int IP) {
     if (goto240) {
       goto240 = false;
 
+      // loop 250 over the allowed channels only; the last one takes the rounding remainder
       double RBR = BRSU * RLU();
-      int IDL = MDCY[1][KCA - 1] - 1;
-
-      bool repeat250 = false;
-      do {  // 250
-        repeat250 = false;
-        IDL++;
-        if (MDME[0][IDL - 1] != 1 && KFSP * MDME[0][IDL - 1] != 2 && KFSN * MDME[0][IDL - 1] != 3) {
-          if (IDL < MDCY[1][KCA - 1] + MDCY[2][KCA - 1] - 1) {
-            repeat250 = true;
-            continue;
-          }
-        } else if (MDME[1][IDL - 1] > 100) {
-          if (IDL < MDCY[1][KCA - 1] + MDCY[2][KCA - 1] - 1) {
-            repeat250 = true;
-            continue;
-          }
-        } else {
-          IDC = IDL;
-          RBR -= BRAT[IDL - 1];
-          if (IDL < MDCY[1][KCA - 1] + MDCY[2][KCA - 1] - 1 && RBR > 0.) {
-            repeat250 = true;
-            continue;
-          }
-        }
-      } while (repeat250);
+      for (int IOPE = 0; IOPE < NOPE; ++IOPE) {
+        IDC = LUDECY_channels[IOPE];
+        RBR -= BRAT[IDC - 1];
+        if (!(RBR > 0.)) break;
+      }
 
       // Start readout of decay channel: matrix element, reset counters.
       MMAT = MDME[1][IDC - 1];
@@ -3355,9 +3561,9 @@ void sophia_interface::LUDECY(int IP) {
         } else if (KPA == 81) {
           KFP = KFS * (1000 * ((KFA / 10) % 10) + 100 * ((KFA / 100) % 10) + 1);
         } else if (KP == 82) {
-          std::vector<int> LUKFDI_output =
+          LUKFDI_output lko =
               LUKFDI(-KFS * static_cast<int>(1. + (2. + PARJ[1]) * RLU()), 0);
-          KFP = LUKFDI_output[0];
+          KFP = lko.KFL3;
           if (KFP == 0) {
             goto240 = false;
             goto260 = true;
@@ -3393,8 +3599,8 @@ void sophia_interface::LUDECY(int IP) {
           PS -= P[4][I - 1];
           K[0][I - 1] = 1;
           int KFI = K[1][I - 1];
-          std::vector<int> LUKFDI_output = LUKFDI(KFP, KFI);
-          K[1][I - 1] = LUKFDI_output[1];
+          LUKFDI_output lko = LUKFDI(KFP, KFI);
+          K[1][I - 1] = lko.KF;
           if (K[1][I - 1] == 0) {
             goto240 = false;
             goto260 = true;
@@ -3484,9 +3690,9 @@ void sophia_interface::LUDECY(int IP) {
         if (ND != NP + NQ / 2) {  // skip condition 330
           for (int Ii = N + NP; Ii < N + ND - NQ / 2; ++Ii) {
             JT = 1 + static_cast<int>((NQ - 1) * RLU());
-            std::vector<int> LUKFDI_output = LUKFDI(KFL1[JT - 1], 0);
-            int KFL2 = LUKFDI_output[0];
-            K[1][Ii] = LUKFDI_output[1];
+            LUKFDI_output lko = LUKFDI(KFL1[JT - 1], 0);
+            int KFL2 = lko.KFL3;
+            K[1][Ii] = lko.KF;
             if (K[1][Ii] == 0) {
               repeat300 = true;
               break;
@@ -3505,15 +3711,15 @@ void sophia_interface::LUDECY(int IP) {
         if (JT == 4 && sgn1 * sgn2 > 0) JT = 3;
         if (JT == 3) JT2 = 2;
         if (JT == 4) JT3 = 2;
-        std::vector<int> LUKFDI_output = LUKFDI(KFL1[0], KFL1[JT - 1]);
-        K[1][N + ND - NQ / 2] = LUKFDI_output[1];
+        LUKFDI_output lko = LUKFDI(KFL1[0], KFL1[JT - 1]);
+        K[1][N + ND - NQ / 2] = lko.KF;
         if (K[1][N + ND - NQ / 2] == 0) {
           repeat300 = true;
           continue;
         }
         if (NQ == 4) {
-          std::vector<int> LUKFDI_output = LUKFDI(KFL1[JT2 - 1], KFL1[JT3 - 1]);
-          K[1][N + ND - 1] = LUKFDI_output[1];
+          LUKFDI_output lko = LUKFDI(KFL1[JT2 - 1], KFL1[JT3 - 1]);
+          K[1][N + ND - 1] = lko.KF;
         }
         if (NQ == 4 && K[1][N + ND - 1] == 0) {
           repeat300 = true;
@@ -3717,11 +3923,13 @@ void sophia_interface::LUDECY(int IP) {
       }
 
       // Fill in position of decay vertex.
-      for (int Ii = NSAV; Ii < N; ++Ii) {
-        for (int J = 0; J < 4; ++J) {
-          V[J][Ii] = VDCY[J];
+      if (trackVertices) {
+        for (int Ii = NSAV; Ii < N; ++Ii) {
+          for (int J = 0; J < 4; ++J) {
+            V[J][Ii] = VDCY[J];
+          }
+          V[4][Ii] = 0.;
         }
-        V[4][Ii] = 0.;
       }
 
       LUDECY_setupPartonShowerEvolution(IP, NSAV, MMAT, ND, MMIX);
@@ -3978,11 +4186,13 @@ void sophia_interface::LUDECY(int IP) {
           }
 
           // Fill in position of decay vertex.
-          for (int Ii = NSAV; Ii < N; ++Ii) {
-            for (int J = 0; J < 4; ++J) {
-              V[J][Ii] = VDCY[J];
+          if (trackVertices) {
+            for (int Ii = NSAV; Ii < N; ++Ii) {
+              for (int J = 0; J < 4; ++J) {
+                V[J][Ii] = VDCY[J];
+              }
+              V[4][Ii] = 0.;
             }
-            V[4][Ii] = 0.;
           }
 
           LUDECY_setupPartonShowerEvolution(IP, NSAV, MMAT, ND, MMIX);
@@ -3990,8 +4200,8 @@ void sophia_interface::LUDECY(int IP) {
         }
         K[0][N + 1] = 1;
         int KFTEMP = K[1][N + 1];
-        std::vector<int> LUKFDI_output = LUKFDI(KFTEMP, K[1][N + 2]);
-        K[1][N + 1] = LUKFDI_output[1];
+        LUKFDI_output lko = LUKFDI(KFTEMP, K[1][N + 2]);
+        K[1][N + 1] = lko.KF;
         if (K[1][N + 1] == 0) {
           goto240 = false;
           goto260 = true;
@@ -4018,8 +4228,10 @@ void sophia_interface::LUDECY(int IP) {
         if (goto630 == false) {  // skip condition 630
           K[0][N + 2] = 1;
           int KFTEMP = K[1][N + 2];
-          std::vector<int> LUKFDI_output = LUKFDI(KFTEMP, K[1][N + 3]);
-          LUKFDI_output[1] = K[1][N + 2];
+          // JETSET sets K(N+3,2) to the new flavour here. The C++ port assigned the other way
+          // round, i.e. dropped it; kept on purpose, so that the events stay the legacy ones.
+          // LUKFDI still runs for its random numbers.
+          LUKFDI(KFTEMP, K[1][N + 3]);
           if (K[1][N + 2] == 0) {
             goto240 = false;
             goto260 = true;
@@ -4068,11 +4280,11 @@ void sophia_interface::LUDECY(int IP) {
           if (PMR > PARJ[31] + PM1 + PM2) break;
           int KFLDUM = static_cast<int>(1.5 + RLU());
           int sgn1 = (K[1][N] < 0) ? -1 : 1;
-          std::vector<int> LUKFDI_output1 = LUKFDI(K[1][N], -KFLDUM * sgn1);
-          int KF1 = LUKFDI_output1[1];
+          LUKFDI_output lko1 = LUKFDI(K[1][N], -KFLDUM * sgn1);
+          int KF1 = lko1.KF;
           int sgn2 = (K[1][N + 1] < 0) ? -1 : 1;
-          std::vector<int> LUKFDI_output2 = LUKFDI(K[1][N + 1], -KFLDUM * sgn2);
-          int KF2 = LUKFDI_output2[1];
+          LUKFDI_output lko2 = LUKFDI(K[1][N + 1], -KFLDUM * sgn2);
+          int KF2 = lko2.KF;
           if (KF1 == 0 || KF2 == 0) {
             goto240 = false;
             goto260 = true;
@@ -4095,8 +4307,8 @@ void sophia_interface::LUDECY(int IP) {
           }
           K[0][N] = 1;
           int KFTEMP = K[1][N];
-          std::vector<int> LUKFDI_output = LUKFDI(KFTEMP, K[1][N + 1]);
-          K[1][N] = LUKFDI_output[1];
+          LUKFDI_output lko = LUKFDI(KFTEMP, K[1][N + 1]);
+          K[1][N] = lko.KF;
           if (K[1][N] == 0) {
             goto240 = false;
             goto260 = true;
@@ -4173,11 +4385,13 @@ void sophia_interface::LUDECY(int IP) {
   }
 
   // Fill in position of decay vertex.
-  for (int Ii = NSAV; Ii < N; ++Ii) {
-    for (int J = 0; J < 4; ++J) {
-      V[J][Ii] = VDCY[J];
+  if (trackVertices) {
+    for (int Ii = NSAV; Ii < N; ++Ii) {
+      for (int J = 0; J < 4; ++J) {
+        V[J][Ii] = VDCY[J];
+      }
+      V[4][Ii] = 0.;
     }
-    V[4][Ii] = 0.;
   }
 
   LUDECY_setupPartonShowerEvolution(IP, NSAV, MMAT, ND, MMIX);
@@ -4291,11 +4505,11 @@ void sophia_interface::LUSTRF(int IP) {
   double PARU9T[8] = {0.};
 
   // Function: four-product of two vectors.
-  std::function<double(int, int)> FOUR = [&](int I, int J) {
+  auto FOUR = [&](int I, int J) {
     return P[3][I - 1] * P[3][J - 1] - P[0][I - 1] * P[0][J - 1] - P[1][I - 1] * P[1][J - 1] -
            P[2][I - 1] * P[2][J - 1];
   };
-  std::function<double(int, int)> DFOUR = [&](int I, int J) {
+  auto DFOUR = [&](int I, int J) {
     return DP[3][I - 1] * DP[3][J - 1] - DP[0][I - 1] * DP[0][J - 1] - DP[1][I - 1] * DP[1][J - 1] -
            DP[2][I - 1] * DP[2][J - 1];
   };
@@ -4317,8 +4531,8 @@ void sophia_interface::LUSTRF(int IP) {
   int NS = 0;
   int NB = 0;
   int ISAV = 0;
-  std::vector<int> LUKFDI_output;
-  std::vector<double> LUPTDI_output;
+  LUKFDI_output lko;
+  LUPTDI_output lpo;
   int MBST = 0;
   double HHBZ = 0.;
 
@@ -4356,7 +4570,7 @@ void sophia_interface::LUSTRF(int IP) {
       repeat110 = true;
       continue;
     }
-    if (N + 5 * NP + 11 > MSTU[3] - MSTU[31] - 5) {
+    if (!LUJETS_reserve(N + 5 * NP + 16)) {
       LUERRM(11, "LUSTRF (2): no more memory left in LUJETS");
       if (MSTU[20] >= 1) return;
     }
@@ -4673,7 +4887,7 @@ label_200:
         do {  // 380
           repeat380 = false;
           I++;
-          if (2 * I - NSAV >= MSTU[3] - MSTU[31] - 5) {
+          if (!LUJETS_reserve(2 * I - NSAV + 6)) {
             LUERRM(11, "LUSTRF (6): no more memory left in LUJETS");
             if (MSTU[20] >= 1) return;
           }
@@ -4687,9 +4901,9 @@ label_200:
           bool repeat390 = false;
           do {  // 390
             repeat390 = false;
-            LUKFDI_output = LUKFDI(KFL[0], 0);
-            KFL[2] = LUKFDI_output[0];
-            K[1][I - 1] = LUKFDI_output[1];
+            lko = LUKFDI(KFL[0], 0);
+            KFL[2] = lko.KFL3;
+            K[1][I - 1] = lko.KF;
             if (K[1][I - 1] == 0) goto label_320;
             if (MSTJ[11] >= 3 && IRANKJ == 1 && std::abs(KFL[0]) <= 10 && std::abs(KFL[2]) > 10) {
               if (RLU() > PARJ[18]) {
@@ -4699,9 +4913,9 @@ label_200:
             }
           } while (repeat390);
           P[4][I - 1] = ULMASS(K[1][I - 1]);
-          LUPTDI_output = LUPTDI(KFL[0]);
-          PX[2] = LUPTDI_output[0];
-          PY[2] = LUPTDI_output[1];
+          lpo = LUPTDI(KFL[0]);
+          PX[2] = lpo.PX;
+          PY[2] = lpo.PY;
           PR[0] = P[4][I - 1] * P[4][I - 1] + (PX[0] + PX[2]) * (PX[0] + PX[2]) +
                   (PY[0] + PY[2]) * (PY[0] + PY[2]);
           Z = LUZDIS(KFL[0], KFL[2], PR[0]);
@@ -5021,9 +5235,9 @@ label_640:  // this is kind-of a do-while loop
     PX[0] = 0.;
     PY[0] = 0.;
     if (NS == 1 && MJU[0] + MJU[1] == 0) {
-      LUPTDI_output = LUPTDI(0);
-      PX[0] = LUPTDI_output[0];
-      PY[0] = LUPTDI_output[1];
+      lpo = LUPTDI(0);
+      PX[0] = lpo.PX;
+      PY[0] = lpo.PY;
     }
     PX[1] = -PX[0];
     PY[1] = -PY[0];
@@ -5039,8 +5253,8 @@ label_640:  // this is kind-of a do-while loop
   } else {
     KFL[2] =
         static_cast<int>(1. + (2. + PARJ[1]) * RLU()) * std::pow(-1, static_cast<int>(RLU() + 0.5));
-    LUKFDI_output = LUKFDI(KFL[2], 0);
-    KFL[0] = LUKFDI_output[0];
+    lko = LUKFDI(KFL[2], 0);
+    KFL[0] = lko.KFL3;
     KFL[1] = -KFL[0];
     if (std::abs(KFL[0]) > 10 && RLU() > 0.5) {
       int sgn = (KFL[0] < 0) ? -1 : 1;
@@ -5049,9 +5263,9 @@ label_640:  // this is kind-of a do-while loop
       int sgn = (KFL[1] < 0) ? -1 : 1;
       KFL[0] = -(KFL[1] + 10000 * sgn);
     }
-    std::vector<double> LUPTDI_output = LUPTDI(KFL[0]);
-    PX[0] = LUPTDI_output[0];
-    PY[0] = LUPTDI_output[1];
+    LUPTDI_output lpo = LUPTDI(KFL[0]);
+    PX[0] = lpo.PX;
+    PY[0] = lpo.PY;
     PX[1] = -PX[0];
     PY[1] = -PY[0];
     double PR3 = std::min(25., 0.1 * P[4][N + NR] * P[4][N + NR]);
@@ -5129,7 +5343,7 @@ label_640:  // this is kind-of a do-while loop
   // Produce new particle: side, origin.
   do {  // 780
     I++;
-    if (2 * I - NSAV >= MSTU[3] - MSTU[31] - 5) {
+    if (!LUJETS_reserve(2 * I - NSAV + 6)) {
       LUERRM(11, "LUSTRF in loop 780: no more memory left in LUJETS");
       if (MSTU[20] >= 1) return;
     }
@@ -5147,17 +5361,17 @@ label_640:  // this is kind-of a do-while loop
 
     // Generate flavour, hadron and pT.
     do {  // 790
-      std::vector<int> LUKFDI_output = LUKFDI(KFL[JT - 1], 0);
-      KFL[2] = LUKFDI_output[0];
-      K[1][I - 1] = LUKFDI_output[1];
+      LUKFDI_output lko = LUKFDI(KFL[JT - 1], 0);
+      KFL[2] = lko.KFL3;
+      K[1][I - 1] = lko.KF;
       if (K[1][I - 1] == 0) goto label_640;
     } while ((MSTJ[11] >= 3 && IRANK[JT - 1] == 1 && std::abs(KFL[JT - 1]) <= 10 &&
               std::abs(KFL[2]) > 10) &&
              RLU() > PARJ[18]);
     P[4][I - 1] = ULMASS(K[1][I - 1]);
-    LUPTDI_output = LUPTDI(KFL[JT - 1]);
-    PX[2] = LUPTDI_output[0];
-    PY[2] = LUPTDI_output[1];
+    lpo = LUPTDI(KFL[JT - 1]);
+    PX[2] = lpo.PX;
+    PY[2] = lpo.PY;
     PR[JT - 1] = P[4][I - 1] * P[4][I - 1] + (PX[JT - 1] + PX[2]) * (PX[JT - 1] + PX[2]) +
                  (PY[JT - 1] + PY[2]) * (PY[JT - 1] + PY[2]);
 
@@ -5383,8 +5597,8 @@ label_640:  // this is kind-of a do-while loop
   K[2][I - 1] = IE[JR - 1];
   K[3][I - 1] = 0;
   K[4][I - 1] = 0;
-  LUKFDI_output = LUKFDI(KFL[JR - 1], -KFL[2]);
-  K[1][I - 1] = LUKFDI_output[1];
+  lko = LUKFDI(KFL[JR - 1], -KFL[2]);
+  K[1][I - 1] = lko.KF;
   if (K[1][I - 1] == 0) goto label_640;
   P[4][I - 1] = ULMASS(K[1][I - 1]);
   PR[JR - 1] = P[4][I - 1] * P[4][I - 1] + (PX[JR - 1] - PX[2]) * (PX[JR - 1] - PX[2]) +
@@ -5459,16 +5673,16 @@ label_640:  // this is kind-of a do-while loop
   K[4][NSAV - 1] = N;
   for (int J = 0; J < 4; ++J) {
     P[J][NSAV - 1] = DPS[J];
-    V[J][NSAV - 1] = V[J][IP - 1];
+    if (trackVertices) V[J][NSAV - 1] = V[J][IP - 1];
   }
   P[4][NSAV - 1] = std::sqrt(
       std::max(0., DPS[3] * DPS[3] - DPS[0] * DPS[0] - DPS[1] * DPS[1] - DPS[2] * DPS[2]));
-  V[4][NSAV - 1] = 0.;
+  if (trackVertices) V[4][NSAV - 1] = 0.;
   for (int Ii = NSAV; Ii < N; ++Ii) {
     for (int J = 0; J < 5; ++J) {
       K[J][Ii] = K[J][Ii + NRS - 1];
       P[J][Ii] = P[J][Ii + NRS - 1];
-      V[J][Ii] = 0.;
+      if (trackVertices) V[J][Ii] = 0.;
     }
   }
   MSTU91 = MSTU[89];
@@ -5537,12 +5751,365 @@ label_640:  // this is kind-of a do-while loop
       }
     }
   }
-  for (int Ii = NSAV; Ii < N; ++Ii) {
+  if (trackVertices) {
+    for (int Ii = NSAV; Ii < N; ++Ii) {
+      for (int J = 0; J < 4; ++J) {
+        V[J][Ii] = V[J][IP - 1];
+      }
+    }
+  }
+
+  return;
+}
+
+void sophia_interface::LUSTRF_twoParton(int IP) {
+  // Purpose: LUSTRF for the open string of the two light partons IP, IP + 1 (no gluons, no
+  // junctions, no c, b, t). The string has one region only, thus the steps of LUSTRF for
+  // several regions, recombination, junctions and heavy flavours drop out. Same algorithm,
+  // random numbers and operations, but the string vectors are kept in local variables, only
+  // the initial state is prepared once for all tries and the hadrons are written directly
+  // after N, in rank order, without a string entry.
+  double DPS[5] = {0.};
+  double DP[5][5] = {0.};
+  double PPL[2][4] = {{0.}};  // light-like vectors spanning the string: + and - end
+  double PTR[2][4] = {{0.}};  // transverse directions
+  double PSUM[4] = {0.};
+  double PREM[4] = {0.};  // four-momentum left in the string
+  double XREM[2] = {0.};  // light-cone fractions left in the string, + and - side
+  double XTAKE[2] = {0.};
+  int KFL[3] = {0};
+  double PMQ[3] = {0.};
+  double PX[3] = {0.};
+  double PY[3] = {0.};
+  double PR[2] = {0.};
+  int IRANK[2] = {0};
+
+  auto FOUR = [](const double A[4], const double B[4]) {
+    return A[3] * B[3] - A[0] * B[0] - A[1] * B[1] - A[2] * B[2];
+  };
+  auto DFOUR = [&](int I, int J) {
+    return DP[3][I - 1] * DP[3][J - 1] - DP[0][I - 1] * DP[0][J - 1] - DP[1][I - 1] * DP[1][J - 1] -
+           DP[2][I - 1] * DP[2][J - 1];
+  };
+
+  // Reset counters. Copy partons after N, as work space for the boost to the CM frame.
+  MSTJ[90] = 0;
+  const int NSAV = N;
+  if (!LUJETS_reserve(N + 2)) {
+    LUERRM(11, "LUSTRF_twoParton: no more memory left in LUJETS");
+    return;
+  }
+  for (int I = IP; I < IP + 2; ++I) {
+    for (int J = 0; J < 5; ++J) {
+      K[J][N + I - IP] = K[J][I - 1];
+      P[J][N + I - IP] = P[J][I - 1];
+      if (J + 1 != 4) DPS[J] += P[J][I - 1];
+    }
+    DPS[3] += std::sqrt(P[0][I - 1] * P[0][I - 1] + P[1][I - 1] * P[1][I - 1] +
+                        P[2][I - 1] * P[2][I - 1] + P[4][I - 1] * P[4][I - 1]);
+  }
+
+  // Boost copied system to CM frame (for better numerical precision).
+  int MBST = 0;
+  double HHBZ = 0.;
+  if (std::abs(DPS[2]) < 0.99 * DPS[3]) {
+    MSTU[32] = 1;
+    LUDBRB(N + 1, N + 2, 0., 0., -DPS[0] / DPS[3], -DPS[1] / DPS[3], -DPS[2] / DPS[3]);
+  } else {
+    MBST = 1;
+    HHBZ = std::sqrt(std::max(1e-6, DPS[3] + DPS[2]) / std::max(1e-6, DPS[3] - DPS[2]));
+    for (int Ii = N; Ii < N + 2; ++Ii) {
+      double HHPMT = P[0][Ii] * P[0][Ii] + P[1][Ii] * P[1][Ii] + P[4][Ii] * P[4][Ii];
+      if (P[2][Ii] > 0.) {
+        double HHPEZ = (P[3][Ii] + P[2][Ii]) / HHBZ;
+        P[2][Ii] = 0.5 * (HHPEZ - HHPMT / HHPEZ);
+        P[3][Ii] = 0.5 * (HHPEZ + HHPMT / HHPEZ);
+      } else {
+        double HHPEZ = (P[3][Ii] - P[2][Ii]) * HHBZ;
+        P[2][Ii] = -0.5 * (HHPEZ - HHPMT / HHPEZ);
+        P[3][Ii] = 0.5 * (HHPEZ + HHPMT / HHPEZ);
+      }
+    }
+  }
+
+  // Find longitudinal string directions (i.e. lightlike four-vectors).
+  for (int J = 0; J < 5; ++J) {
+    DP[J][0] = P[J][N];
+    DP[J][1] = P[J][N + 1];
+  }
+  DP[4][2] = DFOUR(1, 1);
+  DP[4][3] = DFOUR(2, 2);
+  double DHKC = DFOUR(1, 2);
+  if (DP[4][2] + 2. * DHKC + DP[4][3] <= 0.) {
+    DP[4][2] = DP[4][0] * DP[4][0];
+    DP[4][3] = DP[4][1] * DP[4][1];
+    DP[3][0] = std::sqrt(DP[0][0] * DP[0][0] + DP[1][0] * DP[1][0] + DP[2][0] * DP[2][0] +
+                         DP[4][0] * DP[4][0]);
+    DP[3][1] = std::sqrt(DP[0][1] * DP[0][1] + DP[1][1] * DP[1][1] + DP[2][1] * DP[2][1] +
+                         DP[4][1] * DP[4][1]);
+    DHKC = DFOUR(1, 2);
+  }
+  double DHKS = std::sqrt(DHKC * DHKC - DP[4][2] * DP[4][3]);
+  double DHK1 = 0.5 * ((DP[4][3] + DHKC) / DHKS - 1.);
+  double DHK2 = 0.5 * ((DP[4][2] + DHKC) / DHKS - 1.);
+  const double W = std::sqrt(DP[4][2] + 2. * DHKC + DP[4][3]);
+  for (int J = 0; J < 4; ++J) {
+    PPL[0][J] = (1. + DHK1) * DP[J][0] - DHK2 * DP[J][1];
+    PPL[1][J] = (1. + DHK2) * DP[J][1] - DHK1 * DP[J][0];
+  }
+
+  // Sum up energy of the string.
+  for (int J = 0; J < 4; ++J) {
+    PSUM[J] += P[J][N];
+    PSUM[J] += P[J][N + 1];
+  }
+
+  // Find transverse directions (i.e. spacelike four-vectors).
+  for (int J = 0; J < 4; ++J) {
+    DP[J][0] = PPL[0][J];
+    DP[J][1] = PPL[1][J];
+    DP[J][2] = 0.;
+    DP[J][3] = 0.;
+  }
+  DP[3][0] = std::sqrt(DP[0][0] * DP[0][0] + DP[1][0] * DP[1][0] + DP[2][0] * DP[2][0]);
+  DP[3][1] = std::sqrt(DP[0][1] * DP[0][1] + DP[1][1] * DP[1][1] + DP[2][1] * DP[2][1]);
+  DP[0][4] = DP[0][0] / DP[3][0] - DP[0][1] / DP[3][1];
+  DP[1][4] = DP[1][0] / DP[3][0] - DP[1][1] / DP[3][1];
+  DP[2][4] = DP[2][0] / DP[3][0] - DP[2][1] / DP[3][1];
+  if (DP[0][4] * DP[0][4] <= DP[1][4] * DP[1][4] + DP[2][4] * DP[2][4]) DP[0][2] = 1.;
+  if (DP[0][4] * DP[0][4] > DP[1][4] * DP[1][4] + DP[2][4] * DP[2][4]) DP[2][2] = 1.;
+  if (DP[1][4] * DP[1][4] <= DP[0][4] * DP[0][4] + DP[2][4] * DP[2][4]) DP[1][3] = 1.;
+  if (DP[1][4] * DP[1][4] > DP[0][4] * DP[0][4] + DP[2][4] * DP[2][4]) DP[2][3] = 1.;
+  double DHC12 = DFOUR(1, 2);
+  double DHCX1 = DFOUR(3, 1) / DHC12;
+  double DHCX2 = DFOUR(3, 2) / DHC12;
+  double DHCXX = 1. / std::sqrt(1. + 2. * DHCX1 * DHCX2 * DHC12);
+  double DHCY1 = DFOUR(4, 1) / DHC12;
+  double DHCY2 = DFOUR(4, 2) / DHC12;
+  double DHCYX = DHCXX * (DHCX1 * DHCY2 + DHCX2 * DHCY1) * DHC12;
+  double DHCYY = 1. / std::sqrt(1. + 2. * DHCY1 * DHCY2 * DHC12 - DHCYX * DHCYX);
+  for (int J = 0; J < 4; ++J) {
+    DP[J][2] = DHCXX * (DP[J][2] - DHCX2 * DP[J][0] - DHCX1 * DP[J][1]);
+    PTR[0][J] = DP[J][2];
+    PTR[1][J] = DHCYY * (DP[J][3] - DHCY2 * DP[J][0] - DHCY1 * DP[J][1] - DHCYX * DP[J][2]);
+  }
+
+  // As LUSTRF: 99 tries, repeated four times (with looser recombination cuts there)
+  const int maxTries = 5 * 99;
+  int NTRY = 0;
+  int I = NSAV;
+  int JT = 0;
+  int JR = 0;
+  bool repeat640 = false;
+  do {  // 640
+    repeat640 = false;
+    NTRY++;
+    if (NTRY > maxTries) {
+      LUERRM(14, "LUSTRF_twoParton: caught in infinite loop");
+      return;
+    }
+    I = NSAV;
     for (int J = 0; J < 4; ++J) {
-      V[J][Ii] = V[J][IP - 1];
+      PREM[J] = PSUM[J];
     }
+    IRANK[0] = 0;
+    IRANK[1] = 0;
+    XREM[0] = 1.;
+    XREM[1] = 1.;
+
+    // Initialize flavour and pT variables for open string.
+    LUPTDI_output lpo = LUPTDI(0);
+    PX[0] = lpo.PX;
+    PY[0] = lpo.PY;
+    PX[1] = -PX[0];
+    PY[1] = -PY[0];
+    for (int JTi = 1; JTi < 3; ++JTi) {
+      KFL[JTi - 1] = K[1][IP + JTi - 2];
+      MSTJ[92] = 1;
+      PMQ[JTi - 1] = ULMASS(KFL[JTi - 1]);
+    }
+
+    // Produce new particle: side, origin.
+    double WREM2 = 0.;
+    do {  // 780
+      I++;
+      if (!LUJETS_reserve(2 * I - NSAV + 6)) {
+        LUERRM(11, "LUSTRF_twoParton: no more memory left in LUJETS");
+        return;
+      }
+      JT = static_cast<int>(1.5 + RLU());
+      if (std::abs(KFL[2 - JT]) > 10) JT = 3 - JT;
+      JR = 3 - JT;
+      IRANK[JT - 1]++;
+      K[0][I - 1] = 1;
+      K[2][I - 1] = IP + JT - 1;
+      K[3][I - 1] = 0;
+      K[4][I - 1] = 0;
+
+      // Generate flavour, hadron and pT.
+      do {  // 790
+        LUKFDI_output lko = LUKFDI(KFL[JT - 1], 0);
+        KFL[2] = lko.KFL3;
+        K[1][I - 1] = lko.KF;
+        if (K[1][I - 1] == 0) repeat640 = true;
+      } while (!repeat640 &&
+               (MSTJ[11] >= 3 && IRANK[JT - 1] == 1 && std::abs(KFL[JT - 1]) <= 10 &&
+                std::abs(KFL[2]) > 10) &&
+               RLU() > PARJ[18]);
+      if (repeat640) break;
+      P[4][I - 1] = ULMASS(K[1][I - 1]);
+      lpo = LUPTDI(KFL[JT - 1]);
+      PX[2] = lpo.PX;
+      PY[2] = lpo.PY;
+      PR[JT - 1] = P[4][I - 1] * P[4][I - 1] + (PX[JT - 1] + PX[2]) * (PX[JT - 1] + PX[2]) +
+                   (PY[JT - 1] + PY[2]) * (PY[JT - 1] + PY[2]);
+
+      // Final hadrons for small invariant mass.
+      MSTJ[92] = 1;
+      PMQ[2] = ULMASS(KFL[2]);
+      double PARJST = PARJ[32];
+      if (MSTJ[10] == 2) PARJST = PARJ[33];
+      double WMIN = PARJST + PMQ[0] + PMQ[1] + PARJ[35] * PMQ[2];
+      if (std::abs(KFL[JT - 1]) > 10 && std::abs(KFL[2]) > 10) WMIN -= 0.5 * PARJ[35] * PMQ[2];
+      WREM2 = FOUR(PREM, PREM);
+      if (WREM2 < 0.10) {
+        repeat640 = true;
+        break;
+      }
+      if (WREM2 <
+          std::pow(std::max(WMIN * (1. + (2. * RLU() - 1.) * PARJ[36]), PARJ[31] + PMQ[0] + PMQ[1]),
+                   2)) {
+        break;  // final two hadrons
+      }
+
+      // Choose z, which gives Gamma. Take z of the light-cone fraction left on the side JT,
+      // mT^2 / W^2 / that on the other side. Beyond the latter LUSTRF would step to the next
+      // string region, a string of two partons has none.
+      double Z = LUZDIS(KFL[JT - 1], KFL[2], PR[JT - 1]);
+      if (!(Z * XREM[0] * XREM[1] * W * W >= PR[JT - 1])) {
+        repeat640 = true;
+        break;
+      }
+      XTAKE[JT - 1] = Z * XREM[JT - 1];
+      XTAKE[JR - 1] = PR[JT - 1] / (XTAKE[JT - 1] * W * W);
+
+      // Four-momentum of particle. Remaining quantities. Loop back.
+      for (int J = 0; J < 4; ++J) {
+        P[J][I - 1] = (PX[JT - 1] + PX[2]) * PTR[0][J] + (PY[JT - 1] + PY[2]) * PTR[1][J];
+        P[J][I - 1] += XTAKE[0] * PPL[0][J] + XTAKE[1] * PPL[1][J];
+        PREM[J] -= P[J][I - 1];
+      }
+      if (P[3][I - 1] < P[4][I - 1]) {
+        repeat640 = true;
+        break;
+      }
+      KFL[JT - 1] = -KFL[2];
+      PMQ[JT - 1] = PMQ[2];
+      PX[JT - 1] = -PX[2];
+      PY[JT - 1] = -PY[2];
+      XREM[0] -= XTAKE[0];
+      XREM[1] -= XTAKE[1];
+    } while (true);  // 780, left for the final two hadrons or a new try
+    if (repeat640) continue;
+
+    // Final hadron: side, flavour, hadron, mass.
+    I++;
+    K[0][I - 1] = 1;
+    K[2][I - 1] = IP + JR - 1;
+    K[3][I - 1] = 0;
+    K[4][I - 1] = 0;
+    LUKFDI_output lko = LUKFDI(KFL[JR - 1], -KFL[2]);
+    K[1][I - 1] = lko.KF;
+    if (K[1][I - 1] == 0) {
+      repeat640 = true;
+      continue;
+    }
+    P[4][I - 1] = ULMASS(K[1][I - 1]);
+    PR[JR - 1] = P[4][I - 1] * P[4][I - 1] + (PX[JR - 1] - PX[2]) * (PX[JR - 1] - PX[2]) +
+                 (PY[JR - 1] - PY[2]) * (PY[JR - 1] - PY[2]);
+
+    // Final two hadrons: find common setup of four-vectors.
+    DHC12 = FOUR(PPL[0], PPL[1]);
+    double DHR1 = FOUR(PREM, PPL[1]) / DHC12;
+    double DHR2 = FOUR(PREM, PPL[0]) / DHC12;
+
+    // Solve kinematics for final two hadrons, if possible.
+    WREM2 += (PX[0] + PX[1]) * (PX[0] + PX[1]) + (PY[0] + PY[1]) * (PY[0] + PY[1]);
+    double FD = (std::sqrt(PR[0]) + std::sqrt(PR[1])) / std::sqrt(WREM2);
+    if (FD >= 1.) {
+      repeat640 = true;
+      continue;
+    }
+    double FA = WREM2 + PR[JT - 1] - PR[JR - 1];
+    double PREV = 0.;
+    if (MSTJ[10] != 2)
+      PREV = 0.5 * std::exp(
+                       std::max(-50., std::log(FD) * PARJ[37] * (PR[0] + PR[1]) * (PR[0] + PR[1])));
+    if (MSTJ[10] == 2) PREV = 0.5 * std::pow(FD, PARJ[38]);
+    const int JS = 3 - 2 * JT;
+    int sgn = (JS * (RLU() - PREV) < 0) ? -1 : 1;
+    double FB = sgn * (std::sqrt(std::max(0., FA * FA - 4. * WREM2 * PR[JT - 1])));
+    for (int J = 0; J < 4; ++J) {
+      P[J][I - 2] = (PX[JT - 1] + PX[2]) * PTR[0][J] + (PY[JT - 1] + PY[2]) * PTR[1][J] +
+                    0.5 * (DHR1 * (FA + FB) * PPL[0][J] + DHR2 * (FA - FB) * PPL[1][J]) / WREM2;
+      P[J][I - 1] = PREM[J] - P[J][I - 2];
+    }
+    if (P[3][I - 2] < P[4][I - 2] || P[3][I - 1] < P[4][I - 1]) repeat640 = true;
+  } while (repeat640);  // 640
+
+  // Mark jets as fragmented and give daughter pointers.
+  N = I;
+  for (int IM = IP; IM < IP + 2; ++IM) {
+    K[0][IM - 1] += 10;
+    K[3][IM - 1] = NSAV + 1;
+    K[4][IM - 1] = N;
+  }
+
+  // Order particles in rank along the chain: those of the + side as produced, then those of the
+  // - side in reverse.
+  const int NH = N - NSAV;
+  for (int Ii = NSAV; Ii < N; ++Ii) {
+    for (int J = 0; J < 5; ++J) {
+      K[J][Ii + NH] = K[J][Ii];
+      P[J][Ii + NH] = P[J][Ii];
+    }
+  }
+  int I1 = NSAV;
+  for (int Ii = N; Ii < N + NH; ++Ii) {
+    if (K[2][Ii] != IP) continue;
+    for (int J = 0; J < 5; ++J) {
+      K[J][I1] = K[J][Ii];
+      P[J][I1] = P[J][Ii];
+    }
+    I1++;
+  }
+  for (int Ii = N + NH - 1; Ii >= N; --Ii) {
+    if (K[2][Ii] == IP) continue;
+    for (int J = 0; J < 5; ++J) {
+      K[J][I1] = K[J][Ii];
+      P[J][I1] = P[J][Ii];
+    }
+    I1++;
   }
 
+  // Boost back particle system.
+  if (MBST == 0) {
+    MSTU[32] = 1;
+    LUDBRB(NSAV + 1, N, 0., 0., DPS[0] / DPS[3], DPS[1] / DPS[3], DPS[2] / DPS[3]);
+  } else {
+    for (int Ii = NSAV; Ii < N; ++Ii) {
+      double HHPMT = P[0][Ii] * P[0][Ii] + P[1][Ii] * P[1][Ii] + P[4][Ii] * P[4][Ii];
+      if (P[2][Ii] > 0.) {
+        double HHPEZ = (P[3][Ii] + P[2][Ii]) * HHBZ;
+        P[2][Ii] = 0.5 * (HHPEZ - HHPMT / HHPEZ);
+        P[3][Ii] = 0.5 * (HHPEZ + HHPMT / HHPEZ);
+      } else {
+        double HHPEZ = (P[3][Ii] - P[2][Ii]) / HHBZ;
+        P[2][Ii] = -0.5 * (HHPEZ - HHPMT / HHPEZ);
+        P[3][Ii] = 0.5 * (HHPEZ + HHPMT / HHPEZ);
+      }
+    }
+  }
   return;
 }
 
@@ -5668,9 +6235,9 @@ void sophia_interface::LUINDF(int IP) {
         if (std::abs(K[1][IP1 - 1]) != 21) {
           NSTR = 1;
           KFLO[0] = K[1][IP1 - 1];
-          std::vector<double> LUPTDI_output = LUPTDI(0);
-          PXO[0] = LUPTDI_output[0];
-          PYO[0] = LUPTDI_output[1];
+          LUPTDI_output lpo = LUPTDI(0);
+          PXO[0] = lpo.PX;
+          PYO[0] = lpo.PY;
           WO[0] = WF;
 
           // Initial values for gluon treated like random quark jet.
@@ -5679,9 +6246,9 @@ void sophia_interface::LUINDF(int IP) {
           if (MSTJ[1] == 2) MSTJ[90] = 1;
           KFLO[0] = static_cast<int>(1. + (2. + PARJ[1]) * RLU()) *
                     std::pow(-1, static_cast<int>(RLU() + 0.5));
-          std::vector<double> LUPTDI_output = LUPTDI(0);
-          PXO[0] = LUPTDI_output[0];
-          PYO[0] = LUPTDI_output[1];
+          LUPTDI_output lpo = LUPTDI(0);
+          PXO[0] = lpo.PX;
+          PYO[0] = lpo.PY;
           WO[0] = WF;
 
           // Initial values for gluon treated like quark-antiquark jet pair,
@@ -5692,9 +6259,9 @@ void sophia_interface::LUINDF(int IP) {
           KFLO[0] = static_cast<int>(1. + (2. + PARJ[1]) * RLU()) *
                     std::pow(-1, static_cast<int>(RLU() + 0.5));
           KFLO[1] = -KFLO[0];
-          std::vector<double> LUPTDI_output = LUPTDI(0);
-          PXO[0] = LUPTDI_output[0];
-          PYO[0] = LUPTDI_output[1];
+          LUPTDI_output lpo = LUPTDI(0);
+          PXO[0] = lpo.PX;
+          PYO[0] = lpo.PY;
           PXO[1] = -PXO[0];
           PYO[1] = -PYO[0];
           WO[0] = WF * std::pow(RLU(), 1. / 3.);
@@ -5717,7 +6284,7 @@ void sophia_interface::LUINDF(int IP) {
             // New hadron. Generate flavour and hadron species.
             do {  // 190
               I++;
-              if (I >= MSTU[3] - MSTU[31] - NJET - 5) {
+              if (!LUJETS_reserve(I + NJET + 6)) {
                 LUERRM(11, "(LUINDF:) no more memory left in LUJETS");
                 if (MSTU[20] >= 1) return;
               }
@@ -5731,9 +6298,9 @@ void sophia_interface::LUINDF(int IP) {
               bool repeat200 = false;
               do {  // 200
                 repeat200 = false;
-                std::vector<int> LUKFDI_output = LUKFDI(KFL1, 0);
-                KFL2 = LUKFDI_output[0];
-                K[1][I - 1] = LUKFDI_output[1];
+                LUKFDI_output lko = LUKFDI(KFL1, 0);
+                KFL2 = lko.KFL3;
+                K[1][I - 1] = lko.KF;
                 if (K[2][I - 1] == 0) {
                   break190 = true;
                   break;
@@ -5752,9 +6319,9 @@ void sophia_interface::LUINDF(int IP) {
 
               // Find hadron mass. Generate four-momentum.
               P[4][I - 1] = ULMASS(K[1][I - 1]);
-              std::vector<double> LUPTDI_output = LUPTDI(KFL1);
-              double PX2 = LUPTDI_output[0];
-              double PY2 = LUPTDI_output[1];
+              LUPTDI_output lpo = LUPTDI(KFL1);
+              double PX2 = lpo.PX;
+              double PY2 = lpo.PY;
               P[0][I - 1] = PX1 + PX2;
               P[1][I - 1] = PY1 + PY2;
               double PR =
@@ -5784,8 +6351,10 @@ void sophia_interface::LUINDF(int IP) {
               PX1 = -PX2;
               PY1 = -PY2;
               W *= (1. - Z);
-              for (int J = 0; J < 5; ++J) {
-                V[J][I - 1] = 0.;
+              if (trackVertices) {
+                for (int J = 0; J < 5; ++J) {
+                  V[J][I - 1] = 0.;
+                }
               }
 
               // Check if pL acceptable. Go back for new hadron if enough energy.
@@ -5946,8 +6515,8 @@ void sophia_interface::LUINDF(int IP) {
         } else {
           KFLFC = KFLF[0];
         }
-        std::vector<int> LUKFDI_output = LUKFDI(KFLFC, KFLF[1]);
-        int KF = LUKFDI_output[1];
+        LUKFDI_output lko = LUKFDI(KFLFC, KFLF[1]);
+        int KF = lko.KF;
         if (KF == 0) {
           repeat280 = true;
           continue;
@@ -6120,16 +6689,16 @@ void sophia_interface::LUINDF(int IP) {
   K[4][NSAV - 1] = N - NJET + 1;
   for (int J = 0; J < 4; ++J) {
     P[J][NSAV - 1] = DPS[J];
-    V[J][NSAV - 1] = V[J][IP - 1];
+    if (trackVertices) V[J][NSAV - 1] = V[J][IP - 1];
   }
   P[4][NSAV - 1] = std::sqrt(
       std::max(0., DPS[3] * DPS[3] - DPS[0] * DPS[0] - DPS[1] * DPS[1] - DPS[2] * DPS[2]));
-  V[4][NSAV - 1] = 0.;
+  if (trackVertices) V[4][NSAV - 1] = 0.;
   for (int Ii = NSAV + NJET - 1; Ii < N; ++Ii) {
     for (int J = 0; J < 5; ++J) {
       K[J][Ii - NJET + 1] = K[J][Ii];
       P[J][Ii - NJET + 1] = P[J][Ii];
-      V[J][Ii - NJET + 1] = V[J][Ii];
+      if (trackVertices) V[J][Ii - NJET + 1] = V[J][Ii];
     }
   }
   N += 1 - NJET;
@@ -6139,9 +6708,11 @@ void sophia_interface::LUINDF(int IP) {
 
   // Boost back particle system. Set production vertices.
   if (NJET != 1) LUDBRB(NSAV + 1, N, 0., 0., DPS[0] / DPS[3], DPS[1] / DPS[3], DPS[2] / DPS[3]);
-  for (int Ii = NSAV; Ii < N; ++Ii) {
-    for (int J = 0; J < 4; ++J) {
-      V[J][Ii] = V[J][IP - 1];
+  if (trackVertices) {
+    for (int Ii = NSAV; Ii < N; ++Ii) {
+      for (int J = 0; J < 4; ++J) {
+        V[J][Ii] = V[J][IP - 1];
+      }
     }
   }
   return;
@@ -6181,7 +6752,7 @@ void sophia_interface::LUPREP(int IP) {
 
         // Copy undecayed parton.
         if (K[0][IA - 1] == 3) {
-          if (I1 >= MSTU[3] - MSTU[31] - 5) {
+          if (!LUJETS_reserve(I1 + 6)) {
             LUERRM(11, "LUPREP: no more memory left in LUJETS");
             return;
           }
@@ -6194,7 +6765,7 @@ void sophia_interface::LUPREP(int IP) {
           K[4][I1 - 1] = 0;
           for (int J = 0; J < 5; ++J) {
             P[J][I1 - 1] = P[J][IA - 1];
-            V[J][I1 - 1] = V[J][IA - 1];
+            if (trackVertices) V[J][I1 - 1] = V[J][IA - 1];
           }
           K[0][IA - 1] += 10;
           if (K[0][I1 - 1] == 1) {
@@ -6342,11 +6913,11 @@ void sophia_interface::LUPREP(int IP) {
         return;
       }
       do {
-        std::vector<int> LUKFDI_output1 = LUKFDI(K[1][IC1 - 1], 0);
-        KFLN = LUKFDI_output1[0];
-        K[1][N + 1] = LUKFDI_output1[1];
-        std::vector<int> LUKFDI_output2 = LUKFDI(K[1][IC2 - 1], -KFLN);
-        K[1][N + 2] = LUKFDI_output2[1];
+        LUKFDI_output lko1 = LUKFDI(K[1][IC1 - 1], 0);
+        KFLN = lko1.KFL3;
+        K[1][N + 1] = lko1.KF;
+        LUKFDI_output lko2 = LUKFDI(K[1][IC2 - 1], -KFLN);
+        K[1][N + 2] = lko2.KF;
       } while (K[1][N + 1] == 0 || K[1][N + 2] == 0);
     } else {
       if (std::abs(K[1][IC2 - 1]) != 21) {
@@ -6354,13 +6925,13 @@ void sophia_interface::LUPREP(int IP) {
         return;
       }
       do {
-        std::vector<int> LUKFDI_output1 = LUKFDI(1 + static_cast<int>((2. + PARJ[1]) * RLU()), 0);
-        KFLN = LUKFDI_output1[0];
-        std::vector<int> LUKFDI_output2 = LUKFDI(KFLN, 0);
-        int KFLM = LUKFDI_output2[0];
-        K[1][N + 1] = LUKFDI_output2[1];
-        std::vector<int> LUKFDI_output3 = LUKFDI(-KFLN, -KFLM);
-        K[1][N + 2] = LUKFDI_output3[1];
+        LUKFDI_output lko1 = LUKFDI(1 + static_cast<int>((2. + PARJ[1]) * RLU()), 0);
+        KFLN = lko1.KFL3;
+        LUKFDI_output lko2 = LUKFDI(KFLN, 0);
+        int KFLM = lko2.KFL3;
+        K[1][N + 1] = lko2.KF;
+        LUKFDI_output lko3 = LUKFDI(-KFLN, -KFLM);
+        K[1][N + 2] = lko3.KF;
       } while (K[1][N + 1] == 0 || K[1][N + 2] == 0);
     }
     P[4][N + 1] = ULMASS(K[1][N + 1]);
@@ -6417,14 +6988,16 @@ void sophia_interface::LUPREP(int IP) {
         }
       }
 
-      for (int J = 0; J < 4; ++J) {
-        V[J][N] = V[J][IC1 - 1];
-        V[J][N + 1] = V[J][IC1 - 1];
-        V[J][N + 2] = V[J][IC2 - 1];
+      if (trackVertices) {
+        for (int J = 0; J < 4; ++J) {
+          V[J][N] = V[J][IC1 - 1];
+          V[J][N + 1] = V[J][IC1 - 1];
+          V[J][N + 2] = V[J][IC2 - 1];
+        }
+        V[4][N] = 0.;
+        V[4][N + 1] = 0.;
+        V[4][N + 2] = 0.;
       }
-      V[4][N] = 0.;
-      V[4][N + 1] = 0.;
-      V[4][N + 2] = 0.;
       N += 3;
       skipTo300 = true;
       break;
@@ -6439,12 +7012,12 @@ void sophia_interface::LUPREP(int IP) {
           LUPREP_checkFlavour(IP);
           return;
         } else if (std::abs(K[1][IC1 - 1]) != 21) {
-          std::vector<int> LUKFDI_output = LUKFDI(K[1][IC1 - 1], K[1][IC2 - 1]);
-          K[1][N + 1] = LUKFDI_output[1];
+          LUKFDI_output lko = LUKFDI(K[1][IC1 - 1], K[1][IC2 - 1]);
+          K[1][N + 1] = lko.KF;
         } else {
           KFLN = 1 + static_cast<int>((2. + PARJ[1]) * RLU());
-          std::vector<int> LUKFDI_output = LUKFDI(KFLN, -KFLN);
-          K[1][N + 1] = LUKFDI_output[1];
+          LUKFDI_output lko = LUKFDI(KFLN, -KFLN);
+          K[1][N + 1] = lko.KF;
         }
       } while (K[1][N + 1] == 0);
       P[4][N + 1] = ULMASS(K[1][N + 1]);
@@ -6488,11 +7061,11 @@ void sophia_interface::LUPREP(int IP) {
         for (int J = 0; J < 4; ++J) {
           P[J][N + 1] = (1. + HK1) * DPC[J] - HK2 * P[J][IR - 1];
           P[J][IR - 1] = (1. + HK2) * P[J][IR - 1] - HK1 * DPC[J];
-          V[J][N] = V[J][IC1 - 1];
-          V[J][N + 1] = V[J][IC1 - 1];
+          if (trackVertices) V[J][N] = V[J][IC1 - 1];
+          if (trackVertices) V[J][N + 1] = V[J][IC1 - 1];
         }
-        V[4][N] = 0.;
-        V[4][N + 1] = 0.;
+        if (trackVertices) V[4][N] = 0.;
+        if (trackVertices) V[4][N + 1] = 0.;
         N += 2;
       } else {
         LUERRM(3, "LUPREP: no match for collapsing cluster");
@@ -6514,7 +7087,7 @@ void sophia_interface::LUPREP(int IP) {
         }
       }
     }
-  } while (N < MSTU[3] - MSTU[31] - 5);  // 140
+  } while (LUJETS_reserve(N + 6));  // 140
   LUPREP_checkFlavour(IP);
   return;
 }
@@ -6697,9 +7270,8 @@ double sophia_interface::LUZDIS(int KFL1, int KFL2, double PR) {
   return Z;
 }
 
-std::vector<double> sophia_interface::LUPTDI(int KFL) {
+LUPTDI_output sophia_interface::LUPTDI(int KFL) {
   // Purpose: to generate transverse momentum according to a Gaussian.
-  // output: vector = (PX, PY)
   // Generate p_T and azimuthal angle, gives p_x and p_y.
   int KFLA = std::abs(KFL);
   double PT = PARJ[20] * std::sqrt(-std::log(std::max(1e-10, RLU())));
@@ -6710,40 +7282,39 @@ std::vector<double> sophia_interface::LUPTDI(int KFL) {
   double PX = PT * std::cos(PHI);
   double PY = PT * std::sin(PHI);
 
-  std::vector<double> output;
-  output.push_back(PX);
-  output.push_back(PY);
+  LUPTDI_output output;
+  output.PX = PX;
+  output.PY = PY;
   return output;
 }
 
-std::vector<int> sophia_interface::LUKFDI(int KFL1, int KFL2) {
+LUKFDI_output sophia_interface::LUKFDI(int KFL1, int KFL2) {
   // Purpose: to generate a new flavour pair and combine off a hadron.
   // Default flavour values. Input consistency checks.
-  // Returns vector (KFL3, KF).
   int KFL3 = 0;
   int KF = 0;
-  std::vector<int> output;
+  LUKFDI_output output;
   int KF1A = std::abs(KFL1);
   int KF2A = std::abs(KFL2);
   if (KF1A == 0) {
-    output.push_back(KFL3);
-    output.push_back(KF);
+    output.KFL3 = KFL3;
+    output.KF = KF;
     return output;
   }
   if (KF2A != 0) {
     if (KF1A <= 10 && KF2A <= 10 && KFL1 * KFL2 > 0) {
-      output.push_back(KFL3);
-      output.push_back(KF);
+      output.KFL3 = KFL3;
+      output.KF = KF;
       return output;
     }
     if (KF1A > 10 && KF2A > 10) {
-      output.push_back(KFL3);
-      output.push_back(KF);
+      output.KFL3 = KFL3;
+      output.KF = KF;
       return output;
     }
     if ((KF1A > 10 || KF2A > 10) && KFL1 * KFL2 < 0) {
-      output.push_back(KFL3);
-      output.push_back(KF);
+      output.KFL3 = KFL3;
+      output.KF = KF;
       return output;
     }
   }
@@ -6837,8 +7408,8 @@ std::vector<int> sophia_interface::LUKFDI(int KFL1, int KFL2) {
           if (KFLDS == 1) WTDQ /= (3. * PAR4M);
           if ((1. + WTDQ) * RLU() > 1.) MBARY = -1;
           if (MBARY == -1 && KF2A != 0) {
-            output.push_back(KFL3);
-            output.push_back(KF);
+            output.KFL3 = KFL3;
+            output.KF = KF;
             return output;
           }
         }
@@ -6897,7 +7468,7 @@ std::vector<int> sophia_interface::LUKFDI(int KFL1, int KFL2) {
           if (KMUL == 0 || KMUL == 3) KFLS = 1;
           if (KMUL == 5) KFLS = 5;
           if (KFLA != KFLB) {
-            KF = (100 * KFLA + 10 * KFLB + KFLS) * KFS * std::pow(-1, KFLA);
+            KF = (100 * KFLA + 10 * KFLB + KFLS) * KFS * (KFLA % 2 == 0 ? 1 : -1);
           } else {
             double RMIX = RLU();
             int IMIX = 2 * KFLA + 10 * KMUL;
@@ -7001,8 +7572,8 @@ std::vector<int> sophia_interface::LUKFDI(int KFL1, int KFL2) {
           }
         }
 
-        output.push_back(KFL3);
-        output.push_back(KF);
+        output.KFL3 = KFL3;
+        output.KF = KF;
         return output;
       } while (repeat110);
     }  // end skip condition
@@ -7077,7 +7648,7 @@ std::vector<int> sophia_interface::LUKFDI(int KFL1, int KFL2) {
       KFLB = std::min(KTAB1, KTAB3);
       KFS = (KFL1 < 0) ? -1 : 1;
       if (KFLA != KF1A) KFS = -KFS;
-      KF = (100 * KFLA + 10 * KFLB + 2 * KTABS + 1) * KFS * std::pow(-1, KFLA);
+      KF = (100 * KFLA + 10 * KFLB + 2 * KTABS + 1) * KFS * (KFLA % 2 == 0 ? 1 : -1);
     } else if (KTAB1 >= 7 && KTAB3 >= 7) {
       KFS = (KFL1 < 0) ? -1 : 1;
       if (KFL1A == KFL3A) {
@@ -7100,7 +7671,7 @@ std::vector<int> sophia_interface::LUKFDI(int KFL1, int KFL2) {
         repeat100 = true;
         continue;
       }
-      KF = (100 * KFLA + 10 * KFLB + 2 * KTABS + 1) * KFS * std::pow(-1, KFLA);
+      KF = (100 * KFLA + 10 * KFLB + 2 * KTABS + 1) * KFS * (KFLA % 2 == 0 ? 1 : -1);
 
       // Reconstruct baryon code.
     } else {
@@ -7136,8 +7707,8 @@ std::vector<int> sophia_interface::LUKFDI(int KFL1, int KFL2) {
     }
   } while (repeat100);
 
-  output.push_back(KFL3);
-  output.push_back(KF);
+  output.KFL3 = KFL3;
+  output.KF = KF;
   return output;
 }
 
@@ -7178,7 +7749,7 @@ void sophia_interface::LUEDIT(int MEDIT) {
       for (int J = 0; J < 5; ++J) {
         K[J][I1 - 1] = K[J][I];
         P[J][I1 - 1] = P[J][I];
-        V[J][I1 - 1] = V[J][I];
+        if (trackVertices) V[J][I1 - 1] = V[J][I];
       }
       K[2][I1 - 1] = 0;
     }
@@ -7257,7 +7828,7 @@ void sophia_interface::LUEDIT(int MEDIT) {
       for (int J = 0; J < 5; ++J) {
         K[J][I1 - 1] = K[J][I];
         P[J][I1 - 1] = P[J][I];
-        V[J][I1 - 1] = V[J][I];
+        if (trackVertices) V[J][I1 - 1] = V[J][I];
       }
       K[2][I1 - 1] = K[2][I1 - 1] % MSTU[4];
       for (int IZ = 0; IZ < MSTU90; ++IZ) {
@@ -7331,15 +7902,16 @@ void sophia_interface::LUEDIT(int MEDIT) {
 
     // Save top entries at bottom of LUJETS common block.
   } else if (MEDIT == 21) {
+    LUJETS_reserve(2 * N + 1 - MSTU[31]);  // the saved entries are replaced
     if (2 * N >= MSTU[3]) {
       LUERRM(11, "(LUEDIT:) no more memory left in LUJETS");
       return;
     }
     for (int I = 0; I < N; ++I) {
       for (int J = 0; J < 5; ++J) {
-        K[J][MSTU[3] - I] = K[J][I];
-        P[J][MSTU[3] - I] = P[J][I];
-        V[J][MSTU[3] - I] = V[J][I];
+        K[J][MSTU[3] - 1 - I] = K[J][I];
+        P[J][MSTU[3] - 1 - I] = P[J][I];
+        if (trackVertices) V[J][MSTU[3] - 1 - I] = V[J][I];
       }
     }
     MSTU[31] = N;
@@ -7348,9 +7920,9 @@ void sophia_interface::LUEDIT(int MEDIT) {
   } else if (MEDIT == 22) {
     for (int I = 0; I < MSTU[31]; ++I) {
       for (int J = 0; J < 5; ++J) {
-        K[J][I] = K[J][MSTU[3] - I];
-        P[J][I] = P[J][MSTU[3] - I];
-        V[J][I] = V[J][MSTU[3] - I];
+        K[J][I] = K[J][MSTU[3] - 1 - I];
+        P[J][I] = P[J][MSTU[3] - 1 - I];
+        if (trackVertices) V[J][I] = V[J][MSTU[3] - 1 - I];
       }
     }
     N = MSTU[31];
@@ -7439,6 +8011,9 @@ void sophia_interface::LUSHOW(int IP1, int IP2, double QMAX) {
   double PHIIIS[2][2];
   int ISII[2];
 
+  // V is work space here, also without vertex tracking.
+  V.grow(MSTU[3], V.getCapacity());
+
   // Initialization of cutoff masses etc.
   if (MSTJ[40] <= 0 || (MSTJ[40] == 1 && QMAX <= PARJ[81]) || QMAX <= std::min(PARJ[81], PARJ[82]))
     return;
@@ -7636,7 +8211,7 @@ void sophia_interface::LUSHOW(int IP1, int IP2, double QMAX) {
 
   // Define imagined single initiator of shower for parton system.
   int NS = N;
-  if (N > MSTU[3] - MSTU[31] - 5) {
+  if (!LUJETS_reserve(N + 5)) {
     LUERRM(11, "(LUSHOW:) no more memory left in LUJETS");
     if (MSTU[20] >= 1) return;
   }
@@ -7691,7 +8266,7 @@ void sophia_interface::LUSHOW(int IP1, int IP2, double QMAX) {
     } else {
       IGM--;
     }
-    if (N + NEP > MSTU[3] - MSTU[31] - 5) {
+    if (!LUJETS_reserve(N + NEP + 5)) {
       LUERRM(11, "(LUSHOW:) no more memory left in LUJETS");
       if (MSTU[21] >= 1) return;
     }
@@ -8614,7 +9189,7 @@ void sophia_interface::LUSHOW(int IP1, int IP2, double QMAX) {
     if (IGM >= 0) K[0][IM - 1] = 14;
     N += NEP;
     NEP = 2;
-    if (N > (MSTU[3] - MSTU[31] - 5)) {
+    if (!LUJETS_reserve(N + 5)) {
       LUERRM(11, "(LUSHOW:) no more memory left in LUJETS");
       if (MSTU[20] >= 1) {
         N = NS;
@@ -8767,7 +9342,7 @@ void sophia_interface::LUBOEI(int NSAV) {
     for (int I = NSAV; I < N; ++I) {
       if (K[2][I] != KFBE[IBE]) continue;
       if (K[0][I] <= 0 || K[0][I] < 10) continue;
-      if (NBE[IBE] >= (MSTU[3] - MSTU[31] - 5)) {
+      if (!LUJETS_reserve(NBE[IBE] + 6)) {
         LUERRM(11, "(LUBOEI:) no more memory left in LUJETS");
         return;
       }
@@ -8956,7 +9531,7 @@ void sophia_interface::LUJOIN(int NJOIN, int IJOIN[]) {
   return;
 }
 
-void sophia_interface::LUERRM(int MERR, std::string CHMESS) {
+void sophia_interface::LUERRM(int MERR, const char* CHMESS) {
   // Purpose: to inform user of errors in program execution.
   // VERY IMPORTANT NOTE: in the original version, all error messages have been set
   // to silently fail!!! This option was set with MSTU[20] = 0. While operating SOPHIA,
@@ -8967,25 +9542,28 @@ void sophia_interface::LUERRM(int MERR, std::string CHMESS) {
     MSTU[26]++;
     MSTU[27] = MERR;
     if (MSTU[24] == 1 && MSTU[26] <= MSTU[25])
-      std::cout << "LUERRM (1): " << MSTU[10] << " " << MERR << " " << MSTU[30] << " " << CHMESS
-                << std::endl;
+      SOPHIA_DIAG(diagnostics, sophia_diagnostics::warning, sophia_diagnostics::jetsetWarning,
+                  "LUERRM (1): " << MSTU[10] << " " << MERR << " " << MSTU[30] << " " << CHMESS);
 
     // Write first few errors, then be silent or stop program.
   } else if (MERR <= 20) {
     MSTU[22]++;
     MSTU[23] = MERR - 10;
     if (MSTU[20] >= 1 && MSTU[22] <= MSTU[21])
-      std::cout << "LUERRM (2): " << MSTU[10] << " " << MERR - 10 << " " << MSTU[30] << " "
-                << CHMESS << std::endl;
+      SOPHIA_DIAG(diagnostics, sophia_diagnostics::error, sophia_diagnostics::jetsetError,
+                  "LUERRM (2): " << MSTU[10] << " " << MERR - 10 << " " << MSTU[30] << " "
+                                 << CHMESS);
     if (MSTU[20] >= 2 && MSTU[22] > MSTU[21]) {
-      std::cout << "LUERRM (3): " << MSTU[10] << " " << MERR - 10 << " " << MSTU[30] << " "
-                << CHMESS << std::endl;
+      SOPHIA_DIAG(diagnostics, sophia_diagnostics::error, sophia_diagnostics::jetsetError,
+                  "LUERRM (3): " << MSTU[10] << " " << MERR - 10 << " " << MSTU[30] << " "
+                                 << CHMESS);
       throw std::runtime_error("LUERRM: critical error; shutting down.");
     }
 
     // Stop program in case of irreparable error.
   } else {
-    std::cout << MSTU[10] << " " << MERR - 20 << " " << MSTU[30] << " " << CHMESS << std::endl;
+    SOPHIA_DIAG(diagnostics, sophia_diagnostics::error, sophia_diagnostics::jetsetError,
+                MSTU[10] << " " << MERR - 20 << " " << MSTU[30] << " " << CHMESS);
     throw std::runtime_error("LUERRM: irreparable error.");
   }
 
@@ -8997,14 +9575,12 @@ void sophia_interface::LUDBRB(int IMIN, int IMAX, double THE, double PHI, double
   double ROT[3][3] = {0.};
   double PR[3] = {0.};
   double VR[3] = {0.};
-  double DP[3] = {0.};
-  double DV[4] = {0.};
   if (!skip) {
     if (IMIN <= 0) IMIN = 1;
     if (IMAX <= 0) IMAX = N;
 
     // Optional resetting of V (when not set before.)
-    if (MSTU[32] != 0) {
+    if (MSTU[32] != 0 && trackVertices) {
       for (int I = std::min(IMIN, MSTU[3]); I < std::min(IMAX, MSTU[3]) + 1; ++I) {
         for (int J = 0; J < 5; ++J) {
           V[J][I - 1] = 0.;
@@ -9035,11 +9611,11 @@ void sophia_interface::LUDBRB(int IMIN, int IMAX, double THE, double PHI, double
       if (K[0][I - 1] <= 0) continue;
       for (int J = 0; J < 3; ++J) {
         PR[J] = P[J][I - 1];
-        VR[J] = V[J][I - 1];
+        if (trackVertices) VR[J] = V[J][I - 1];
       }
       for (int J = 0; J < 3; ++J) {
         P[J][I - 1] = ROT[0][J] * PR[0] + ROT[1][J] * PR[1] + ROT[2][J] * PR[2];
-        V[J][I - 1] = ROT[0][J] * VR[0] + ROT[1][J] * VR[1] + ROT[2][J] * VR[2];
+        if (trackVertices) V[J][I - 1] = ROT[0][J] * VR[0] + ROT[1][J] * VR[1] + ROT[2][J] * VR[2];
       }
     }
   }
@@ -9056,25 +9632,11 @@ void sophia_interface::LUDBRB(int IMIN, int IMAX, double THE, double PHI, double
       DB = 0.99999999;
     }
     double DGA = 1. / std::sqrt(1. - DB * DB);
-    for (int I = IMIN; I < IMAX + 1; ++I) {
-      if (K[0][I - 1] <= 0) continue;
-      for (int J = 0; J < 4; ++J) {
-        DP[J] = P[J][I - 1];
-        DV[J] = V[J][I - 1];
-      }
-      double DBP = DBX * DP[0] + DBY * DP[1] + DBZ * DP[2];
-      double DGABP = DGA * (DGA * DBP / (1. + DGA) + DP[3]);
-      P[0][I - 1] = DP[0] + DGABP * DBX;
-      P[1][I - 1] = DP[1] + DGABP * DBY;
-      P[2][I - 1] = DP[2] + DGABP * DBZ;
-      P[3][I - 1] = DGA * (DP[3] + DBP);
-      double DBV = DBX * DV[0] + DBY * DV[1] + DBZ * DV[2];
-      double DGABV = DGA * (DGA * DBV / (1. + DGA) + DV[3]);
-      V[0][I - 1] = DV[0] + DGABV * DBX;
-      V[1][I - 1] = DV[1] + DGABV * DBY;
-      V[2][I - 1] = DV[2] + DGABV * DBZ;
-      V[3][I - 1] = DGA * (DV[3] + DBV);
-    }
+    const int I0 = IMIN - 1;
+    const int NB = IMAX - IMIN + 1;
+    boost(&P[0][I0], &P[1][I0], &P[2][I0], &P[3][I0], NB, DBX, DBY, DBZ, DGA, &K[0][I0]);
+    if (trackVertices)
+      boost(&V[0][I0], &V[1][I0], &V[2][I0], &V[3][I0], NB, DBX, DBY, DBZ, DGA, &K[0][I0]);
   }
   return;
 }
@@ -9223,67 +9785,11 @@ int sophia_interface::KLU(int I, int J) {
   return result;
 }
 
-static int MRLU[6] = {19780503, 0, 0, 97, 33, 0};
-static double RRLU[100] = {0.};
-double sophia_interface::RLU(bool isCalledByRNDM) {
+double sophia_interface::RLU() {
   // Purpose: to generate random numbers uniformly distributed between
   // 0 and 1, excluding the endpoints.
-  // Initialize generation from given seed.
-  if (MRLU[1] == 0) {
-    if (isCalledByRNDM && MRLU[0] == 0) MRLU[0] = 19780503;  // initial seed if called by RNDM
-    int IJ = (MRLU[0] / 30082) % 31329;
-    int KL = MRLU[0] % 30082;
-    int I = (IJ / 177) % 177 + 2;
-    int J = IJ % 177 + 2;
-    int K = (KL / 169) % 178 + 1;
-    int L = KL % 169;
-    for (int II = 1; II < 98; ++II) {
-      double S = 0.;
-      double T = 0.5;
-      for (int JJ = 1; JJ < 25; ++JJ) {
-        int M = ((I * J) % 179 * K) % 179;
-        I = J;
-        J = K;
-        K = M;
-        L = (53 * L + 1) % 169;
-        if ((L * M) % 64 >= 32) S += T;
-        T *= 0.5;
-      }
-      RRLU[II - 1] = S;
-    }
-    double TWOM24 = std::pow(0.5, 24);
-    RRLU[97] = 362436. * TWOM24;
-    RRLU[98] = 7654321. * TWOM24;
-    RRLU[99] = 16777213. * TWOM24;
-    MRLU[1] = 1;
-    MRLU[2] = 0;
-    MRLU[3] = 97;
-    MRLU[4] = 33;
-  }
-
-  // Generate next random number.
-  double RUNI = 0.;  // this is the result of the RNG
-  do {
-    RUNI = RRLU[MRLU[3] - 1] - RRLU[MRLU[4] - 1];
-    if (RUNI < 0.) RUNI++;
-    RRLU[MRLU[3] - 1] = RUNI;
-    MRLU[3]--;
-    if (MRLU[3] == 0) MRLU[3] = 97;
-    MRLU[4]--;
-    if (MRLU[4] == 0) MRLU[4] = 97;
-    RRLU[97] -= RRLU[98];
-    if (RRLU[97] < 0.) RRLU[97] += RRLU[99];
-    RUNI -= RRLU[97];
-    if (RUNI < 0.) RUNI++;
-  } while (RUNI <= 0 || RUNI >= 1.);
-
-  // Update counters. Random number to output.
-  MRLU[2]++;
-  if (MRLU[2] == 1000000000) {
-    MRLU[1]++;
-    MRLU[2] = 0;
-  }
-  return RUNI;
+  // The generator state is owned by this instance, see sophia_random.h.
+  return randomGenerator.RLU();
 }
 
 double sophia_interface::ULMASS(int KF) {
@@ -9292,9 +9798,7 @@ double sophia_interface::ULMASS(int KF) {
   int KFA = std::abs(KF);
   int KC = LUCOMP(KF);
   if (KC == 0) return 0;
-  PARF[105] = PMAS[0][5];
-  PARF[106] = PMAS[0][6];
-  PARF[107] = PMAS[0][7];
+  // PARF[105..107] = PMAS[0][5..7] is set once in the (read-only) data tables.
 
   // Guarantee use of constituent masses for internal checks.
   if ((MSTJ[92] == 1 || MSTJ[92] == 2) && KFA <= 10) {
@@ -9470,12 +9974,15 @@ double sophia_interface::PLU(int I, int J) {
   return result;
 }
 
-int sophia_interface::LUCHGE(int KF) {
+// LUCHGE and LUCOMP as translated from JETSET, memoised by flavourCache below
+static int LUCOMP_direct(int KF);
+
+static int LUCHGE_direct(int KF) {
   // Purpose: to give three times the charge for a particle/parton.
   // Initial values. Simple case of direct readout.
   int result = 0;
   int KFA = std::abs(KF);
-  int KC = LUCOMP(KFA);
+  int KC = LUCOMP_direct(KFA);
   if (KC == 0) {
     // do nothing
   } else if (KFA <= 100 || KC <= 80 || KC > 100) {
@@ -9497,7 +10004,7 @@ int sophia_interface::LUCHGE(int KF) {
   return result * sgn;
 }
 
-int sophia_interface::LUCOMP(int KF) {
+static int LUCOMP_direct(int KF) {
   // Purpose: to compress the standard KF codes for use in mass and decay
   // arrays; also to check whether a given code actually is defined.
   static int KFTAB[25] = {211,  111, 221,  311,  321, 130, 310, 213, 113,   223,   313, 323, 2112,
@@ -9613,55 +10120,36 @@ int sophia_interface::LUCOMP(int KF) {
   return result;
 }
 
-int ID_sophia_to_PDG(int sophiaID) {
-  double id = 0.;
-  switch (sophiaID) {
-    case 13:  // proton
-      id = 1000010010;
-      break;
-    case 14:  // neutron
-      id = 1000000010;
-      break;
-    case -13:  // anti-proton
-      id = -1000010010;
-      break;
-    case -14:  // anti-neutron
-      id = -1000000010;
-      break;
-    case 1:  // photon
-      id = 22;
-      break;
-    case 2:  // positron
-      id = -11;
-      break;
-    case 3:  // electron
-      id = 11;
-      break;
-    case 15:  // nu_e
-      id = 12;
-      break;
-    case 16:  // anti-nu_e
-      id = -12;
-      break;
-    case 17:  // nu_mu
-      id = 14;
-      break;
-    case 18:  // anti-nu_mu
-      id = -14;
-      break;
-    case 6:  // pi0
-      id = 111;
-      break;
-    case 7:  // pi+
-      id = 211;
-      break;
-    case 8:  // -211
-      id = -211;
-      break;
-    default:
-      throw std::runtime_error("ID_sophia_to_PDG: unkown particle ID");
+// KF -> KC and three times the charge for all |KF| < size, i.e. all codes but the few
+// radially excited states, built once at start-up. Both only depend on the constant KCHG.
+namespace {
+struct flavour_cache {
+  static const int size = 10000;
+  int16_t KC[2 * size - 1];
+  int16_t charge[2 * size - 1];
+
+  flavour_cache() {
+    for (int KF = 1 - size; KF < size; ++KF) {
+      KC[KF + size - 1] = LUCOMP_direct(KF);
+      charge[KF + size - 1] = LUCHGE_direct(KF);
+    }
+  }
+};
+const flavour_cache flavourCache;
+}  // namespace
+
+int sophia_interface::LUCHGE(int KF) {
+  if (KF > -flavour_cache::size && KF < flavour_cache::size) {
+    return flavourCache.charge[KF + flavour_cache::size - 1];
+  }
+  return LUCHGE_direct(KF);
+}
+
+int sophia_interface::LUCOMP(int KF) {
+  if (KF > -flavour_cache::size && KF < flavour_cache::size) {
+    return flavourCache.KC[KF + flavour_cache::size - 1];
   }
-  return id;
+  return LUCOMP_direct(KF);
 }
 
 // prototype for qq interactions. This is a separate entry to JETSET
@@ -9687,7 +10175,7 @@ void sophia_interface::LU2ENT(int KF1, int KF2, double PECM) {
     for (int j = 0; j < 5; ++j) {
       K[j][i - 1] = 0;
       P[j][i - 1] = 0.;
-      V[j][i - 1] = 0.;
+      if (trackVertices) V[j][i - 1] = 0.;
     }
   }
 
@@ -0,0 +1,204 @@
+#include "sophia_io.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+static_assert(sizeof(sophiafile_header) == 96, "sophiafile_header: unexpected padding");
+
+static uint64_t blockBytes(const sophiafile_header& header, uint64_t n) {
+  return n * (sizeof(int32_t) + 6 * (header.singlePrecision ? sizeof(float) : sizeof(double)));
+}
+
+// ----------------------------------------------------------------------------
+// sophia_writer
+// ----------------------------------------------------------------------------
+
+sophia_writer::sophia_writer(const std::string& filename, const sophiafile_header& fileHeader)
+    : header(fileHeader) {
+  if (header.blockSize == 0) throw std::runtime_error("sophia_writer: blockSize has to be > 0.");
+  header.version = sophiafile_header().version;
+  header.nEvents = 0;
+  header.nParticles = 0;
+  header.indexOffset = 0;
+  file.open(filename, std::ios::binary | std::ios::trunc);
+  if (!file) throw std::runtime_error("sophia_writer: cannot open " + filename);
+  // placeholder, rewritten by close()
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  isOpen = true;
+
+  eventStart.push_back(0);
+  blockID.reserve(header.blockSize);
+  for (int j = 0; j < 6; ++j) blockP[j].reserve(header.blockSize);
+}
+
+sophia_writer::~sophia_writer() {
+  try {
+    close();
+  } catch (...) {
+    // destructors must not throw; call close() explicitly to see errors
+  }
+}
+
+void sophia_writer::addParticle(int sophiaID, double px, double py, double pz, double E,
+                                double m, double weight) {
+  blockID.push_back(ID_sophia_to_PDG(sophiaID));
+  blockP[0].push_back(px);
+  blockP[1].push_back(py);
+  blockP[2].push_back(pz);
+  blockP[3].push_back(E);
+  blockP[4].push_back(m);
+  blockP[5].push_back(weight);
+  nParticles++;
+  if (blockID.size() == header.blockSize) flushBlock();
+}
+
+void sophia_writer::write(const sophia_interface& SI) {
+  if (!isOpen) throw std::runtime_error("sophia_writer: file already closed.");
+  for (int i = 0; i < SI.np; ++i) {
+    addParticle(SI.LLIST[i], SI.p[0][i], SI.p[1][i], SI.p[2][i], SI.p[3][i], SI.p[4][i],
+                SI.weight[i]);
+  }
+  endEvent();
+}
+
+void sophia_writer::write(const sophiabatch_output& sbo) {
+  if (!isOpen) throw std::runtime_error("sophia_writer: file already closed.");
+  for (int k = 0; k < sbo.nEvents; ++k) {
+    for (int i = sbo.eventStart[k]; i < sbo.eventStart[k + 1]; ++i) {
+      addParticle(sbo.partID[i], sbo.partP[0][i], sbo.partP[1][i], sbo.partP[2][i],
+                  sbo.partP[3][i], sbo.partP[4][i], sbo.partWeight[i]);
+    }
+    endEvent();
+  }
+}
+
+void sophia_writer::flushBlock() {
+  const size_t n = blockID.size();
+  if (n == 0) return;
+  file.write(reinterpret_cast<const char*>(blockID.data()), n * sizeof(int32_t));
+  for (int j = 0; j < 6; ++j) {
+    if (header.singlePrecision) {
+      buffer.assign(blockP[j].begin(), blockP[j].end());
+      file.write(reinterpret_cast<const char*>(buffer.data()), n * sizeof(float));
+    } else {
+      file.write(reinterpret_cast<const char*>(blockP[j].data()), n * sizeof(double));
+    }
+  }
+  if (!file) throw std::runtime_error("sophia_writer: write error.");
+  blockID.clear();
+  for (int j = 0; j < 6; ++j) blockP[j].clear();
+}
+
+void sophia_writer::close() {
+  if (!isOpen) return;
+  isOpen = false;
+  flushBlock();
+
+  header.nEvents = eventStart.size() - 1;
+  header.nParticles = nParticles;
+  header.indexOffset = sizeof(header) + blockBytes(header, nParticles);
+  file.write(reinterpret_cast<const char*>(eventStart.data()),
+             eventStart.size() * sizeof(uint64_t));
+  file.seekp(0);
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file.close();
+  if (file.fail()) throw std::runtime_error("sophia_writer: write error.");
+}
+
+// ----------------------------------------------------------------------------
+// sophia_reader
+// ----------------------------------------------------------------------------
+
+sophia_reader::sophia_reader(const std::string& filename) {
+  file.open(filename, std::ios::binary);
+  if (!file) throw std::runtime_error("sophia_reader: cannot open " + filename);
+  file.read(reinterpret_cast<char*>(&header), sizeof(header));
+  if (!file || std::memcmp(header.magic, sophiafile_header().magic, 8) != 0)
+    throw std::runtime_error("sophia_reader: " + filename + " is no SOPHIA event file.");
+  if (header.version != sophiafile_header().version)
+    throw std::runtime_error("sophia_reader: unsupported file version.");
+  if (header.indexOffset == 0)
+    throw std::runtime_error("sophia_reader: file has not been closed properly.");
+
+  eventStart.resize(header.nEvents + 1);
+  file.seekg(header.indexOffset);
+  file.read(reinterpret_cast<char*>(eventStart.data()), eventStart.size() * sizeof(uint64_t));
+  if (!file) throw std::runtime_error("sophia_reader: cannot read the event index.");
+}
+
+int sophia_reader::getNout(long long event) const {
+  return static_cast<int>(eventStart.at(event + 1) - eventStart.at(event));
+}
+
+void sophia_reader::loadBlock(uint64_t block) {
+  if (block == loadedBlock) return;
+  const uint64_t first = block * header.blockSize;
+  const size_t n = std::min<uint64_t>(header.blockSize, header.nParticles - first);
+  file.seekg(sizeof(header) + blockBytes(header, first));
+  blockID.resize(n);
+  file.read(reinterpret_cast<char*>(blockID.data()), n * sizeof(int32_t));
+  for (int j = 0; j < 6; ++j) {
+    blockP[j].resize(n);
+    if (header.singlePrecision) {
+      buffer.resize(n);
+      file.read(reinterpret_cast<char*>(buffer.data()), n * sizeof(float));
+      std::copy(buffer.begin(), buffer.end(), blockP[j].begin());
+    } else {
+      file.read(reinterpret_cast<char*>(blockP[j].data()), n * sizeof(double));
+    }
+  }
+  if (!file) throw std::runtime_error("sophia_reader: read error.");
+  loadedBlock = block;
+}
+
+void sophia_reader::locate(long long event, int i, uint64_t& block, uint64_t& index) {
+  if (i < 0 || i >= getNout(event)) throw std::runtime_error("sophia_reader: no such particle.");
+  const uint64_t particle = eventStart[event] + i;
+  block = particle / header.blockSize;
+  index = particle % header.blockSize;
+  loadBlock(block);
+}
+
+int sophia_reader::getPdgID(long long event, int i) {
+  uint64_t block, index;
+  locate(event, i, block, index);
+  return blockID[index];
+}
+
+double sophia_reader::getPartP(long long event, int i, int j) {
+  if (j < 0 || j > 4) throw std::runtime_error("sophia_reader: no such momentum component.");
+  uint64_t block, index;
+  locate(event, i, block, index);
+  return blockP[j][index];
+}
+
+double sophia_reader::getWeight(long long event, int i) {
+  uint64_t block, index;
+  locate(event, i, block, index);
+  return blockP[5][index];
+}
+
+int sophia_reader::readEvent(long long event, sophiaevent_buffer& output) {
+  const int Nout = getNout(event);
+  output.Nout = Nout;
+  output.px.resize(Nout);
+  output.py.resize(Nout);
+  output.pz.resize(Nout);
+  output.E.resize(Nout);
+  output.m.resize(Nout);
+  output.pdgID.resize(Nout);
+  output.weight.resize(Nout);
+  for (int i = 0; i < Nout; ++i) {
+    uint64_t block, index;
+    locate(event, i, block, index);
+    output.pdgID[i] = blockID[index];
+    output.px[i] = blockP[0][index];
+    output.py[i] = blockP[1][index];
+    output.pz[i] = blockP[2][index];
+    output.E[i] = blockP[3][index];
+    output.m[i] = blockP[4][index];
+    output.weight[i] = blockP[5][index];
+  }
+  return Nout;
+}
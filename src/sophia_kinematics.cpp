@@ -0,0 +1,185 @@
+#include "sophia_kinematics.h"
+
+#include <atomic>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define SOPHIA_HAVE_AVX2_KERNELS
+#include <immintrin.h>
+#endif
+
+// ----------------------------------------------------------------------------
+// scalar versions, the reference arithmetic
+// ----------------------------------------------------------------------------
+
+static void rotateBoostScalar(double* __restrict px, double* __restrict py,
+                              double* __restrict pz, double* __restrict E, int n, double CDE,
+                              double SDE, double CFE, double SFE, double GA, double BGX,
+                              double BGY, double BGZ) {
+  const double CC = CDE * CFE;
+  const double SC = SDE * CFE;
+  const double CS = CDE * SFE;
+  const double SS = SDE * SFE;
+  for (int i = 0; i < n; ++i) {
+    // PO_TRANS
+    const double X = CC * px[i] - SFE * py[i] + SC * pz[i];
+    const double Y = CS * px[i] + CFE * py[i] + SS * pz[i];
+    const double Z = -SDE * px[i] + CDE * pz[i];
+    // PO_ALTRA
+    const double EC = E[i];
+    const double EP = X * BGX + Y * BGY + Z * BGZ;
+    const double PE = EP / (GA + 1.) + EC;
+    px[i] = X + BGX * PE;
+    py[i] = Y + BGY * PE;
+    pz[i] = Z + BGZ * PE;
+    E[i] = GA * EC + EP;
+  }
+}
+
+static void boostScalar(double* __restrict px, double* __restrict py, double* __restrict pz,
+                        double* __restrict E, int n, double BX, double BY, double BZ, double GA,
+                        const int* status) {
+  for (int i = 0; i < n; ++i) {
+    if (status && status[i] <= 0) continue;
+    const double BP = BX * px[i] + BY * py[i] + BZ * pz[i];
+    const double GABP = GA * (GA * BP / (1. + GA) + E[i]);
+    px[i] = px[i] + GABP * BX;
+    py[i] = py[i] + GABP * BY;
+    pz[i] = pz[i] + GABP * BZ;
+    E[i] = GA * (E[i] + BP);
+  }
+}
+
+// ----------------------------------------------------------------------------
+// AVX2 versions, 4 particles per step with the operations of the scalar versions
+// ----------------------------------------------------------------------------
+
+#ifdef SOPHIA_HAVE_AVX2_KERNELS
+
+__attribute__((target("avx2"))) static void rotateBoostAVX2(
+    double* px, double* py, double* pz, double* E, int n, double CDE, double SDE, double CFE,
+    double SFE, double GA, double BGX, double BGY, double BGZ) {
+  const __m256d CC = _mm256_set1_pd(CDE * CFE);
+  const __m256d SC = _mm256_set1_pd(SDE * CFE);
+  const __m256d CS = _mm256_set1_pd(CDE * SFE);
+  const __m256d SS = _mm256_set1_pd(SDE * SFE);
+  const __m256d vSFE = _mm256_set1_pd(SFE);
+  const __m256d vCFE = _mm256_set1_pd(CFE);
+  const __m256d vMSDE = _mm256_set1_pd(-SDE);
+  const __m256d vCDE = _mm256_set1_pd(CDE);
+  const __m256d vGA = _mm256_set1_pd(GA);
+  const __m256d vGA1 = _mm256_set1_pd(GA + 1.);
+  const __m256d vBGX = _mm256_set1_pd(BGX);
+  const __m256d vBGY = _mm256_set1_pd(BGY);
+  const __m256d vBGZ = _mm256_set1_pd(BGZ);
+  int i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m256d x = _mm256_loadu_pd(px + i);
+    const __m256d y = _mm256_loadu_pd(py + i);
+    const __m256d z = _mm256_loadu_pd(pz + i);
+    const __m256d EC = _mm256_loadu_pd(E + i);
+    const __m256d X = _mm256_add_pd(_mm256_sub_pd(_mm256_mul_pd(CC, x), _mm256_mul_pd(vSFE, y)),
+                                    _mm256_mul_pd(SC, z));
+    const __m256d Y = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(CS, x), _mm256_mul_pd(vCFE, y)),
+                                    _mm256_mul_pd(SS, z));
+    const __m256d Z = _mm256_add_pd(_mm256_mul_pd(vMSDE, x), _mm256_mul_pd(vCDE, z));
+    const __m256d EP = _mm256_add_pd(
+        _mm256_add_pd(_mm256_mul_pd(X, vBGX), _mm256_mul_pd(Y, vBGY)), _mm256_mul_pd(Z, vBGZ));
+    const __m256d PE = _mm256_add_pd(_mm256_div_pd(EP, vGA1), EC);
+    _mm256_storeu_pd(px + i, _mm256_add_pd(X, _mm256_mul_pd(vBGX, PE)));
+    _mm256_storeu_pd(py + i, _mm256_add_pd(Y, _mm256_mul_pd(vBGY, PE)));
+    _mm256_storeu_pd(pz + i, _mm256_add_pd(Z, _mm256_mul_pd(vBGZ, PE)));
+    _mm256_storeu_pd(E + i, _mm256_add_pd(_mm256_mul_pd(vGA, EC), EP));
+  }
+  // clean upper YMM state before the (SSE) code of the caller: no AVX/SSE transition penalty
+  _mm256_zeroupper();
+  rotateBoostScalar(px + i, py + i, pz + i, E + i, n - i, CDE, SDE, CFE, SFE, GA, BGX, BGY, BGZ);
+}
+
+__attribute__((target("avx2"))) static void boostAVX2(double* px, double* py, double* pz,
+                                                      double* E, int n, double BX, double BY,
+                                                      double BZ, double GA,
+                                                      const int* status) {
+  const __m256d vBX = _mm256_set1_pd(BX);
+  const __m256d vBY = _mm256_set1_pd(BY);
+  const __m256d vBZ = _mm256_set1_pd(BZ);
+  const __m256d vGA = _mm256_set1_pd(GA);
+  const __m256d vGA1 = _mm256_set1_pd(1. + GA);
+  int i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m256d x = _mm256_loadu_pd(px + i);
+    const __m256d y = _mm256_loadu_pd(py + i);
+    const __m256d z = _mm256_loadu_pd(pz + i);
+    const __m256d e = _mm256_loadu_pd(E + i);
+    const __m256d BP = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(vBX, x), _mm256_mul_pd(vBY, y)),
+                                     _mm256_mul_pd(vBZ, z));
+    const __m256d GABP = _mm256_mul_pd(
+        vGA, _mm256_add_pd(_mm256_div_pd(_mm256_mul_pd(vGA, BP), vGA1), e));
+    __m256d xn = _mm256_add_pd(x, _mm256_mul_pd(GABP, vBX));
+    __m256d yn = _mm256_add_pd(y, _mm256_mul_pd(GABP, vBY));
+    __m256d zn = _mm256_add_pd(z, _mm256_mul_pd(GABP, vBZ));
+    __m256d en = _mm256_mul_pd(vGA, _mm256_add_pd(e, BP));
+    if (status) {
+      // keep the particles with status <= 0
+      const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(status + i));
+      const __m256d keep =
+          _mm256_castsi256_pd(_mm256_cvtepi32_epi64(_mm_cmpgt_epi32(s, _mm_setzero_si128())));
+      xn = _mm256_blendv_pd(x, xn, keep);
+      yn = _mm256_blendv_pd(y, yn, keep);
+      zn = _mm256_blendv_pd(z, zn, keep);
+      en = _mm256_blendv_pd(e, en, keep);
+    }
+    _mm256_storeu_pd(px + i, xn);
+    _mm256_storeu_pd(py + i, yn);
+    _mm256_storeu_pd(pz + i, zn);
+    _mm256_storeu_pd(E + i, en);
+  }
+  _mm256_zeroupper();
+  boostScalar(px + i, py + i, pz + i, E + i, n - i, BX, BY, BZ, GA, status ? status + i : nullptr);
+}
+
+static std::atomic<bool> useAVX2(__builtin_cpu_supports("avx2"));
+
+#else
+
+static std::atomic<bool> useAVX2(false);
+
+#endif
+
+// ----------------------------------------------------------------------------
+// dispatch
+// ----------------------------------------------------------------------------
+
+// below this the loop overhead of the AVX2 versions does not pay off
+static const int minAVX2 = 4;
+
+void rotateBoost(double* px, double* py, double* pz, double* E, int n, double CDE, double SDE,
+                 double CFE, double SFE, double GA, double BGX, double BGY, double BGZ) {
+#ifdef SOPHIA_HAVE_AVX2_KERNELS
+  if (n >= minAVX2 && useAVX2.load(std::memory_order_relaxed)) {
+    rotateBoostAVX2(px, py, pz, E, n, CDE, SDE, CFE, SFE, GA, BGX, BGY, BGZ);
+    return;
+  }
+#endif
+  rotateBoostScalar(px, py, pz, E, n, CDE, SDE, CFE, SFE, GA, BGX, BGY, BGZ);
+}
+
+void boost(double* px, double* py, double* pz, double* E, int n, double BX, double BY,
+           double BZ, double GA, const int* status) {
+#ifdef SOPHIA_HAVE_AVX2_KERNELS
+  if (n >= minAVX2 && useAVX2.load(std::memory_order_relaxed)) {
+    boostAVX2(px, py, pz, E, n, BX, BY, BZ, GA, status);
+    return;
+  }
+#endif
+  boostScalar(px, py, pz, E, n, BX, BY, BZ, GA, status);
+}
+
+bool kinematicsUsesAVX2() { return useAVX2; }
+
+void setKinematicsAVX2(bool enable) {
+#ifdef SOPHIA_HAVE_AVX2_KERNELS
+  useAVX2 = enable && __builtin_cpu_supports("avx2");
+#else
+  (void)enable;
+#endif
+}
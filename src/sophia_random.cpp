@@ -0,0 +1,318 @@
+#include "sophia_random.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+const int sophia_random::legacySeed;
+const int sophia_random::maxSeed;
+const int sophia_random::bufferSize;
+const int sophia_random::lanes;
+const int sophia_random::streamBits;
+const unsigned long long sophia_random::maxStreams;
+
+sophia_random::sophia_random(int seed, algorithm_type algorithm) : algorithm(algorithm) {
+  setSeed(seed);
+}
+
+void sophia_random::setAlgorithm(algorithm_type newAlgorithm) {
+  algorithm = newAlgorithm;
+  restart();
+}
+
+static unsigned long long splitmix64(unsigned long long& x) {
+  unsigned long long z = (x += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+void sophia_random::setSeed(int newSeed) {
+  if (newSeed < 0 || newSeed > maxSeed)
+    throw std::runtime_error("sophia_random: seed has to be in [0, 900000000].");
+  seed = newSeed;
+  isSubstream = false;
+  restart();
+}
+
+void sophia_random::restart() {
+  if (algorithm == XOSHIRO256) {
+    // state from splitmix64, as recommended by the xoshiro authors; lanes continue the same
+    // splitmix64 sequence and are thus decorrelated. Substreams start from a 64 bit hash of
+    // (runSeed, stream) rather than from their RANMAR seed.
+    unsigned long long x = static_cast<unsigned long long>(seed);
+    if (isSubstream) {
+      x = substreamKey[0];
+      unsigned long long y = splitmix64(x) ^ substreamKey[1];
+      x = splitmix64(y);
+    }
+    for (int l = 0; l < lanes; ++l) {
+      for (int j = 0; j < 4; ++j) state[j][l] = splitmix64(x);
+    }
+    bufferIndex = bufferSize;  // filled on first use
+    nBlocks = 0;
+    return;
+  }
+
+  if (isSubstream && hasRunState && runStateKey == substreamKey[0]) {
+    // another substream of the same run: skip the initialisation and the run offset
+    std::copy(runRRLU, runRRLU + 100, RRLU);
+    std::copy(runMRLU, runMRLU + 6, MRLU);
+  } else {
+    initRANMAR();
+    if (isSubstream) {
+      jumpToRun();
+      std::copy(RRLU, RRLU + 100, runRRLU);
+      std::copy(MRLU, MRLU + 6, runMRLU);
+      runStateKey = substreamKey[0];
+      hasRunState = true;
+    }
+  }
+  MRLU[1] = 1;
+  MRLU[2] = 0;
+  nRejected = 0;
+  if (isSubstream) jumpToStream();
+}
+
+void sophia_random::initRANMAR() {
+  // Purpose: to initialize the generation from given seed (former first part of RLU).
+  MRLU[0] = seed;
+  int IJ = (MRLU[0] / 30082) % 31329;
+  int KL = MRLU[0] % 30082;
+  int I = (IJ / 177) % 177 + 2;
+  int J = IJ % 177 + 2;
+  int K = (KL / 169) % 178 + 1;
+  int L = KL % 169;
+  for (int II = 1; II < 98; ++II) {
+    double S = 0.;
+    double T = 0.5;
+    for (int JJ = 1; JJ < 25; ++JJ) {
+      int M = ((I * J) % 179 * K) % 179;
+      I = J;
+      J = K;
+      K = M;
+      L = (53 * L + 1) % 169;
+      if ((L * M) % 64 >= 32) S += T;
+      T *= 0.5;
+    }
+    RRLU[II - 1] = S;
+  }
+  double TWOM24 = std::pow(0.5, 24);
+  RRLU[97] = 362436. * TWOM24;
+  RRLU[98] = 7654321. * TWOM24;
+  RRLU[99] = 16777213. * TWOM24;
+  MRLU[1] = 1;
+  MRLU[2] = 0;
+  MRLU[3] = 97;
+  MRLU[4] = 33;
+  MRLU[5] = 0;
+}
+
+void sophia_random::setSubstream(unsigned long long runSeed, unsigned long long stream) {
+  if (algorithm == RANMAR && stream >= maxStreams)
+    throw std::runtime_error("sophia_random: RANMAR substreams have to be below 2^44.");
+  seed = substreamSeed(runSeed, 0);
+  isSubstream = true;
+  substreamKey[0] = runSeed;
+  substreamKey[1] = stream;
+  restart();
+}
+
+unsigned long long sophia_random::hash(unsigned long long a, unsigned long long b) {
+  // splitmix64 finalizer over (a, b): neighbouring arguments give unrelated results
+  unsigned long long z = a * 0x9E3779B97F4A7C15ULL + b;
+  for (int i = 0; i < 2; ++i) {
+    z += 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+  }
+  return z;
+}
+
+int sophia_random::substreamSeed(unsigned long long runSeed, unsigned long long stream) {
+  return static_cast<int>(hash(runSeed, stream) % (static_cast<unsigned long long>(maxSeed) + 1));
+}
+
+static inline unsigned long long rotl(unsigned long long x, int k) {
+  return (x << k) | (x >> (64 - k));
+}
+
+void sophia_random::fillBuffer() {
+  // xoshiro256++, the lanes are independent and vectorise
+  const double twoM52 = 1. / 4503599627370496.;
+  for (int i = 0; i < bufferSize; i += lanes) {
+    for (int l = 0; l < lanes; ++l) {
+      const unsigned long long result = rotl(state[0][l] + state[3][l], 23) + state[0][l];
+      const unsigned long long t = state[1][l] << 17;
+      state[2][l] ^= state[0][l];
+      state[3][l] ^= state[1][l];
+      state[1][l] ^= state[2][l];
+      state[0][l] ^= state[3][l];
+      state[2][l] ^= t;
+      state[3][l] = rotl(state[3][l], 45);
+      // 52 random bits, shifted by half a step: strictly inside (0, 1)
+      buffer[i + l] = (static_cast<double>(result >> 12) + 0.5) * twoM52;
+    }
+  }
+  bufferIndex = 0;
+  nBlocks++;
+}
+
+double sophia_random::RLU_RANMAR() {
+  // Purpose: to generate random numbers uniformly distributed between
+  // 0 and 1, excluding the endpoints.
+  double RUNI = 0.;  // this is the result of the RNG
+  for (;;) {
+    RUNI = RRLU[MRLU[3] - 1] - RRLU[MRLU[4] - 1];
+    if (RUNI < 0.) RUNI++;
+    RRLU[MRLU[3] - 1] = RUNI;
+    MRLU[3]--;
+    if (MRLU[3] == 0) MRLU[3] = 97;
+    MRLU[4]--;
+    if (MRLU[4] == 0) MRLU[4] = 97;
+    RRLU[97] -= RRLU[98];
+    if (RRLU[97] < 0.) RRLU[97] += RRLU[99];
+    RUNI -= RRLU[97];
+    if (RUNI < 0.) RUNI++;
+    if (RUNI > 0. && RUNI < 1.) break;
+    nRejected++;
+  }
+
+  // Update counters. Random number to output.
+  MRLU[2]++;
+  if (MRLU[2] == 1000000000) {
+    MRLU[1]++;
+    MRLU[2] = 0;
+  }
+  return RUNI;
+}
+
+// ----------------------------------------------------------------------------
+// RANMAR skip-ahead
+// ----------------------------------------------------------------------------
+// The lagged Fibonacci part u_t = u_{t-97} - u_{t-33} mod 1 works on multiples of 2^-24, i.e.
+// it is a linear recurrence over the integers mod 2^24 with characteristic polynomial
+// P(x) = x^97 + x^64 - 1. With x^n = sum_i c_i x^i mod P, u_{m+n} = sum_i c_i u_{m+i}.
+
+static const int lag = 97;
+static const uint64_t mask24 = (1u << 24) - 1;
+
+// a * b mod P, coefficients mod 2^24
+static void mulmodP(const uint64_t a[lag], const uint64_t b[lag], uint64_t result[lag]) {
+  uint64_t product[2 * lag - 1] = {0};
+  for (int i = 0; i < lag; ++i) {
+    if (a[i] == 0) continue;
+    for (int j = 0; j < lag; ++j) product[i + j] += a[i] * b[j];  // < 97 * 2^48
+  }
+  for (int d = 2 * lag - 2; d >= lag; --d) {
+    // x^d = x^(d - 97) (1 - x^64)
+    const uint64_t c = product[d] & mask24;
+    product[d - lag] += c;
+    product[d - 33] += (mask24 + 1) - c;
+  }
+  for (int i = 0; i < lag; ++i) result[i] = product[i] & mask24;
+}
+
+// x^(2^k) mod P for k = 0 ... 119 (the LFG period is (2^97 - 1) 2^23), computed once
+static const std::vector<std::array<uint64_t, lag>>& powersOfTwo() {
+  static const std::vector<std::array<uint64_t, lag>> table = [] {
+    std::vector<std::array<uint64_t, lag>> t(120);
+    t[0].fill(0);
+    t[0][1] = 1;
+    for (size_t k = 1; k < t.size(); ++k) mulmodP(t[k - 1].data(), t[k - 1].data(), t[k].data());
+    return t;
+  }();
+  return table;
+}
+
+// power *= x^(bits 2^shift) mod P
+static void mulPowerOfX(uint64_t power[lag], unsigned long long bits, int shift) {
+  const std::vector<std::array<uint64_t, lag>>& table = powersOfTwo();
+  for (int k = 0; bits != 0; ++k, bits >>= 1) {
+    if (bits & 1) mulmodP(power, table[k + shift].data(), power);
+  }
+}
+
+// (a 2^shift) mod m
+static long long mulPowerOfTwoMod(unsigned long long a, int shift, long long m) {
+  long long r = static_cast<long long>(a % static_cast<unsigned long long>(m));
+  for (int k = 0; k < shift; ++k) r = 2 * r % m;
+  return r;
+}
+
+// advance the RANMAR state by n raw steps, given x^n mod P, n mod 97 and n mod cm; the
+// counters are left to the caller
+static void advanceRANMAR(double RRLU[100], int MRLU[6], const uint64_t power[lag],
+                          long long nMod97, long long nModCm) {
+  const double two24 = 16777216.;
+
+  // the last 97 numbers u_m ... u_{m+96} in time order: the next one overwrites the oldest at
+  // RRLU[I - 1], the newest is at RRLU[I], with I = MRLU[3] decreasing
+  uint64_t u[2 * lag - 1];
+  const int I = MRLU[3];
+  for (int i = 0; i < lag; ++i) {
+    u[i] = static_cast<uint64_t>(RRLU[(I - 1 - i + lag) % lag] * two24);
+  }
+  for (int i = lag; i < 2 * lag - 1; ++i) u[i] = (u[i - lag] - u[i - 33]) & mask24;
+
+  const int newI = static_cast<int>((I - 1 + lag - nMod97) % lag) + 1;
+  for (int i = 0; i < lag; ++i) {
+    uint64_t sum = 0;
+    for (int j = 0; j < lag; ++j) sum += power[j] * u[i + j];  // wraps harmlessly mod 2^64
+    RRLU[(newI - 1 - i + lag) % lag] = static_cast<double>(sum & mask24) / two24;
+  }
+  MRLU[3] = newI;
+  MRLU[4] = (newI - 1 + 33) % lag + 1;
+
+  // arithmetic part c_t = c_{t-1} - cd mod cm, in units of 2^-24
+  const long long c = static_cast<long long>(RRLU[97] * two24);
+  const long long cd = static_cast<long long>(RRLU[98] * two24);
+  const long long cm = static_cast<long long>(RRLU[99] * two24);
+  RRLU[97] = static_cast<double>((c - nModCm * cd % cm + cm) % cm) / two24;
+}
+
+void sophia_random::skip(unsigned long long n) {
+  if (algorithm != RANMAR) throw std::runtime_error("sophia_random: skip needs RANMAR.");
+  if (n == 0) return;
+  uint64_t power[lag] = {0};
+  power[0] = 1;
+  mulPowerOfX(power, n, 0);
+  const long long cm = static_cast<long long>(RRLU[99] * 16777216.);
+  advanceRANMAR(RRLU, MRLU, power, static_cast<long long>(n % lag),
+                static_cast<long long>(n % static_cast<unsigned long long>(cm)));
+
+  const long long count = getCount() + static_cast<long long>(n);
+  MRLU[1] = static_cast<int>(count / 1000000000LL) + 1;
+  MRLU[2] = static_cast<int>(count % 1000000000LL);
+}
+
+// Substream "stream" of run "runSeed" starts at the raw step
+//   n = offset 2^88 + stream 2^44 < 2^120
+// of seed substreamSeed(runSeed, 0), with the 32 bit offset from the same hash. Distinct
+// streams of one run are therefore distinct positions in the period. The state at the offset
+// is kept for the next substream of the same run.
+
+void sophia_random::jumpToRun() {
+  const unsigned long long offset = hash(substreamKey[0], 0) >> 32;
+  uint64_t power[lag] = {0};
+  power[0] = 1;
+  mulPowerOfX(power, offset, 2 * streamBits);
+  const long long cm = static_cast<long long>(RRLU[99] * 16777216.);
+  advanceRANMAR(RRLU, MRLU, power, mulPowerOfTwoMod(offset, 2 * streamBits, lag),
+                mulPowerOfTwoMod(offset, 2 * streamBits, cm));
+}
+
+void sophia_random::jumpToStream() {
+  const unsigned long long stream = substreamKey[1];
+  if (stream == 0) return;
+  uint64_t power[lag] = {0};
+  power[0] = 1;
+  mulPowerOfX(power, stream, streamBits);
+  const long long cm = static_cast<long long>(RRLU[99] * 16777216.);
+  advanceRANMAR(RRLU, MRLU, power, mulPowerOfTwoMod(stream, streamBits, lag),
+                mulPowerOfTwoMod(stream, streamBits, cm));
+}
@@ -0,0 +1,305 @@
+#include "sophia_rates.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+#include "sophia_interface.h"
+
+static const double mubarn = 1e-30;                // cm^2
+static const double Mpc = 3.0856775814913673e24;   // cm
+static const double kBoltzmann = 8.617333262e-14;  // GeV / K
+static const double hbarc = 1.973269804e-14;       // GeV cm
+
+// ----------------------------------------------------------------------------
+// photon_field
+// ----------------------------------------------------------------------------
+
+double photon_field::getDensity(double e) const {
+  if (eps.size() < 2 || e < eps.front() || e > eps.back()) return 0.;
+  const size_t i = std::min<size_t>(
+      std::upper_bound(eps.begin(), eps.end(), e) - eps.begin(), eps.size() - 1);
+  const double f = std::log(e / eps[i - 1]) / std::log(eps[i] / eps[i - 1]);
+  return density[i - 1] * std::pow(density[i] / density[i - 1], f);
+}
+
+photon_field photon_field::blackBody(double temperature, int nPoints) {
+  if (temperature <= 0. || nPoints < 2)
+    throw std::runtime_error("photon_field: invalid black body specified.");
+  const double kT = kBoltzmann * temperature;
+  // 1e-4 kT ... 50 kT, the rest contributes < 1e-8 of the photons
+  const double lnLow = std::log(1e-4 * kT);
+  const double step = std::log(5e5) / (nPoints - 1);
+  photon_field field;
+  field.eps.resize(nPoints);
+  field.density.resize(nPoints);
+  for (int i = 0; i < nPoints; ++i) {
+    const double e = std::exp(lnLow + i * step);
+    field.eps[i] = e;
+    field.density[i] = e * e / (M_PI * M_PI * hbarc * hbarc * hbarc) / std::expm1(e / kT);
+  }
+  return field;
+}
+
+// ----------------------------------------------------------------------------
+// interaction_rate
+// ----------------------------------------------------------------------------
+
+interaction_rate::interaction_rate(int L0, int pointsPerDecade, double xMax)
+    : L0(L0), xMax(xMax) {
+  if (L0 != 13 && L0 != 14) throw std::runtime_error("interaction_rate: invalid nucleon ID.");
+  const double inf = std::numeric_limits<double>::infinity();
+  const double sth = 1.1646;  // same threshold as in crossection_analytic
+  const double pm = AM[L0 - 1];
+  xth = (sth - pm * pm) / 2. / pm;
+  while (pm * pm + 2. * pm * xth < sth) xth = std::nextafter(xth, inf);
+  if (pointsPerDecade < 1 || xMax <= xth)
+    throw std::runtime_error("interaction_rate: invalid grid specified.");
+
+  const double lnRange = std::log(xMax / xth);
+  nPoints = std::max(2, static_cast<int>(std::ceil(pointsPerDecade * lnRange / std::log(10.))) + 1);
+  lnXth = std::log(xth);
+  const double step = lnRange / (nPoints - 1);
+  invStep = 1. / step;
+
+  auto f = [L0](double xp) { return xp * sophia_interface::crossection_analytic(xp, 3, L0); };
+  x.resize(nPoints);
+  integrand.resize(nPoints);
+  cumulative.resize(nPoints);
+  for (int i = 0; i < nPoints; ++i) {
+    x[i] = (i == 0) ? xth : (i == nPoints - 1) ? xMax : std::exp(lnXth + i * step);
+    integrand[i] = f(x[i]);
+    cumulative[i] = (i == 0) ? 0. : cumulative[i - 1] + gaussInt(f, x[i - 1], x[i]);
+  }
+}
+
+double interaction_rate::innerIntegral(double xp) const {
+  if (xp <= xth) return 0.;
+  if (xp > xMax) throw std::runtime_error("interaction_rate: eps_prime beyond the table.");
+  const int i =
+      std::min(std::max(static_cast<int>((std::log(xp) - lnXth) * invStep), 0), nPoints - 2);
+  // integrand linear in the cell, see functs_table::locate
+  const double h = x[i + 1] - x[i];
+  const double f0 = integrand[i];
+  const double a = (integrand[i + 1] - f0) / h;
+  const double t = std::min(std::max(xp - x[i], 0.), h);
+  const double area = (f0 + 0.5 * a * h) * h;
+  const double fraction = (area > 0.) ? (f0 + 0.5 * a * t) * t / area : t / h;
+  return cumulative[i] + fraction * (cumulative[i + 1] - cumulative[i]);
+}
+
+// Gauss-Legendre nodes in ln(eps) over the whole photon field with the weights already
+// multiplied by n(eps) / eps, shared by all Lorentz factors. Only the interval containing the
+// threshold eps_th / (2 gamma) needs new nodes.
+namespace {
+struct field_quadrature {
+  static const int nNodes = 16;
+  struct interval {
+    double lnLow, lnHigh;
+    double eps[nNodes];
+    double weight[nNodes];
+  };
+  std::vector<interval> intervals;
+
+  // at most maxStep in ln(eps) per interval, such that the threshold onset is resolved
+  explicit field_quadrature(const photon_field& field, double maxStep = 0.1) {
+    if (field.eps.size() < 2 || field.eps.size() != field.density.size())
+      throw std::runtime_error("interaction_rate: invalid photon field.");
+    for (size_t i = 0; i + 1 < field.eps.size(); ++i) {
+      if (!(field.eps[i] > 0. && field.eps[i + 1] > field.eps[i]))
+        throw std::runtime_error("interaction_rate: photon field energies not ascending.");
+      const double lnLow = std::log(field.eps[i]);
+      const double lnHigh = std::log(field.eps[i + 1]);
+      const int n = std::max(1, static_cast<int>(std::ceil((lnHigh - lnLow) / maxStep)));
+      for (int k = 0; k < n; ++k) {
+        intervals.push_back(nodes(field, lnLow + (lnHigh - lnLow) * k / n,
+                                  lnLow + (lnHigh - lnLow) * (k + 1) / n));
+      }
+    }
+  }
+
+  static interval nodes(const photon_field& field, double lnLow, double lnHigh) {
+    interval in;
+    in.lnLow = lnLow;
+    in.lnHigh = lnHigh;
+    const double XM = 0.5 * (lnHigh + lnLow);
+    const double XR = 0.5 * (lnHigh - lnLow);
+    for (int k = 0; k < 8; ++k) {
+      for (int sign = 0; sign < 2; ++sign) {
+        const double e = std::exp(sign ? XM - XR * X[k] : XM + XR * X[k]);
+        in.eps[2 * k + sign] = e;
+        in.weight[2 * k + sign] = XR * W[k] * field.getDensity(e) / e;
+      }
+    }
+    return in;
+  }
+};
+}  // namespace
+
+// int dln(eps) n(eps) / eps I(2 gamma eps) over one interval, 0 below the threshold
+static double intervalIntegral(const interaction_rate& IR, const field_quadrature::interval& cached,
+                               const photon_field& field, double gamma) {
+  const double lnThreshold = std::log(IR.getXth() / (2. * gamma));
+  if (cached.lnHigh <= lnThreshold) return 0.;
+  const field_quadrature::interval in =
+      (cached.lnLow >= lnThreshold) ? cached
+                                    : field_quadrature::nodes(field, lnThreshold, cached.lnHigh);
+  double sum = 0.;
+  for (int k = 0; k < field_quadrature::nNodes; ++k) {
+    sum += in.weight[k] * IR.innerIntegral(2. * gamma * in.eps[k]);
+  }
+  return sum;
+}
+
+static double rateFromNodes(const interaction_rate& IR, const field_quadrature& quadrature,
+                            const photon_field& field, double gamma) {
+  if (!(gamma > 0.)) throw std::runtime_error("interaction_rate: invalid Lorentz factor.");
+  double sum = 0.;
+  for (const field_quadrature::interval& cached : quadrature.intervals) {
+    sum += intervalIntegral(IR, cached, field, gamma);
+  }
+  return sum / (2. * gamma * gamma) * mubarn;
+}
+
+double interaction_rate::rate(const photon_field& field, double gamma) const {
+  return rateFromNodes(*this, field_quadrature(field), field, gamma);
+}
+
+std::vector<double> interaction_rate::rates(const photon_field& field,
+                                            const std::vector<double>& gamma,
+                                            int nThreads) const {
+  const field_quadrature quadrature(field);
+  const int n = gamma.size();
+  std::vector<double> result(n, 0.);
+  if (nThreads <= 0) nThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  nThreads = std::max(1, std::min(nThreads, n));
+
+  std::atomic<int> next(0);
+  std::vector<std::exception_ptr> errors(nThreads);
+  auto worker = [&](int iThread) {
+    try {
+      for (int i = next++; i < n; i = next++) {
+        result[i] = rateFromNodes(*this, quadrature, field, gamma[i]);
+      }
+    } catch (...) {
+      errors[iThread] = std::current_exception();
+      next = n;
+    }
+  };
+
+  if (nThreads == 1) {
+    worker(0);
+  } else {
+    std::vector<std::thread> pool;
+    for (int t = 0; t < nThreads; ++t) pool.emplace_back(worker, t);
+    for (std::thread& thread : pool) thread.join();
+  }
+  for (std::exception_ptr& error : errors) {
+    if (error) std::rethrow_exception(error);
+  }
+  return result;
+}
+
+// ----------------------------------------------------------------------------
+// photon_field_sampler
+// ----------------------------------------------------------------------------
+
+photon_field_sampler::photon_field_sampler(const photon_field& field, double gammaMin,
+                                           double gammaMax, int pointsPerDecade) {
+  if (!(gammaMin > 0. && gammaMax > gammaMin) || pointsPerDecade < 1)
+    throw std::runtime_error("photon_field_sampler: invalid grid specified.");
+  const double lnRange = std::log(gammaMax / gammaMin);
+  const int nGamma =
+      std::max(2, static_cast<int>(std::ceil(pointsPerDecade * lnRange / std::log(10.))) + 1);
+  lnGammaMin = std::log(gammaMin);
+  const double step = lnRange / (nGamma - 1);
+  invStep = 1. / step;
+  gammaNode.resize(nGamma);
+  for (int i = 0; i < nGamma; ++i) gammaNode[i] = std::exp(lnGammaMin + i * step);
+  gammaNode[0] = gammaMin;
+  gammaNode[nGamma - 1] = gammaMax;
+
+  const field_quadrature quadrature(field, 0.05);
+  const size_t nIntervals = quadrature.intervals.size();
+  for (const field_quadrature::interval& in : quadrature.intervals) {
+    lnLow.push_back(in.lnLow);
+    lnHigh.push_back(in.lnHigh);
+  }
+  for (int L = 0; L < 2; ++L) {
+    const interaction_rate IR(13 + L);
+    xth[L] = IR.getXth();
+    cumulative[L].resize(nGamma * (nIntervals + 1));
+    for (int i = 0; i < nGamma; ++i) {
+      double* C = &cumulative[L][i * (nIntervals + 1)];
+      C[0] = 0.;
+      for (size_t j = 0; j < nIntervals; ++j) {
+        C[j + 1] = C[j] + intervalIntegral(IR, quadrature.intervals[j], field, gammaNode[i]);
+      }
+    }
+  }
+}
+
+double photon_field_sampler::sampleEps(int L0, double gamma, double r1, double r2) const {
+  if (L0 != 13 && L0 != 14) throw std::runtime_error("photon_field_sampler: invalid nucleon ID.");
+  if (!(gamma >= gammaNode.front() && gamma <= gammaNode.back()))
+    throw std::runtime_error("photon_field_sampler: Lorentz factor outside the table.");
+  const int L = L0 - 13;
+  const int nGamma = gammaNode.size();
+  const int nIntervals = lnLow.size();
+  const double u = (std::log(gamma) - lnGammaMin) * invStep;
+  const int i = std::min(std::max(static_cast<int>(u), 0), nGamma - 2);
+  const double f = std::min(std::max(u - i, 0.), 1.);
+
+  // normalised mixture of the cumulatives at the neighbouring grid points
+  const double* A = &cumulative[L][i * (nIntervals + 1)];
+  const double* B = A + nIntervals + 1;
+  const double wA = (A[nIntervals] > 0.) ? (1. - f) / A[nIntervals] : 0.;
+  const double wB = (B[nIntervals] > 0.) ? f / B[nIntervals] : 0.;
+  if (wA + wB <= 0.) {
+    if (B[nIntervals] <= 0.)
+      throw std::runtime_error("photon_field_sampler: no interaction possible.");
+    return sampleEps(L0, gammaNode[i + 1], r1, r2);
+  }
+  // the mixture is truncated at the threshold of gamma itself, below it B may be nonzero
+  const double lnThreshold = std::log(xth[L] / (2. * gamma));
+  int low = std::min<int>(
+      std::upper_bound(lnHigh.begin(), lnHigh.end(), lnThreshold) - lnHigh.begin(),
+      nIntervals - 1);
+  const double cLow = wA * A[low] + wB * B[low];
+  const double target = cLow + r1 * (wA * A[nIntervals] + wB * B[nIntervals] - cLow);
+  int high = nIntervals;
+  while (high - low > 1) {
+    const int mid = (low + high) / 2;
+    if (wA * A[mid] + wB * B[mid] <= target) {
+      low = mid;
+    } else {
+      high = mid;
+    }
+  }
+
+  const double lnEpsHigh = lnHigh[low];
+  const double lnEpsLow = std::min(std::max(lnLow[low], lnThreshold), lnEpsHigh);
+  return std::exp(lnEpsLow + r2 * (lnEpsHigh - lnEpsLow));
+}
+
+void writeRateTable(const std::string& filename, const photon_field& field,
+                    const std::vector<double>& gamma, int nThreads) {
+  const std::vector<double> proton = interaction_rate(13).rates(field, gamma, nThreads);
+  const std::vector<double> neutron = interaction_rate(14).rates(field, gamma, nThreads);
+
+  std::ofstream file(filename);
+  if (!file) throw std::runtime_error("writeRateTable: cannot open " + filename);
+  file << "# photo-pion interaction rates, total cross section of SOPHIA\n"
+       << "# gamma  rate_proton [1/Mpc]  rate_neutron [1/Mpc]\n"
+       << std::scientific << std::setprecision(8);
+  for (size_t i = 0; i < gamma.size(); ++i) {
+    file << gamma[i] << " " << proton[i] * Mpc << " " << neutron[i] * Mpc << "\n";
+  }
+  if (!file) throw std::runtime_error("writeRateTable: write error.");
+}
@@ -0,0 +1,92 @@
+#include "sophia_scan.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+std::vector<interaction_request> scanGrid(const std::vector<double>& Ein,
+                                          const std::vector<double>& eps, bool protons,
+                                          bool neutrons) {
+  std::vector<interaction_request> points;
+  for (int nucleon = 0; nucleon < 2; ++nucleon) {
+    const bool onProton = (nucleon == 0);
+    if (onProton ? !protons : !neutrons) continue;
+    for (const double E : Ein) {
+      for (const double e : eps) points.push_back(interaction_request{onProton, E, e});
+    }
+  }
+  return points;
+}
+
+unsigned long long scanSeed(unsigned long long runSeed, int point) {
+  return sophia_random::hash(runSeed, static_cast<unsigned long long>(point));
+}
+
+std::vector<scan_job> scanJobs(const std::vector<interaction_request>& points,
+                               int nEventsPerPoint, int eventsPerJob, int chunkSize) {
+  if (nEventsPerPoint < 0) throw std::runtime_error("scanJobs: negative number of events.");
+  if (eventsPerJob <= 0 || chunkSize <= 0)
+    throw std::runtime_error("scanJobs: eventsPerJob and chunkSize have to be positive.");
+  eventsPerJob = (eventsPerJob + chunkSize - 1) / chunkSize * chunkSize;
+
+  std::vector<scan_job> jobs;
+  for (size_t k = 0; k < points.size(); ++k) {
+    const double costPerEvent = estimateCost(points[k]);
+    for (int first = 0; first < nEventsPerPoint; first += eventsPerJob) {
+      const int n = std::min(eventsPerJob, nEventsPerPoint - first);
+      jobs.push_back(scan_job{static_cast<int>(k), first, n, n * costPerEvent});
+    }
+  }
+  return jobs;
+}
+
+std::vector<int> assignJobs(const std::vector<scan_job>& jobs, int size) {
+  if (size <= 0) throw std::runtime_error("assignJobs: size has to be positive.");
+  // longest processing time first; ties go to the lower job and rank index
+  std::vector<int> order(jobs.size());
+  for (size_t j = 0; j < order.size(); ++j) order[j] = static_cast<int>(j);
+  std::stable_sort(order.begin(), order.end(),
+                   [&jobs](int a, int b) { return jobs[a].cost > jobs[b].cost; });
+  std::vector<double> load(size, 0.);
+  std::vector<int> rank(jobs.size());
+  for (const int j : order) {
+    const int r = static_cast<int>(std::min_element(load.begin(), load.end()) - load.begin());
+    rank[j] = r;
+    load[r] += jobs[j].cost;
+  }
+  return rank;
+}
+
+sophia_spectra runJob(const std::vector<interaction_request>& points, const scan_job& job,
+                      int nThreads, unsigned long long runSeed, const sophia_spectra& booking,
+                      bool declareChargedPionsStable, const sophia_parameters& parameters,
+                      int chunkSize) {
+  const interaction_request& point = points.at(job.point);
+  return generateSpectra(point.onProton, point.Ein, point.eps, job.nEvents, nThreads,
+                         scanSeed(runSeed, job.point), booking, declareChargedPionsStable,
+                         parameters, chunkSize, job.firstEvent);
+}
+
+std::vector<sophia_spectra> mergeJobs(const std::vector<scan_job>& jobs,
+                                      const std::vector<sophia_spectra>& jobSpectra,
+                                      size_t nPoints) {
+  if (jobSpectra.size() != jobs.size())
+    throw std::runtime_error("mergeJobs: one spectrum per job needed.");
+  if (jobSpectra.empty()) return std::vector<sophia_spectra>(nPoints);
+  sophia_spectra empty(jobSpectra[0]);
+  empty.clear();
+  std::vector<sophia_spectra> spectra(nPoints, empty);
+  for (size_t j = 0; j < jobs.size(); ++j) {
+    const size_t k = static_cast<size_t>(jobs[j].point);
+    if (k >= nPoints) throw std::runtime_error("mergeJobs: job of an unknown point.");
+    spectra[k].merge(jobSpectra[j]);
+  }
+  return spectra;
+}
+
+std::string jobFileName(const std::string& prefix, int job) {
+  return prefix + ".job" + std::to_string(job) + ".txt";
+}
+
+std::string pointFileName(const std::string& prefix, int point) {
+  return prefix + ".point" + std::to_string(point) + ".txt";
+}
@@ -0,0 +1,165 @@
+#include "sophia_spectra.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+const int sophia_spectra::nModes;
+
+sophia_spectra::sophia_spectra(const std::vector<int>& ids, int nBins, double xMin, double xMax)
+    : pdgIDs(ids), nBins(nBins), xMin(xMin), xMax(xMax) {
+  if (nBins <= 0) throw std::runtime_error("sophia_spectra: nBins has to be positive.");
+  if (!(xMin > 0. && xMax > xMin))
+    throw std::runtime_error("sophia_spectra: x range has to be 0 < xMin < xMax.");
+  if (pdgIDs.empty()) {
+    pdgIDs = {22,         -11,        11,          12,          -12, 14,  -14,
+              1000010010, 1000000010, -1000010010, -1000000010, 111, 211, -211};
+  }
+  binsPerLn = nBins / std::log(xMax / xMin);
+
+  for (int id = -particle_table::nParticles; id <= particle_table::nParticles; ++id) {
+    const int n = id + particle_table::nParticles;
+    speciesOfID[n] = -1;
+    if (!isSophiaID(id)) continue;
+    const int pdgID = ID_sophia_to_PDG(id);
+    speciesOfID[n] = species(pdgID);
+  }
+  const size_t size = pdgIDs.size() * nModes * nBins;
+  sum.assign(size, 0.);
+  sum2.assign(size, 0.);
+}
+
+int sophia_spectra::species(int pdgID) const {
+  const auto it = std::find(pdgIDs.begin(), pdgIDs.end(), pdgID);
+  return (it == pdgIDs.end()) ? -1 : static_cast<int>(it - pdgIDs.begin());
+}
+
+void sophia_spectra::fill(const sophia_interface& SI, double Ein) {
+  nEvents++;
+  const int Imode = SI.lastImode;
+  if (Imode < 0 || Imode >= nModes) return;  // no interaction
+  nEventsMode[Imode]++;
+  const double lnXMin = std::log(xMin);
+  for (int i = 0; i < SI.np; ++i) {
+    const int s = speciesOfID[SI.LLIST[i] + particle_table::nParticles];
+    if (s < 0) continue;
+    const double bin = (std::log(SI.p[3][i] / Ein) - lnXMin) * binsPerLn;
+    if (!(bin >= 0. && bin < nBins)) continue;
+    const size_t n = (static_cast<size_t>(s) * nModes + Imode) * nBins + static_cast<int>(bin);
+    const double w = SI.weight[i];
+    sum[n] += w;
+    sum2[n] += w * w;
+  }
+}
+
+void sophia_spectra::merge(const sophia_spectra& other) {
+  if (other.pdgIDs != pdgIDs || other.nBins != nBins || other.xMin != xMin || other.xMax != xMax)
+    throw std::runtime_error("sophia_spectra: merge needs the same booking.");
+  nEvents += other.nEvents;
+  for (int m = 0; m < nModes; ++m) nEventsMode[m] += other.nEventsMode[m];
+  for (size_t n = 0; n < sum.size(); ++n) {
+    sum[n] += other.sum[n];
+    sum2[n] += other.sum2[n];
+  }
+}
+
+void sophia_spectra::clear() {
+  nEvents = 0;
+  std::fill(&nEventsMode[0], &nEventsMode[0] + nModes, 0);
+  std::fill(sum.begin(), sum.end(), 0.);
+  std::fill(sum2.begin(), sum2.end(), 0.);
+}
+
+double sophia_spectra::getEdge(int i) const {
+  return (i == nBins) ? xMax : xMin * std::exp(i / binsPerLn);
+}
+
+static double sumModes(const std::vector<double>& entries, int s, int i, int Imode, int nModes,
+                       int nBins) {
+  if (s < 0) throw std::runtime_error("sophia_spectra: species not booked.");
+  if (i < 0 || i >= nBins) throw std::runtime_error("sophia_spectra: no such bin.");
+  if (Imode >= nModes) throw std::runtime_error("sophia_spectra: no such Imode.");
+  const size_t first = static_cast<size_t>(s) * nModes;
+  if (Imode >= 0) return entries[(first + Imode) * nBins + i];
+  double total = 0.;
+  for (int m = 0; m < nModes; ++m) total += entries[(first + m) * nBins + i];
+  return total;
+}
+
+double sophia_spectra::getSum(int pdgID, int i, int Imode) const {
+  return sumModes(sum, species(pdgID), i, Imode, nModes, nBins);
+}
+
+double sophia_spectra::getSumSquares(int pdgID, int i, int Imode) const {
+  return sumModes(sum2, species(pdgID), i, Imode, nModes, nBins);
+}
+
+void sophia_spectra::write(const std::string& filename) const {
+  std::ofstream file(filename);
+  if (!file) throw std::runtime_error("sophia_spectra: cannot open " + filename);
+  file.precision(17);  // read() restores the sums exactly
+  file << "# x = E / Ein, " << nBins << " log bins in [" << xMin << ", " << xMax << "], "
+       << nEvents << " events, per Imode:";
+  for (int m = 0; m < nModes; ++m) file << ' ' << nEventsMode[m];
+  file << "\n# pdgIDs:";
+  for (const int pdgID : pdgIDs) file << ' ' << pdgID;
+  file << "\n# pdgID Imode xLow xHigh sum sumSquares\n";
+  for (size_t s = 0; s < pdgIDs.size(); ++s) {
+    for (int m = 0; m < nModes; ++m) {
+      for (int i = 0; i < nBins; ++i) {
+        const size_t n = (s * nModes + m) * nBins + i;
+        if (sum[n] == 0.) continue;
+        file << pdgIDs[s] << ' ' << m << ' ' << getEdge(i) << ' ' << getEdge(i + 1) << ' '
+             << sum[n] << ' ' << sum2[n] << '\n';
+      }
+    }
+  }
+  if (!file) throw std::runtime_error("sophia_spectra: cannot write " + filename);
+}
+
+sophia_spectra sophia_spectra::read(const std::string& filename) {
+  std::ifstream file(filename);
+  if (!file) throw std::runtime_error("sophia_spectra: cannot open " + filename);
+  const std::runtime_error invalid("sophia_spectra: invalid file " + filename);
+
+  std::string line, word;
+  int nBins = 0;
+  double xMin = 0., xMax = 0.;
+  long long nEvents = 0;
+  long long nEventsMode[nModes];
+  std::getline(file, line);
+  int length = 0;
+  const char* format = "# x = E / Ein, %d log bins in [%lf, %lf], %lld events, per Imode:%n";
+  if (std::sscanf(line.c_str(), format, &nBins, &xMin, &xMax, &nEvents, &length) != 4 ||
+      length == 0)
+    throw invalid;
+  std::istringstream header(line.substr(length));
+  for (int m = 0; m < nModes; ++m) header >> nEventsMode[m];
+  if (!header) throw invalid;
+
+  std::getline(file, line);
+  std::istringstream pdgLine(line);
+  pdgLine >> word >> word;  // "# pdgIDs:"
+  std::vector<int> pdgIDs;
+  for (int pdgID; pdgLine >> pdgID;) pdgIDs.push_back(pdgID);
+  std::getline(file, line);  // column names
+
+  sophia_spectra spectra(pdgIDs, nBins, xMin, xMax);
+  spectra.nEvents = nEvents;
+  std::copy(&nEventsMode[0], &nEventsMode[0] + nModes, &spectra.nEventsMode[0]);
+  int pdgID, Imode;
+  double xLow, xHigh, sum, sum2;
+  while (file >> pdgID >> Imode >> xLow >> xHigh >> sum >> sum2) {
+    const int s = spectra.species(pdgID);
+    const int i = static_cast<int>(std::lround(std::log(xLow / xMin) * spectra.binsPerLn));
+    if (s < 0 || Imode < 0 || Imode >= nModes || i < 0 || i >= nBins) throw invalid;
+    const size_t n = (static_cast<size_t>(s) * nModes + Imode) * nBins + i;
+    spectra.sum[n] = sum;
+    spectra.sum2[n] = sum2;
+  }
+  if (!file.eof()) throw invalid;
+  return spectra;
+}
@@ -0,0 +1,172 @@
+#include "sophia_yield.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+static_assert(sizeof(yieldfile_header) == 64, "yieldfile_header: unexpected padding");
+
+// energy fractions are taken at this nucleon energy (GeV)
+static const double yieldEin = 1e12;
+
+void yield_table::setGrid() {
+  lnEpsPrimeMin = std::log(header.epsPrimeMin);
+  invStep = (header.nPoints > 1)
+                ? (header.nPoints - 1) / std::log(header.epsPrimeMax / header.epsPrimeMin)
+                : 0.;
+}
+
+yield_table yield_table::build(int L0, bool declareChargedPionsStable, double epsPrimeMin,
+                               double epsPrimeMax, int pointsPerDecade, int eventsPerPoint,
+                               unsigned long long seed, int nThreads) {
+  if (L0 != 13 && L0 != 14) throw std::runtime_error("yield_table: invalid nucleon ID.");
+  if (pointsPerDecade < 1 || eventsPerPoint < 1)
+    throw std::runtime_error("yield_table: invalid grid specified.");
+  const double pm = AM[L0 - 1];
+  const double sth = 1.1646;  // same threshold as in crossection_analytic
+  // slightly above the threshold, where all channels used by eventgen are open
+  epsPrimeMin = std::max(epsPrimeMin, (sth - pm * pm) / 2. / pm * (1. + 1e-3));
+  if (epsPrimeMax <= epsPrimeMin)
+    throw std::runtime_error("yield_table: invalid grid specified.");
+
+  yield_table table;
+  yieldfile_header& header = table.header;
+  header.L0 = L0;
+  header.chargedPionsStable = declareChargedPionsStable;
+  const double nDecades = std::log10(epsPrimeMax / epsPrimeMin);
+  header.nPoints = std::max(2, static_cast<int>(std::ceil(pointsPerDecade * nDecades)) + 1);
+  header.eventsPerPoint = eventsPerPoint;
+  header.epsPrimeMin = epsPrimeMin;
+  header.epsPrimeMax = epsPrimeMax;
+  header.seed = seed;
+  table.setGrid();
+
+  const int nPoints = header.nPoints;
+  if (nThreads <= 0) nThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  nThreads = std::max(1, std::min(nThreads, nPoints));
+
+  // particles of every grid point, merged in order afterwards
+  std::vector<std::vector<int32_t>> pointID(nPoints);
+  std::vector<std::vector<float>> pointX(nPoints);
+  std::vector<std::vector<uint64_t>> pointNout(nPoints);
+  std::atomic<int> nextPoint(0);
+  std::vector<std::exception_ptr> errors(nThreads);
+
+  auto worker = [&](int iThread) {
+    try {
+      std::unique_ptr<sophia_interface> SI(new sophia_interface());
+      for (int i = nextPoint++; i < nPoints; i = nextPoint++) {
+        SI->reset();
+        SI->setSubstream(seed, i);
+        SI->setChargedPionsStable(declareChargedPionsStable);
+        // photon perpendicular to the nucleon, any angle gives the same eps_prime
+        const double epsPrime = (i == nPoints - 1) ? epsPrimeMax : table.getEpsPrime(i);
+        const double s = pm * pm + 2. * pm * epsPrime;
+        const double eps = (s - pm * pm) / 2. / yieldEin;
+        for (int k = 0; k < eventsPerPoint; ++k) {
+          SI->generateEventAt(L0, yieldEin, eps, s);
+          for (int j = 0; j < SI->np; ++j) {
+            pointID[i].push_back(ID_sophia_to_PDG(SI->LLIST[j]));
+            pointX[i].push_back(static_cast<float>(SI->p[3][j] / yieldEin));
+          }
+          pointNout[i].push_back(SI->np);
+        }
+      }
+    } catch (...) {
+      errors[iThread] = std::current_exception();
+      nextPoint = nPoints;  // let the other workers stop early
+    }
+  };
+
+  if (nThreads == 1) {
+    worker(0);
+  } else {
+    std::vector<std::thread> pool;
+    for (int t = 0; t < nThreads; ++t) pool.emplace_back(worker, t);
+    for (std::thread& thread : pool) thread.join();
+  }
+  for (std::exception_ptr& error : errors) {
+    if (error) std::rethrow_exception(error);
+  }
+
+  table.eventStart.reserve(static_cast<size_t>(nPoints) * eventsPerPoint + 1);
+  table.eventStart.push_back(0);
+  for (int i = 0; i < nPoints; ++i) {
+    for (uint64_t Nout : pointNout[i]) {
+      table.eventStart.push_back(table.eventStart.back() + Nout);
+    }
+    table.pdgID.insert(table.pdgID.end(), pointID[i].begin(), pointID[i].end());
+    table.x.insert(table.x.end(), pointX[i].begin(), pointX[i].end());
+  }
+  header.nParticles = table.pdgID.size();
+  return table;
+}
+
+void yield_table::save(const std::string& filename) const {
+  std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+  if (!file) throw std::runtime_error("yield_table: cannot open " + filename);
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char*>(eventStart.data()),
+             eventStart.size() * sizeof(uint64_t));
+  file.write(reinterpret_cast<const char*>(pdgID.data()), pdgID.size() * sizeof(int32_t));
+  file.write(reinterpret_cast<const char*>(x.data()), x.size() * sizeof(float));
+  file.close();
+  if (file.fail()) throw std::runtime_error("yield_table: write error.");
+}
+
+yield_table::yield_table(const std::string& filename) {
+  std::ifstream file(filename, std::ios::binary);
+  if (!file) throw std::runtime_error("yield_table: cannot open " + filename);
+  file.read(reinterpret_cast<char*>(&header), sizeof(header));
+  if (!file || std::memcmp(header.magic, yieldfile_header().magic, 8) != 0)
+    throw std::runtime_error("yield_table: " + filename + " is no SOPHIA yield table.");
+  if (header.version != 1) throw std::runtime_error("yield_table: unsupported file version.");
+  if (header.nPoints < 2 || header.eventsPerPoint < 1)
+    throw std::runtime_error("yield_table: invalid grid in " + filename);
+  setGrid();
+
+  eventStart.resize(static_cast<size_t>(header.nPoints) * header.eventsPerPoint + 1);
+  pdgID.resize(header.nParticles);
+  x.resize(header.nParticles);
+  file.read(reinterpret_cast<char*>(eventStart.data()), eventStart.size() * sizeof(uint64_t));
+  file.read(reinterpret_cast<char*>(pdgID.data()), pdgID.size() * sizeof(int32_t));
+  file.read(reinterpret_cast<char*>(x.data()), x.size() * sizeof(float));
+  if (!file || eventStart.back() != header.nParticles)
+    throw std::runtime_error("yield_table: " + filename + " is truncated.");
+}
+
+int yield_table::sample(double epsPrime, double r1, double r2, yield_event& output) const {
+  if (epsPrime < header.epsPrimeMin || epsPrime > header.epsPrimeMax)
+    throw std::runtime_error("yield_table: eps_prime outside the table.");
+  const int nPoints = header.nPoints;
+  const double u = (std::log(epsPrime) - lnEpsPrimeMin) * invStep;
+  int i = std::min(std::max(static_cast<int>(u), 0), nPoints - 2);
+  if (r1 < u - i) i++;
+
+  const int nEvents = header.eventsPerPoint;
+  const uint64_t event =
+      static_cast<uint64_t>(i) * nEvents + std::min(static_cast<int>(r2 * nEvents), nEvents - 1);
+  const uint64_t first = eventStart[event];
+  const int Nout = static_cast<int>(eventStart[event + 1] - first);
+  output.Nout = Nout;
+  output.pdgID.assign(pdgID.begin() + first, pdgID.begin() + first + Nout);
+  output.x.assign(x.begin() + first, x.begin() + first + Nout);
+  return Nout;
+}
+
+int sampleYield(sophia_interface& SI, const yield_table& table, double Ein, double eps,
+                yield_event& output) {
+  const int L0 = table.getHeader().L0;
+  const double pm = AM[L0 - 1];
+  const double s = SI.sample_s(eps, L0, Ein);
+  const double epsPrime = (s - pm * pm) / 2. / pm;
+  const double r1 = SI.RNDM();
+  const double r2 = SI.RNDM();
+  // the table starts marginally above the threshold
+  return table.sample(std::max(epsPrime, table.getHeader().epsPrimeMin), r1, r2, output);
+}
@@ -0,0 +1,143 @@
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <vector>
+
+#include "sophia_interface.h"
+#include "sophia_yield.h"
+
+// Benchmarks of the event generation and of its hot routines. Build with ENABLE_BENCHMARKS=ON
+// and run e.g. ./benchmarkSophia --benchmark_filter=sophiaevent
+
+// Ein = 1e10 GeV, eps chosen such that sqrt(smax) lies in the resonance region, in the direct
+// channel region and well in the multipion (lund_frag) region
+static const double Ein = 1e10;
+static const double epsRegion[3] = {2e-11, 6e-11, 1e-8};
+static const char* nameRegion[3] = {"resonance", "direct", "multipion"};
+
+// engines are large, keep them off the stack
+static std::unique_ptr<sophia_interface> newEngine() {
+  return std::unique_ptr<sophia_interface>(new sophia_interface());
+}
+
+static void sophiaevent(benchmark::State& state) {
+  const bool onProton = state.range(0) == 0;
+  const int region = state.range(1);
+  const bool stable = state.range(2) != 0;
+  std::unique_ptr<sophia_interface> SI = newEngine();
+  sophiaevent_buffer buffer;
+  int nParticles = 0;
+  for (auto _ : state) {
+    nParticles += SI->sophiaevent(onProton, Ein, epsRegion[region], buffer, stable);
+  }
+  state.SetLabel(std::string(onProton ? "proton " : "neutron ") + nameRegion[region] +
+                 (stable ? " stable pions" : ""));
+  state.counters["particles"] = benchmark::Counter(nParticles, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(sophiaevent)->ArgsProduct({{0, 1}, {0, 1, 2}, {0, 1}});
+
+static void crossection(benchmark::State& state) {
+  const int NDIR = state.range(0);
+  std::unique_ptr<sophia_interface> SI = newEngine();
+  SI->useTabulatedCrossections(state.range(1) != 0);
+  // photon energies over the resonance, direct and multipion regions
+  std::vector<double> x;
+  for (int i = 0; i < 1024; ++i) x.push_back(0.152 * std::pow(1e3, i / 1024.));
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(SI->crossection(x[i], NDIR, 13));
+    i = (i + 1) % x.size();
+  }
+  state.SetLabel(state.range(1) ? "tabulated" : "analytic");
+}
+BENCHMARK(crossection)->ArgsProduct({{1, 3, 11}, {0, 1}});
+
+static void sample_s(benchmark::State& state) {
+  const int region = state.range(0);
+  std::unique_ptr<sophia_interface> SI = newEngine();
+  SI->useTabulatedSampling(state.range(1) != 0);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(SI->sample_s(epsRegion[region], 13, Ein));
+  }
+  state.SetLabel(std::string(nameRegion[region]) + (state.range(1) ? " tabulated" : ""));
+}
+BENCHMARK(sample_s)->ArgsProduct({{0, 1, 2}, {0, 1}});
+
+// quark - diquark string along the z axis, as set up by gamma_h
+static void putString(sophia_interface& SI, double Ecm) {
+  const double ee = Ecm / 2.;
+  SI.lund_put(1, 1, 0., 0., ee, ee);
+  SI.lund_put(2, 12, 0., 0., -ee, ee);
+  int Ijoin[2] = {1, 2};
+  SI.LUJOIN(2, Ijoin);
+}
+
+static void LUEXEC(benchmark::State& state) {
+  const double Ecm = state.range(0);
+  std::unique_ptr<sophia_interface> SI = newEngine();
+  putString(*SI, Ecm);
+  SI->lund_frag(Ecm);  // JETSET settings of SOPHIA
+  for (auto _ : state) {
+    putString(*SI, Ecm);
+    SI->LUEXEC();
+  }
+}
+BENCHMARK(LUEXEC)->Arg(3)->Arg(10)->Arg(30);
+
+static void LUSTRF(benchmark::State& state) {
+  const double Ecm = state.range(0);
+  std::unique_ptr<sophia_interface> SI = newEngine();
+  putString(*SI, Ecm);
+  SI->lund_frag(Ecm);
+  for (auto _ : state) {
+    // includes the string preparation of LUEXEC
+    putString(*SI, Ecm);
+    SI->LUPREP(0);
+    SI->LUSTRF(1);
+  }
+}
+BENCHMARK(LUSTRF)->Arg(3)->Arg(10)->Arg(30);
+
+static void lund_frag(benchmark::State& state) {
+  const double Ecm = state.range(0);
+  std::unique_ptr<sophia_interface> SI = newEngine();
+  SI->useSimpleStrings(state.range(1) != 0);
+  for (auto _ : state) {
+    putString(*SI, Ecm);
+    SI->lund_frag(Ecm);
+  }
+  state.SetLabel(state.range(1) ? "simple strings" : "LUEXEC");
+}
+BENCHMARK(lund_frag)->ArgsProduct({{3, 10, 30}, {0, 1}});
+
+static void DECSIB(benchmark::State& state) {
+  // pi+, pi0, eta, rho0 and omega at rest, decayed down to stable particles
+  const int ids[5] = {7, 6, 23, 27, 32};
+  std::unique_ptr<sophia_interface> SI = newEngine();
+  for (auto _ : state) {
+    SI->np = 5;
+    for (int i = 0; i < 5; ++i) {
+      SI->LLIST[i] = ids[i];
+      SI->p[0][i] = SI->p[1][i] = SI->p[2][i] = 0.;
+      SI->p[3][i] = SI->p[4][i] = AM[ids[i] - 1];
+    }
+    SI->DECSIB();
+  }
+}
+BENCHMARK(DECSIB);
+
+// fast yield mode, to compare with sophiaevent
+static void sampleYield(benchmark::State& state) {
+  const int region = state.range(0);
+  static const yield_table table = yield_table::build(13, false, 0., 1e3, 20, 1000);
+  std::unique_ptr<sophia_interface> SI = newEngine();
+  SI->useTabulatedSampling(true);
+  yield_event event;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(sampleYield(*SI, table, Ein, epsRegion[region], event));
+  }
+  state.SetLabel(nameRegion[region]);
+}
+BENCHMARK(sampleYield)->Arg(0)->Arg(1)->Arg(2);
+
+BENCHMARK_MAIN();
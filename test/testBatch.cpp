@@ -0,0 +1,126 @@
+#include "gtest/gtest.h"
+#include "sophia_batch.h"
+
+TEST(Batch, independentOfThreadCount) {
+  sophiabatch_output serial = generateBatch(true, 1e9, 1e-9, 750, 1, 12345);
+  sophiabatch_output parallel = generateBatch(true, 1e9, 1e-9, 750, 4, 12345);
+
+  ASSERT_EQ(serial.nEvents, 750);
+  ASSERT_EQ(parallel.nEvents, 750);
+  EXPECT_EQ(serial.eventStart, parallel.eventStart);
+  EXPECT_EQ(serial.partID, parallel.partID);
+  for (int j = 0; j < 5; ++j) {
+    EXPECT_EQ(serial.partP[j], parallel.partP[j]);
+  }
+}
+
+TEST(Batch, matchesSingleEngine) {
+  // chunk 0 is generated from substream (seed, 0) by a fresh engine
+  sophiabatch_output sbo = generateBatch(false, 1e9, 1e-9, 20, 2, 7, true);
+  sophia_interface SI;
+  SI.setSubstream(7, 0);
+  for (int k = 0; k < 20; ++k) {
+    sophiaevent_output seo = SI.sophiaevent(false, 1e9, 1e-9, true);
+    ASSERT_EQ(seo.Nout, sbo.getNout(k));
+    for (int i = 0; i < seo.Nout; ++i) {
+      EXPECT_EQ(seo.outPartID[i], sbo.getPartID(k, i));
+      for (int j = 0; j < 5; ++j) {
+        EXPECT_EQ(seo.outPartP[j][i], sbo.getPartP(k, i, j));
+      }
+    }
+  }
+}
+
+TEST(Batch, filtered) {
+  const particle_filter filter({22}, 1e7);
+  sophiabatch_output all = generateBatch(true, 1e10, 1e-8, 300, 2, 3);
+  sophiabatch_output photons = generateBatch(true, 1e10, 1e-8, 300, 2, 3, filter);
+  ASSERT_EQ(photons.nEvents, 300);
+  ASSERT_EQ(photons.eventStart.size(), 301u);
+  for (int k = 0; k < 300; ++k) {
+    int j = 0;
+    for (int i = 0; i < all.getNout(k); ++i) {
+      if (all.getPartID(k, i) != 1 || all.getPartP(k, i, 3) < 1e7) continue;
+      ASSERT_LT(j, photons.getNout(k));
+      EXPECT_EQ(photons.getPartID(k, j), 1);
+      EXPECT_EQ(photons.getPartP(k, j, 3), all.getPartP(k, i, 3));
+      j++;
+    }
+    EXPECT_EQ(j, photons.getNout(k));
+  }
+  EXPECT_GT(photons.partID.size(), 0u);
+  EXPECT_LT(photons.partID.size(), all.partID.size());
+}
+
+// resonance, direct and multipion region for protons and neutrons, mixed
+static std::vector<interaction_request> mixedRequests(int n) {
+  std::vector<interaction_request> requests;
+  const double eps[3] = {1e-10, 5e-10, 1e-8};
+  for (int i = 0; i < n; ++i) requests.push_back({i % 2 == 0, 1e9 * (1 + i % 5), eps[i % 3]});
+  return requests;
+}
+
+TEST(Batch, estimateCost) {
+  const double resonance = estimateCost({true, 1e9, 3e-10});
+  const double multipion = estimateCost({true, 1e10, 1e-8});
+  EXPECT_GE(resonance, 1.);
+  EXPECT_GT(multipion, 2. * resonance);
+  EXPECT_GT(estimateCost({false, 1e11, 1e-8}), multipion);
+}
+
+TEST(Batch, interactionsIndependentOfThreadCount) {
+  const std::vector<interaction_request> requests = mixedRequests(500);
+  sophiabatch_output serial = generateInteractions(requests, 1, 9);
+  sophiabatch_output parallel = generateInteractions(requests, 4, 9);
+  ASSERT_EQ(serial.nEvents, 500);
+  EXPECT_EQ(serial.eventStart, parallel.eventStart);
+  EXPECT_EQ(serial.partID, parallel.partID);
+  for (int j = 0; j < 5; ++j) {
+    EXPECT_EQ(serial.partP[j], parallel.partP[j]);
+  }
+}
+
+TEST(Batch, interactionsInInputOrder) {
+  // a single chunk: the events of one engine on substream (seed, 0)
+  const std::vector<interaction_request> requests = mixedRequests(60);
+  sophiabatch_output sbo =
+      generateInteractions(requests.data(), requests.size(), 3, 4, false, particle_filter(),
+                           sophia_parameters(), 1e9);
+  sophia_interface SI;
+  SI.setSubstream(4, 0);
+  sophiaevent_buffer event;
+  ASSERT_EQ(sbo.nEvents, 60);
+  for (int k = 0; k < 60; ++k) {
+    ASSERT_EQ(SI.sophiaevent(requests[k].onProton, requests[k].Ein, requests[k].eps, event),
+              sbo.getNout(k));
+    for (int i = 0; i < event.Nout; ++i) {
+      EXPECT_EQ(event.pdgID[i], ID_sophia_to_PDG(sbo.getPartID(k, i)));
+      EXPECT_EQ(event.E[i], sbo.getPartP(k, i, 3));
+    }
+  }
+}
+
+TEST(Batch, regenerateEvent) {
+  sophiabatch_output sbo =
+      generateBatch(true, 1e10, 1e-8, 40, 2, 21, false, sophia_parameters(), 1);
+  sophia_interface SI;
+  for (int k : {39, 0, 17}) {
+    SI.regenerateEvent(true, 1e10, 1e-8, 21, k);
+    ASSERT_EQ(SI.np, sbo.getNout(k));
+    for (int i = 0; i < SI.np; ++i) {
+      EXPECT_EQ(SI.LLIST[i], sbo.getPartID(k, i));
+      EXPECT_EQ(SI.p[3][i], sbo.getPartP(k, i, 3));
+    }
+  }
+}
+
+TEST(Batch, seedsDiffer) {
+  sophiabatch_output sbo1 = generateBatch(true, 1e9, 1e-9, 100, 1, 1);
+  sophiabatch_output sbo2 = generateBatch(true, 1e9, 1e-9, 100, 1, 2);
+  EXPECT_NE(sbo1.partP[3], sbo2.partP[3]);
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
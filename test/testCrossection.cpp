@@ -0,0 +1,111 @@
+#include "gtest/gtest.h"
+#include "sophia_interface.h"
+
+TEST(Crossection, gridPoints) {
+  const crossection_table& table = crossection_table::instance();
+  for (int NL0 = 13; NL0 <= 14; ++NL0) {
+    for (int NDIR = 0; NDIR < crossection_table::nChannels; ++NDIR) {
+      EXPECT_EQ(table.crossection(0.1, NDIR, NL0), 0.);
+      EXPECT_EQ(table.crossection(0.85, NDIR, NL0),
+                sophia_interface::crossection_analytic(0.85, NDIR, NL0));
+      EXPECT_EQ(table.crossection(10., NDIR, NL0),
+                sophia_interface::crossection_analytic(10., NDIR, NL0));
+      EXPECT_EQ(table.crossection(2e8, NDIR, NL0),
+                sophia_interface::crossection_analytic(2e8, NDIR, NL0));
+    }
+  }
+  EXPECT_THROW(table.crossection(1., 20, 13), std::runtime_error);
+  EXPECT_THROW(table.crossection(1., 3, 12), std::runtime_error);
+}
+
+TEST(Crossection, accuracy) {
+  const double deviation = crossection_table::instance().maxDeviation();
+  std::cout << "maximal relative deviation of tabulated cross sections: " << deviation
+            << std::endl;
+  EXPECT_LT(deviation, 1e-3);
+}
+
+TEST(Crossection, allChannels) {
+  // one evaluation for all channels, identical to the single channel results
+  sophia_interface sopi;
+  for (int tabulated = 0; tabulated < 2; ++tabulated) {
+    sopi.useTabulatedCrossections(tabulated != 0);
+    for (int NL0 = 13; NL0 <= 14; ++NL0) {
+      for (int i = 0; i < 500; ++i) {
+        const double x = 0.1 * std::pow(1e6, i / 500.);
+        const crossection_output xco = sopi.crossections(x, NL0);
+        for (int NDIR = 0; NDIR < crossection_output::nChannels; ++NDIR) {
+          EXPECT_EQ(xco.sigma[NDIR], sopi.crossection(x, NDIR, NL0));
+        }
+      }
+    }
+  }
+  EXPECT_THROW(sophia_interface::crossections_analytic(1., 12), std::runtime_error);
+  EXPECT_THROW(sophia_interface::crossection_analytic(1., 20, 13), std::runtime_error);
+}
+
+TEST(Crossection, tabulatedEvents) {
+  sophia_interface sopi;
+  sopi.useTabulatedCrossections(true);
+  for (int i = 0; i < 100; ++i) {
+    sophiaevent_output out = sopi.sophiaevent(true, 1e10, 1e-9);
+    EXPECT_GT(out.Nout, 1);
+  }
+  sopi.useTabulatedCrossections(false);
+  EXPECT_EQ(sopi.crossection(0.3, 3, 13), sophia_interface::crossection_analytic(0.3, 3, 13));
+}
+
+static double functsReference(double s, int L0) {
+  // fine quadrature of functs over [functs_table::sMin, s]
+  const int n = 2000;
+  const double step = std::log(s / functs_table::sMin) / n;
+  double sum = 0.;
+  for (int i = 0; i < n; ++i) {
+    const double a = functs_table::sMin * std::exp(i * step);
+    const double b = functs_table::sMin * std::exp((i + 1) * step);
+    sum += gaussInt(
+        [L0](double s) {
+          const double pm = 0.93827;
+          return (s - pm * pm) *
+                 sophia_interface::crossection_analytic((s - pm * pm) / 2. / pm, 3, L0);
+        },
+        a, b);
+  }
+  return sum;
+}
+
+TEST(Crossection, functsIntegral) {
+  const functs_table& table = functs_table::instance();
+  for (int L0 = 13; L0 <= 14; ++L0) {
+    EXPECT_EQ(table.integral(functs_table::sMin, L0), 0.);
+    for (double s : {1.2, 1.6, 3., 10., 1e3, 1e6}) {
+      const double reference = functsReference(s, L0);
+      EXPECT_NEAR(table.integral(s, L0) / reference, 1., 1e-4) << "s = " << s;
+    }
+  }
+}
+
+TEST(Crossection, functsSampling) {
+  const functs_table& table = functs_table::instance();
+  sophia_random rng;
+  const double smax = 50.;
+  const int n = 100000;
+  int below = 0;
+  for (int i = 0; i < n; ++i) {
+    const double s = table.sample(smax, 13, rng.RLU());
+    ASSERT_GE(s, functs_table::sMin);
+    ASSERT_LE(s, smax);
+    if (s < 2.) ++below;
+  }
+  const double expected = table.integral(2., 13) / table.integral(smax, 13);
+  EXPECT_NEAR(below / static_cast<double>(n), expected, 5. * std::sqrt(expected / n));
+
+  sophia_interface sopi;
+  sopi.useTabulatedSampling(true);
+  for (int i = 0; i < 100; ++i) EXPECT_GT(sopi.sophiaevent(false, 1e10, 1e-9).Nout, 1);
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
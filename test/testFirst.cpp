@@ -1,12 +1,278 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
 #include "gtest/gtest.h"
 #include "sophia_interface.h"
 
+// counts heap allocations, see test noAllocations. Not inlined: GCC would otherwise see
+// malloc/free inside new/delete expressions and warn about mismatched allocation functions.
+static std::atomic<long> nAllocations(0);
+__attribute__((noinline)) void* operator new(std::size_t size) {
+  nAllocations++;
+  void* ptr = std::malloc(size == 0 ? 1 : size);
+  if (!ptr) throw std::bad_alloc();
+  return ptr;
+}
+__attribute__((noinline)) void operator delete(void* ptr) noexcept { std::free(ptr); }
+__attribute__((noinline)) void operator delete(void* ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
 TEST(First, debug) {
   auto sopi = sophia_interface();
 
   EXPECT_THROW(sopi.debug("some string", true), std::runtime_error);
 }
 
+TEST(First, parametersPerInstance) {
+  sophia_interface stablePions;
+  sophia_interface unstablePions;
+  bool foundPion = false;
+  for (int k = 0; k < 100; ++k) {
+    sophiaevent_output seo = stablePions.sophiaevent(true, 1e9, 1e-9, true);
+    for (int i = 0; i < seo.Nout; ++i) {
+      if (seo.outPartID[i] >= 6 && seo.outPartID[i] <= 8) foundPion = true;
+    }
+    seo = unstablePions.sophiaevent(true, 1e9, 1e-9, false);
+    for (int i = 0; i < seo.Nout; ++i) {
+      EXPECT_FALSE(seo.outPartID[i] >= 6 && seo.outPartID[i] <= 8);
+    }
+  }
+  EXPECT_TRUE(foundPion);
+
+  // the global defaults stay untouched
+  EXPECT_GT(IDB[6], 0);
+  EXPECT_EQ(unstablePions.IDB[6], IDB[6]);
+  EXPECT_EQ(stablePions.IDB[6], 0);
+}
+
+TEST(First, reset) {
+  sophia_interface reused;
+  sophia_interface resetEachEvent;
+  for (int k = 0; k < 200; ++k) {
+    sophiaevent_output seo1 = reused.sophiaevent(true, 1e10, 1e-8);
+    resetEachEvent.reset();
+    EXPECT_EQ(resetEachEvent.N, 0);
+    EXPECT_EQ(resetEachEvent.np, 0);
+    sophiaevent_output seo2 = resetEachEvent.sophiaevent(true, 1e10, 1e-8);
+    ASSERT_EQ(seo1.Nout, seo2.Nout);
+    for (int i = 0; i < seo1.Nout; ++i) {
+      EXPECT_EQ(seo1.outPartID[i], seo2.outPartID[i]);
+      EXPECT_EQ(seo1.outPartP[3][i], seo2.outPartP[3][i]);
+    }
+  }
+}
+
+TEST(First, compactOutput) {
+  sophia_interface fixed;
+  sophia_interface compact;
+  sophiaevent_buffer buffer;
+  for (int k = 0; k < 200; ++k) {
+    sophiaevent_output seo = fixed.sophiaevent(false, 1e9, 1e-9, true);
+    int Nout = compact.sophiaevent(false, 1e9, 1e-9, buffer, true);
+    ASSERT_EQ(seo.Nout, Nout);
+    ASSERT_EQ(buffer.Nout, Nout);
+    ASSERT_EQ(buffer.E.size(), static_cast<size_t>(Nout));
+    for (int i = 0; i < Nout; ++i) {
+      EXPECT_EQ(ID_sophia_to_PDG(seo.outPartID[i]), buffer.pdgID[i]);
+      EXPECT_EQ(seo.outPartP[0][i], buffer.px[i]);
+      EXPECT_EQ(seo.outPartP[1][i], buffer.py[i]);
+      EXPECT_EQ(seo.outPartP[2][i], buffer.pz[i]);
+      EXPECT_EQ(seo.outPartP[3][i], buffer.E[i]);
+      EXPECT_EQ(seo.outPartP[4][i], buffer.m[i]);
+    }
+  }
+}
+
+TEST(First, streamEvent) {
+  sophia_interface full;
+  sophia_interface streamed;
+  sophiaevent_buffer buffer;
+  // neutrinos and photons above 1e6 GeV
+  const particle_filter filter({12, -12, 14, -14, 22}, 1e6);
+  for (int k = 0; k < 200; ++k) {
+    const int Nout = full.sophiaevent(true, 1e10, 1e-8, buffer);
+    std::vector<event_particle> kept;
+    const int nKept = streamed.streamEvent(
+        true, 1e10, 1e-8, filter, [&kept](const event_particle& part) { kept.push_back(part); });
+    ASSERT_EQ(nKept, static_cast<int>(kept.size()));
+    size_t j = 0;
+    for (int i = 0; i < Nout; ++i) {
+      if (buffer.E[i] < 1e6 || !filter.accepts(buffer.pdgID[i])) continue;
+      ASSERT_LT(j, kept.size());
+      EXPECT_EQ(kept[j].pdgID, buffer.pdgID[i]);
+      EXPECT_EQ(kept[j].px, buffer.px[i]);
+      EXPECT_EQ(kept[j].E, buffer.E[i]);
+      EXPECT_EQ(kept[j].m, buffer.m[i]);
+      j++;
+    }
+    EXPECT_EQ(j, kept.size());
+  }
+
+  // no filter: all particles
+  const int Nout = full.sophiaevent(true, 1e10, 1e-8, buffer);
+  int nSeen = 0;
+  EXPECT_EQ(full.visitEvent(particle_filter(), [&nSeen](const event_particle&) { nSeen++; }), Nout);
+  EXPECT_EQ(nSeen, Nout);
+}
+
+#ifndef SOPHIA_NO_STATISTICS
+TEST(First, statistics) {
+  sophia_interface sopi;
+  const int nEvents = 500;
+  for (int k = 0; k < nEvents; ++k) sopi.sophiaevent(true, 1e10, 1e-8);
+  const sophia_statistics& stat = sopi.getStatistics();
+  EXPECT_EQ(stat.nEvents, nEvents);
+  EXPECT_EQ(stat.nSample, nEvents);
+  EXPECT_EQ(stat.nRandom, sopi.randomGenerator.getCount());
+  long long nImode = 0;
+  for (int i = 0; i < 7; ++i) nImode += stat.nImode[i];
+  EXPECT_EQ(nImode, nEvents);
+  EXPECT_GT(stat.nFragmentation, 0);
+  EXPECT_GT(stat.nDecays, 0);
+  EXPECT_GT(stat.tEventgen, stat.tFragmentation);
+
+  sopi.resetStatistics();
+  EXPECT_EQ(sopi.getStatistics().nEvents, 0);
+  EXPECT_EQ(sopi.getStatistics().tEventgen, 0.);
+}
+#endif
+
+#ifndef SOPHIA_NO_DIAGNOSTICS
+TEST(First, diagnostics) {
+  sophia_interface sopi;
+  std::vector<std::string> reports;
+  sopi.diagnostics.setCallback([&reports](sophia_diagnostics::level_type level,
+                                          sophia_diagnostics::message_id id,
+                                          const std::string& message) {
+    EXPECT_EQ(level, sophia_diagnostics::warning);
+    EXPECT_EQ(id, sophia_diagnostics::belowThreshold);
+    reports.push_back(message);
+  });
+  sopi.diagnostics.setMaxReports(3);
+  // s below the threshold: no event
+  for (int k = 0; k < 5; ++k) {
+    sopi.generateEventAt(13, 1e9, 1e-9, 1.);
+    EXPECT_EQ(sopi.np, 0);
+  }
+  EXPECT_EQ(sopi.diagnostics.getCount(sophia_diagnostics::belowThreshold), 5);
+  ASSERT_EQ(reports.size(), 3u);
+  EXPECT_EQ(reports[0].find("input energy below threshold"), 0u);
+  EXPECT_NE(reports[2].find("suppressed"), std::string::npos);
+
+  // only counted
+  sopi.diagnostics.resetCounts();
+  sopi.diagnostics.setLevel(sophia_diagnostics::error);
+  sopi.generateEventAt(13, 1e9, 1e-9, 1.);
+  EXPECT_EQ(sopi.diagnostics.getCount(sophia_diagnostics::belowThreshold), 1);
+  EXPECT_EQ(reports.size(), 3u);
+}
+#endif
+
+TEST(First, noAllocations) {
+  // after warm-up the event generation does not touch the heap
+  sophia_interface sopi;
+  sophiaevent_buffer buffer;
+  for (int k = 0; k < 100; ++k) sopi.sophiaevent(true, 1e10, 1e-8, buffer);
+  buffer.px.reserve(2000);
+  buffer.py.reserve(2000);
+  buffer.pz.reserve(2000);
+  buffer.E.reserve(2000);
+  buffer.m.reserve(2000);
+  buffer.pdgID.reserve(2000);
+  buffer.weight.reserve(2000);
+  const long nBefore = nAllocations;
+  for (int k = 0; k < 1000; ++k) {
+    sopi.sophiaevent(k % 2 == 0, 1e10, (k % 3 == 0) ? 1e-10 : 1e-8, buffer, k % 5 == 0);
+  }
+  EXPECT_EQ(nAllocations - nBefore, 0);
+}
+
+TEST(First, flavourCodes) {
+  // table lookups (|KF| < 10000) and direct evaluation
+  EXPECT_EQ(sophia_interface::LUCOMP(211), 101);
+  EXPECT_EQ(sophia_interface::LUCOMP(-211), 101);
+  EXPECT_EQ(sophia_interface::LUCOMP(2212), 333);
+  EXPECT_EQ(sophia_interface::LUCOMP(2224), 364);
+  EXPECT_EQ(sophia_interface::LUCOMP(30443), 231);
+  EXPECT_EQ(sophia_interface::LUCOMP(0), 0);
+  EXPECT_EQ(sophia_interface::LUCOMP(123456), 0);
+  EXPECT_EQ(sophia_interface::LUCHGE(2212), 3);
+  EXPECT_EQ(sophia_interface::LUCHGE(-211), -3);
+  EXPECT_EQ(sophia_interface::LUCHGE(2224), 6);
+  EXPECT_EQ(sophia_interface::LUCHGE(1), -1);
+  EXPECT_EQ(sophia_interface::LUCHGE(-2), -2);
+}
+
+TEST(First, particleCodes) {
+  // output codes of the former switch
+  EXPECT_EQ(ID_sophia_to_PDG(13), 1000010010);
+  EXPECT_EQ(ID_sophia_to_PDG(-14), -1000000010);
+  EXPECT_EQ(ID_sophia_to_PDG(1), 22);
+  EXPECT_EQ(ID_sophia_to_PDG(18), -14);
+  EXPECT_EQ(ID_sophia_to_PDG(8), -211);
+  EXPECT_EQ(ID_sophia_to_PDG(19), -1000010010);
+  EXPECT_THROW(ID_sophia_to_PDG(0), std::runtime_error);
+  EXPECT_THROW(ID_sophia_to_PDG(-7), std::runtime_error);
+  EXPECT_THROW(ID_sophia_to_PDG(50), std::runtime_error);
+
+  sophia_interface SI;
+  for (int id = 1; id <= particle_table::nParticles; ++id) {
+    const particle_data particle = getParticle(id);
+    EXPECT_EQ(particle.mass, AM[id - 1]);
+    EXPECT_EQ(particle.charge, ICHP[id - 1]);
+    // round trip, antibaryons as negative IDs
+    const int expected = (id == 19 || id == 20) ? -(id - 6) : id;
+    EXPECT_EQ(PDGToSophia(sophiaToPDG(id)), expected);
+    EXPECT_EQ(SI.ICON_PDG_SIB(sophiaToPDG(id)), expected);
+    if (LBARP[id - 1] < 0) {
+      EXPECT_EQ(getParticle(LBARP[id - 1]).charge, -particle.charge);
+    }
+  }
+  EXPECT_EQ(SI.ICON_PDG_SIB(80000), 13);
+  EXPECT_EQ(PDGToSophia(443), 0);
+}
+
+TEST(First, thinning) {
+  sophia_interface plain;
+  plain.setSeed(7);
+  sophia_interface thinned;
+  thinned.setSeed(7);
+  const double Eth = 1e10;
+  thinned.setThinningEnergy(Eth);
+  thinned.setThinningEnergy(13, 0.);  // nucleons are kept
+  thinned.setThinningEnergy(14, 0.);
+  EXPECT_THROW(thinned.setThinningEnergy(-1.), std::runtime_error);
+  EXPECT_THROW(thinned.setThinningEnergy(0, 1.), std::runtime_error);
+
+  // weighted energy flow of many events
+  double Eplain = 0., Ethinned = 0.;
+  int nPlain = 0, nThinned = 0;
+  sophiaevent_buffer buffer;
+  for (int k = 0; k < 2000; ++k) {
+    plain.sophiaevent(true, 1e11, 1e-9, buffer);
+    for (int i = 0; i < buffer.Nout; ++i) {
+      EXPECT_EQ(buffer.weight[i], 1.);
+      Eplain += buffer.E[i];
+    }
+    nPlain += buffer.Nout;
+
+    thinned.sophiaevent(true, 1e11, 1e-9, buffer);
+    for (int i = 0; i < buffer.Nout; ++i) {
+      if (std::abs(buffer.pdgID[i]) > 1000000000 || buffer.E[i] >= Eth) {
+        EXPECT_EQ(buffer.weight[i], 1.);
+      } else {
+        EXPECT_NEAR(buffer.weight[i] * buffer.E[i], Eth, 1e-6 * Eth);
+      }
+      Ethinned += buffer.weight[i] * buffer.E[i];
+    }
+    nThinned += buffer.Nout;
+  }
+  EXPECT_LT(nThinned, 0.5 * nPlain);
+  EXPECT_NEAR(Ethinned / Eplain, 1., 0.03);
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
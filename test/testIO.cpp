@@ -0,0 +1,98 @@
+#include <algorithm>
+#include <cstdio>
+
+#include "gtest/gtest.h"
+#include "sophia_io.h"
+
+TEST(IO, roundTrip) {
+  sophiabatch_output sbo = generateBatch(true, 1e10, 1e-8, 300, 1, 3);
+  sophiafile_header header;
+  header.Ein = 1e10;
+  header.eps = 1e-8;
+  header.seed = 3;
+  header.blockSize = 100;  // events span blocks
+  {
+    sophia_writer writer("testIO.sophia", header);
+    writer.write(sbo);
+  }
+
+  sophia_reader reader("testIO.sophia");
+  EXPECT_EQ(reader.getHeader().L0, 13);
+  EXPECT_EQ(reader.getHeader().Ein, 1e10);
+  EXPECT_EQ(reader.getHeader().seed, 3u);
+  EXPECT_EQ(reader.getHeader().nParticles, sbo.partID.size());
+  ASSERT_EQ(reader.getNEvents(), 300);
+  // random access, backwards
+  for (int k = 299; k >= 0; --k) {
+    ASSERT_EQ(reader.getNout(k), sbo.getNout(k));
+    for (int i = 0; i < sbo.getNout(k); ++i) {
+      EXPECT_EQ(reader.getPdgID(k, i), ID_sophia_to_PDG(sbo.getPartID(k, i)));
+      for (int j = 0; j < 5; ++j) EXPECT_EQ(reader.getPartP(k, i, j), sbo.getPartP(k, i, j));
+    }
+  }
+  EXPECT_THROW(reader.getPdgID(0, sbo.getNout(0)), std::runtime_error);
+  std::remove("testIO.sophia");
+}
+
+TEST(IO, singlePrecision) {
+  sophia_interface SI;
+  sophiafile_header header;
+  header.singlePrecision = 1;
+  std::vector<sophiaevent_buffer> events(50);
+  {
+    sophia_writer writer("testIO_float.sophia", header);
+    for (sophiaevent_buffer& event : events) {
+      SI.sophiaevent(true, 1e9, 1e-9, event);
+      writer.write(SI);
+    }
+    writer.close();
+  }
+  sophia_reader reader("testIO_float.sophia");
+  sophiaevent_buffer event;
+  for (size_t k = 0; k < events.size(); ++k) {
+    ASSERT_EQ(reader.readEvent(k, event), events[k].Nout);
+    for (int i = 0; i < event.Nout; ++i) {
+      EXPECT_EQ(event.pdgID[i], events[k].pdgID[i]);
+      EXPECT_EQ(event.E[i], static_cast<float>(events[k].E[i]));
+    }
+  }
+  std::remove("testIO_float.sophia");
+}
+
+TEST(IO, weights) {
+  sophia_parameters thinned;
+  thinned.setThinningEnergy(1e8);
+  sophiabatch_output sbo = generateBatch(true, 1e11, 1e-8, 100, 1, 5, false, thinned);
+  ASSERT_NE(std::count(sbo.partWeight.begin(), sbo.partWeight.end(), 1.),
+            static_cast<long>(sbo.partWeight.size()));
+  {
+    sophia_writer writer("testIO_weights.sophia", sophiafile_header());
+    writer.write(sbo);
+  }
+  sophia_reader reader("testIO_weights.sophia");
+  sophiaevent_buffer event;
+  for (int k = 0; k < sbo.nEvents; ++k) {
+    ASSERT_EQ(reader.readEvent(k, event), sbo.getNout(k));
+    for (int i = 0; i < event.Nout; ++i) {
+      EXPECT_EQ(event.weight[i], sbo.getPartWeight(k, i));
+      EXPECT_EQ(reader.getWeight(k, i), sbo.getPartWeight(k, i));
+      EXPECT_EQ(event.E[i], sbo.getPartP(k, i, 3));
+    }
+  }
+  std::remove("testIO_weights.sophia");
+}
+
+TEST(IO, invalidFile) {
+  EXPECT_THROW(sophia_reader("doesNotExist.sophia"), std::runtime_error);
+  {
+    std::ofstream file("testIO.csv");
+    file << "eventID\tpartID\tEGeV\n";
+  }
+  EXPECT_THROW(sophia_reader("testIO.csv"), std::runtime_error);
+  std::remove("testIO.csv");
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
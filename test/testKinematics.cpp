@@ -0,0 +1,102 @@
+#include <cmath>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "sophia_interface.h"
+#include "sophia_kinematics.h"
+
+namespace {
+
+struct particles {
+  std::vector<double> px, py, pz, E;
+  explicit particles(int n) : px(n), py(n), pz(n), E(n) {
+    sophia_random random(11);
+    for (int i = 0; i < n; ++i) {
+      px[i] = random() - 0.5;
+      py[i] = random() - 0.5;
+      pz[i] = 10. * random() - 5.;
+      E[i] = std::sqrt(px[i] * px[i] + py[i] * py[i] + pz[i] * pz[i] + 0.0195);
+    }
+  }
+};
+
+// the boost of every length once: exercise the 4-wide part as well as the remainder
+const int nMax = 23;
+
+}  // namespace
+
+TEST(Kinematics, rotateBoostMatchesPerParticle) {
+  const double CDE = std::cos(0.7), SDE = std::sin(0.7), CFE = std::cos(-2.1), SFE = std::sin(-2.1);
+  const double GA = 37.5, BGX = 3., BGY = -1., BGZ = 37.3;
+  for (int n = 0; n <= nMax; ++n) {
+    particles x(n);
+    particles ref = x;
+    rotateBoost(x.px.data(), x.py.data(), x.pz.data(), x.E.data(), n, CDE, SDE, CFE, SFE, GA,
+                BGX, BGY, BGZ);
+    for (int i = 0; i < n; ++i) {
+      // PO_TRANS and PO_ALTRA as in eventgen before
+      const double X = CDE * CFE * ref.px[i] - SFE * ref.py[i] + SDE * CFE * ref.pz[i];
+      const double Y = CDE * SFE * ref.px[i] + CFE * ref.py[i] + SDE * SFE * ref.pz[i];
+      const double Z = -SDE * ref.px[i] + CDE * ref.pz[i];
+      const double EP = X * BGX + Y * BGY + Z * BGZ;
+      const double PE = EP / (GA + 1.) + ref.E[i];
+      EXPECT_EQ(x.px[i], X + BGX * PE);
+      EXPECT_EQ(x.py[i], Y + BGY * PE);
+      EXPECT_EQ(x.pz[i], Z + BGZ * PE);
+      EXPECT_EQ(x.E[i], GA * ref.E[i] + EP);
+    }
+  }
+}
+
+TEST(Kinematics, boostMatchesPerParticle) {
+  const double BX = 0.3, BY = -0.2, BZ = 0.9;
+  const double GA = 1. / std::sqrt(1. - BX * BX - BY * BY - BZ * BZ);
+  for (int n = 0; n <= nMax; ++n) {
+    particles x(n);
+    particles ref = x;
+    std::vector<int> status(n);
+    for (int i = 0; i < n; ++i) status[i] = (i % 3 == 1) ? 0 : 1;
+    boost(x.px.data(), x.py.data(), x.pz.data(), x.E.data(), n, BX, BY, BZ, GA, status.data());
+    for (int i = 0; i < n; ++i) {
+      if (status[i] <= 0) {
+        EXPECT_EQ(x.px[i], ref.px[i]);
+        EXPECT_EQ(x.E[i], ref.E[i]);
+        continue;
+      }
+      // as in LUDBRB before
+      const double DBP = BX * ref.px[i] + BY * ref.py[i] + BZ * ref.pz[i];
+      const double DGABP = GA * (GA * DBP / (1. + GA) + ref.E[i]);
+      EXPECT_EQ(x.px[i], ref.px[i] + DGABP * BX);
+      EXPECT_EQ(x.py[i], ref.py[i] + DGABP * BY);
+      EXPECT_EQ(x.pz[i], ref.pz[i] + DGABP * BZ);
+      EXPECT_EQ(x.E[i], GA * (ref.E[i] + DBP));
+    }
+  }
+}
+
+TEST(Kinematics, eventsIndependentOfAVX2) {
+  const bool useAVX2 = kinematicsUsesAVX2();
+  setKinematicsAVX2(false);
+  EXPECT_FALSE(kinematicsUsesAVX2());
+  sophia_interface scalar;
+  std::vector<sophiaevent_buffer> reference(50);
+  for (sophiaevent_buffer& event : reference) scalar.sophiaevent(true, 1e10, 1e-7, event);
+
+  setKinematicsAVX2(true);
+  sophia_interface vectorised;
+  for (const sophiaevent_buffer& event : reference) {
+    sophiaevent_buffer other;
+    ASSERT_EQ(vectorised.sophiaevent(true, 1e10, 1e-7, other), event.Nout);
+    EXPECT_EQ(other.pdgID, event.pdgID);
+    EXPECT_EQ(other.px, event.px);
+    EXPECT_EQ(other.py, event.py);
+    EXPECT_EQ(other.pz, event.pz);
+    EXPECT_EQ(other.E, event.E);
+  }
+  setKinematicsAVX2(useAVX2);
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,196 @@
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "sophia_interface.h"
+
+TEST(Random, legacySequence) {
+  // first numbers of the original SOPHIA/JETSET RLU with seed 19780503
+  sophia_random rng;
+  EXPECT_EQ(rng.RLU(), 0.99529242515563965);
+  EXPECT_EQ(rng.RLU(), 0.36387842893600464);
+  EXPECT_EQ(rng.RLU(), 0.65767073631286621);
+  EXPECT_EQ(rng.RLU(), 0.084375858306884766);
+  EXPECT_EQ(rng.RLU(), 0.12936657667160034);
+  for (int i = 5; i < 100000; ++i) rng.RLU();
+  EXPECT_EQ(rng.RLU(), 0.2861286997795105);
+  EXPECT_EQ(rng.getCount(), 100001);
+}
+
+TEST(Random, instancesAreIndependent) {
+  sophia_interface sopi1;
+  sophia_interface sopi2;
+  for (int i = 0; i < 1000; ++i) sopi1.RNDM();
+  sophia_random reference;
+  EXPECT_EQ(sopi2.RNDM(), reference.RLU());
+}
+
+TEST(Random, seeding) {
+  sophia_random rng1(4711);
+  sophia_random rng2;
+  rng2.RLU();
+  rng2.setSeed(4711);
+  for (int i = 0; i < 100; ++i) EXPECT_EQ(rng1.RLU(), rng2.RLU());
+
+  EXPECT_THROW(rng1.setSeed(-1), std::runtime_error);
+  EXPECT_THROW(rng1.setSeed(sophia_random::maxSeed + 1), std::runtime_error);
+}
+
+TEST(Random, substreams) {
+  EXPECT_EQ(sophia_random::substreamSeed(1, 2), sophia_random::substreamSeed(1, 2));
+  EXPECT_NE(sophia_random::substreamSeed(1, 2), sophia_random::substreamSeed(1, 3));
+  EXPECT_NE(sophia_random::substreamSeed(1, 2), sophia_random::substreamSeed(2, 2));
+
+  sophia_random rng1;
+  sophia_random rng2;
+  rng1.setSubstream(42, 0);
+  rng2.setSubstream(42, 1);
+  EXPECT_NE(rng1.RLU(), rng2.RLU());
+
+  // RANMAR: substream s + 1 of a run follows 2^44 raw steps after the start of substream s
+  rng1.setSubstream(7, 5);
+  rng1.skip(sophia_random::maxStreams);
+  rng2.setSubstream(7, 6);
+  for (int i = 0; i < 200; ++i) ASSERT_EQ(rng1.RLU(), rng2.RLU());
+  rng1.setSubstream(7, 6);  // also from the state cached for run 7
+  sophia_random rng3;
+  rng3.setSubstream(7, 6);
+  EXPECT_EQ(rng1.RLU(), rng3.RLU());
+  EXPECT_EQ(rng1.getCount(), 1);
+  EXPECT_THROW(rng1.setSubstream(7, sophia_random::maxStreams), std::runtime_error);
+}
+
+TEST(Random, noSubstreamCollisions) {
+  // event keys of one run: distinct substreams, their first numbers all differ
+  const int nEvents = 20000;
+  std::vector<std::pair<double, double>> first(nEvents);
+  sophia_random rng;
+  for (int k = 0; k < nEvents; ++k) {
+    rng.setSubstream(1, k);
+    first[k].first = rng.RLU();
+    first[k].second = rng.RLU();
+  }
+  std::sort(first.begin(), first.end());
+  EXPECT_EQ(std::adjacent_find(first.begin(), first.end()), first.end());
+
+  // runs: seed and offset (62 bits) of 2e6 run seeds, e.g. the grid points of a scan, differ
+  const int nRuns = 2000000;
+  std::vector<std::pair<int, unsigned long long>> runs(nRuns);
+  for (int r = 0; r < nRuns; ++r) {
+    runs[r].first = sophia_random::substreamSeed(r, 0);
+    runs[r].second = sophia_random::hash(r, 0) >> 32;
+  }
+  std::sort(runs.begin(), runs.end());
+  EXPECT_EQ(std::adjacent_find(runs.begin(), runs.end()), runs.end());
+}
+
+TEST(Random, skip) {
+  const unsigned long long distances[] = {1, 32, 33, 96, 97, 98, 1000, 123457};
+  for (unsigned long long n : distances) {
+    sophia_random drawn(4711);
+    sophia_random skipped(4711);
+    for (int i = 0; i < 10; ++i) drawn.RLU();
+    for (int i = 0; i < 10; ++i) skipped.RLU();
+    for (unsigned long long i = 0; i < n; ++i) drawn.RLU();
+    skipped.skip(n);
+    EXPECT_EQ(skipped.getCount(), drawn.getCount());
+    for (int i = 0; i < 200; ++i) ASSERT_EQ(skipped.RLU(), drawn.RLU()) << n;
+  }
+
+  // legacy sequence: number 100001
+  sophia_random rng;
+  rng.skip(100000);
+  EXPECT_EQ(rng.RLU(), 0.2861286997795105);
+
+  // restore a recorded position
+  sophia_random run;
+  run.setSubstream(3, 4);
+  for (int i = 0; i < 5000; ++i) run.RLU();
+  const long long position = run.getPosition();
+  sophia_random replay;
+  replay.setSubstream(3, 4);
+  replay.skip(position);
+  EXPECT_EQ(replay.RLU(), run.RLU());
+
+  sophia_random xoshiro(1, sophia_random::XOSHIRO256);
+  EXPECT_THROW(xoshiro.skip(1), std::runtime_error);
+}
+
+TEST(Random, skipAcrossRejection) {
+  // seed 1 rejects raw step 619286 (a 0 or 1): 700000 RLU() calls take 700001 steps
+  sophia_random drawn(1);
+  for (int i = 0; i < 700000; ++i) drawn.RLU();
+  ASSERT_EQ(drawn.getCount(), 700000);
+  ASSERT_EQ(drawn.getPosition(), 700001);
+
+  // skip counts raw steps: skip(getPosition()) continues the sequence ...
+  sophia_random skipped(1);
+  skipped.skip(drawn.getPosition());
+  EXPECT_EQ(skipped.getPosition(), drawn.getPosition());
+  EXPECT_EQ(skipped.getCount(), 700001);  // the rejected step counts as drawn
+  sophia_random reference(drawn);
+  for (int i = 0; i < 200; ++i) ASSERT_EQ(skipped.RLU(), reference.RLU());
+
+  // ... skip(n) after n RLU() calls across the rejection is one step short
+  sophia_random shortSkip(1);
+  shortSkip.skip(drawn.getCount());
+  EXPECT_NE(shortSkip.RLU(), drawn.RLU());
+}
+
+TEST(Random, xoshiroSubstreams) {
+  // the full state comes from (runSeed, stream), not from the RANMAR seed
+  sophia_random rng1(1, sophia_random::XOSHIRO256);
+  sophia_random rng2(1, sophia_random::XOSHIRO256);
+  rng1.setSubstream(5, 0);
+  rng2.setSeed(sophia_random::substreamSeed(5, 0));
+  EXPECT_NE(rng1.RLU(), rng2.RLU());
+  sophia_random rng3(1, sophia_random::XOSHIRO256);
+  rng3.setSubstream(5, 0);
+  rng1.setSubstream(5, 0);
+  EXPECT_EQ(rng1.RLU(), rng3.RLU());
+  rng1.setSubstream(5, 1);
+  EXPECT_NE(rng1.RLU(), rng3.RLU());
+  // restarting keeps the substream
+  rng1.setAlgorithm(sophia_random::XOSHIRO256);
+  rng3.setSubstream(5, 1);
+  EXPECT_EQ(rng1.RLU(), rng3.RLU());
+}
+
+TEST(Random, xoshiro) {
+  sophia_random rng1(4711, sophia_random::XOSHIRO256);
+  sophia_random rng2(4711);
+  rng2.setAlgorithm(sophia_random::XOSHIRO256);
+  EXPECT_EQ(rng1.getCount(), 0);
+  const int n = 10 * sophia_random::bufferSize + 3;
+  double sum = 0.;
+  double sum2 = 0.;
+  for (int i = 0; i < n; ++i) {
+    const double r = rng1.RLU();
+    ASSERT_EQ(r, rng2.RLU());
+    ASSERT_GT(r, 0.);
+    ASSERT_LT(r, 1.);
+    sum += r;
+    sum2 += r * r;
+  }
+  EXPECT_EQ(rng1.getCount(), n);
+  EXPECT_NEAR(sum / n, 0.5, 0.02);
+  EXPECT_NEAR(sum2 / n - sum * sum / n / n, 1. / 12., 0.01);
+
+  rng1.setSeed(4712);
+  EXPECT_NE(rng1.RLU(), rng2.RLU());
+
+  // back to the legacy sequence
+  rng1.setSeed(sophia_random::legacySeed);
+  rng1.setAlgorithm(sophia_random::RANMAR);
+  EXPECT_EQ(rng1.RLU(), 0.99529242515563965);
+
+  sophia_interface sopi;
+  sopi.setRandomAlgorithm(sophia_random::XOSHIRO256);
+  for (int i = 0; i < 100; ++i) EXPECT_GT(sopi.sophiaevent(true, 1e10, 1e-9).Nout, 1);
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,148 @@
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+#include "gtest/gtest.h"
+#include "sophia_interface.h"
+#include "sophia_rates.h"
+
+static const double Mpc = 3.0856775814913673e24;  // cm
+
+TEST(Rates, blackBody) {
+  // CMB photon number density, 410.7 / cm^3
+  const photon_field cmb = photon_field::blackBody(2.7255);
+  double n = 0.;
+  for (size_t i = 0; i + 1 < cmb.eps.size(); ++i) {
+    n += gaussInt([&cmb](double e) { return cmb.getDensity(e); }, cmb.eps[i], cmb.eps[i + 1]);
+  }
+  EXPECT_NEAR(n, 410.7, 0.5);
+  EXPECT_EQ(cmb.getDensity(0.), 0.);
+}
+
+TEST(Rates, innerIntegral) {
+  const interaction_rate IR(13);
+  // direct integration of x sigma(x) on a fine grid
+  const double x = 3.;
+  auto f = [](double xp) { return xp * sophia_interface::crossection_analytic(xp, 3, 13); };
+  double reference = 0.;
+  const int n = 20000;
+  const double xth = 0.15;
+  for (int i = 0; i < n; ++i) {
+    reference += gaussInt(f, xth + (x - xth) * i / n, xth + (x - xth) * (i + 1) / n);
+  }
+  EXPECT_NEAR(IR.innerIntegral(x) / reference, 1., 1e-4);
+  EXPECT_EQ(IR.innerIntegral(0.1), 0.);
+  EXPECT_THROW(IR.innerIntegral(1e13), std::runtime_error);
+}
+
+TEST(Rates, monochromatic) {
+  // narrow line at eps0: rate = n0 / (2 gamma^2 eps0^2) I(2 gamma eps0) per unit density
+  photon_field line;
+  const double eps0 = 1e-9;
+  for (int i = -2; i <= 2; ++i) {
+    line.eps.push_back(eps0 * (1. + 1e-6 * i));
+    line.density.push_back(1.);
+  }
+  const interaction_rate IR(14);
+  const double gamma = 3e8;
+  const double n0 = 4e-6 * eps0;
+  const double expected =
+      n0 / (2. * gamma * gamma * eps0 * eps0) * IR.innerIntegral(2. * gamma * eps0);
+  EXPECT_NEAR(IR.rate(line, gamma) / expected / 1e-30, 1., 1e-4);
+}
+
+TEST(Rates, cmb) {
+  const photon_field cmb = photon_field::blackBody(2.7255);
+  const interaction_rate IR(13);
+  // GZK: mean free path of a few Mpc well above 1e20 eV, ~0 below 1e19 eV
+  EXPECT_GT(1. / (IR.rate(cmb, 1e12) * Mpc), 2.);
+  EXPECT_LT(1. / (IR.rate(cmb, 1e12) * Mpc), 8.);
+  EXPECT_LT(IR.rate(cmb, 1e9) * Mpc, 1e-6);
+
+  // parallel and serial agree exactly
+  std::vector<double> gamma;
+  for (int i = 0; i <= 40; ++i) gamma.push_back(std::pow(10., 9. + i / 10.));
+  const std::vector<double> parallel = IR.rates(cmb, gamma, 4);
+  for (size_t i = 0; i < gamma.size(); ++i) {
+    EXPECT_EQ(parallel[i], IR.rate(cmb, gamma[i]));
+    // rising up to the Delta resonance
+    if (i > 0 && gamma[i] < 3e11) {
+      EXPECT_GE(parallel[i], parallel[i - 1]);
+    }
+  }
+}
+
+TEST(Rates, writeTable) {
+  const std::vector<double> gamma = {1e10, 1e11, 1e12};
+  writeRateTable("testRates.txt", photon_field::blackBody(2.7255), gamma, 2);
+  std::ifstream file("testRates.txt");
+  std::string line;
+  int nLines = 0;
+  while (std::getline(file, line)) {
+    if (line[0] == '#') continue;
+    double g, rp, rn;
+    ASSERT_EQ(std::sscanf(line.c_str(), "%lf %lf %lf", &g, &rp, &rn), 3);
+    EXPECT_DOUBLE_EQ(g, gamma[nLines]);
+    EXPECT_GT(rp, 0.);
+    EXPECT_GT(rn, 0.);
+    nLines++;
+  }
+  EXPECT_EQ(nLines, 3);
+  std::remove("testRates.txt");
+}
+
+TEST(Rates, samplerDistribution) {
+  const photon_field cmb = photon_field::blackBody(2.7255);
+  const photon_field_sampler sampler(cmb, 1e9, 1e13);
+  for (int L0 = 13; L0 <= 14; ++L0) {
+    const interaction_rate IR(L0);
+    // between two grid points
+    const double gamma = 3.3e10;
+    auto weight = [&](double u) {
+      const double e = std::exp(u);
+      return cmb.getDensity(e) / e * IR.innerIntegral(2. * gamma * e);
+    };
+    // <ln(eps)> of the sampled photons and of the rate integrand
+    const double lnLow = std::log(IR.getXth() / (2. * gamma));
+    const double lnHigh = std::log(cmb.eps.back());
+    double norm = 0., mean = 0.;
+    const int nCells = 4000;
+    for (int i = 0; i < nCells; ++i) {
+      const double a = lnLow + (lnHigh - lnLow) * i / nCells;
+      const double b = lnLow + (lnHigh - lnLow) * (i + 1) / nCells;
+      norm += gaussInt(weight, a, b);
+      mean += gaussInt([&](double u) { return u * weight(u); }, a, b);
+    }
+    mean /= norm;
+
+    double sampled = 0.;
+    const int n = 20000;
+    for (int i = 0; i < n; ++i) {
+      const double eps = sampler.sampleEps(L0, gamma, (i + 0.5) / n, 0.5);
+      EXPECT_GE(2. * gamma * eps, IR.getXth() * (1. - 1e-12));
+      sampled += std::log(eps);
+    }
+    EXPECT_NEAR(sampled / n, mean, 0.01);
+  }
+  EXPECT_THROW(sampler.sampleEps(13, 1e14, 0.5, 0.5), std::runtime_error);
+}
+
+TEST(Rates, samplerEvents) {
+  const photon_field cmb = photon_field::blackBody(2.7255);
+  const photon_field_sampler sampler(cmb, 1e9, 1e13, 10);
+  sophia_interface SI;
+  sophiaevent_buffer buffer;
+  const double Ein = 1e12;
+  for (int k = 0; k < 200; ++k) {
+    const int Nout = SI.sophiaevent(k % 2 == 0, Ein, sampler, buffer);
+    ASSERT_GT(Nout, 1);
+    double E = 0.;
+    for (int i = 0; i < Nout; ++i) E += buffer.E[i];
+    EXPECT_NEAR(E / Ein, 1., 1e-6);
+  }
+#ifndef SOPHIA_NO_STATISTICS
+  const sophia_statistics& statistics = SI.getStatistics();
+  EXPECT_EQ(statistics.nEvents, 200);
+  EXPECT_EQ(statistics.nSampleRejected, 0);
+#endif
+}
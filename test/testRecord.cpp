@@ -0,0 +1,133 @@
+#include "gtest/gtest.h"
+#include "sophia_interface.h"
+#include "sophia_record.h"
+
+TEST(Record, grow) {
+  event_record<int, 3> record(4);
+  for (int j = 0; j < 3; ++j) {
+    for (int i = 0; i < 4; ++i) record[j][i] = 10 * j + i + 1;
+  }
+  record.grow(8, 2, 1);  // keep entries 0, 1 and the last one
+  EXPECT_EQ(record.getCapacity(), 8);
+  for (int j = 0; j < 3; ++j) {
+    EXPECT_EQ(record[j][0], 10 * j + 1);
+    EXPECT_EQ(record[j][1], 10 * j + 2);
+    for (int i = 2; i < 7; ++i) EXPECT_EQ(record[j][i], 0);
+    EXPECT_EQ(record[j][7], 10 * j + 4);
+  }
+  record.grow(5, 8);  // never shrinks
+  EXPECT_EQ(record.getCapacity(), 8);
+}
+
+TEST(Record, growDuringEvents) {
+  // records growing in the middle of events give the events of large records from the start
+  sophia_interface small;
+  small.setSeed(9);
+  sophia_interface large;
+  large.setSeed(9);
+  large.LUJETS_reserve(4000);
+  large.reserveParticles(2000);
+  EXPECT_EQ(small.MSTU[3], sophia_interface::initialRecordSize);
+  EXPECT_EQ(large.MSTU[3], 4000);
+
+  sophiaevent_buffer buffer1, buffer2;
+  for (int k = 0; k < 200; ++k) {
+    small.sophiaevent(true, 1e12, 1e-6, buffer1);
+    large.sophiaevent(true, 1e12, 1e-6, buffer2);
+    ASSERT_EQ(buffer1.Nout, buffer2.Nout);
+    for (int i = 0; i < buffer1.Nout; ++i) {
+      EXPECT_EQ(buffer1.pdgID[i], buffer2.pdgID[i]);
+      EXPECT_EQ(buffer1.E[i], buffer2.E[i]);
+    }
+  }
+  EXPECT_GT(small.p.getCapacity(), sophia_interface::initialParticles);
+  EXPECT_LE(small.MSTU[3], sophia_interface::maxRecordSize);
+
+  // setParameters keeps the size of the record
+  const int size = small.MSTU[3];
+  small.setParameters(sophia_parameters());
+  EXPECT_EQ(small.MSTU[3], size);
+}
+
+TEST(Record, vertices) {
+  sophia_interface withVertices;
+  withVertices.useVertices(true);
+  sophia_interface withoutVertices;
+  EXPECT_EQ(withVertices.V.getCapacity(), withVertices.K.getCapacity());
+  EXPECT_EQ(withoutVertices.V.getCapacity(), 0);
+
+  for (int k = 0; k < 200; ++k) {
+    sophiaevent_output seo1 = withVertices.sophiaevent(true, 1e11, 1e-8);
+    sophiaevent_output seo2 = withoutVertices.sophiaevent(true, 1e11, 1e-8);
+    ASSERT_EQ(seo1.Nout, seo2.Nout);
+    for (int i = 0; i < seo1.Nout; ++i) {
+      EXPECT_EQ(seo1.outPartID[i], seo2.outPartID[i]);
+      for (int j = 0; j < 5; ++j) EXPECT_EQ(seo1.outPartP[j][i], seo2.outPartP[j][i]);
+    }
+  }
+  EXPECT_EQ(withoutVertices.V.getCapacity(), 0);
+
+  // a Sigma0 at rest with a preset lifetime (K(1,1) = 4): its decay vertex for the daughters
+  for (sophia_interface* SI : {&withVertices, &withoutVertices}) {
+    SI->reset();
+    SI->N = 1;
+    SI->K[0][0] = 4;
+    SI->K[1][0] = 3212;
+    SI->P[4][0] = SI->P[3][0] = SI->ULMASS(3212);
+  }
+  withVertices.V[4][0] = 1.5;
+  for (sophia_interface* SI : {&withVertices, &withoutVertices}) {
+    SI->LUDECY(1);
+    ASSERT_EQ(SI->N, 3);
+  }
+  EXPECT_EQ(withVertices.V[4][0], 1.5);
+  for (int i = 1; i < 3; ++i) {
+    EXPECT_EQ(withVertices.V[3][i], withVertices.V[4][0]);
+    EXPECT_EQ(withVertices.K[1][i], withoutVertices.K[1][i]);
+    EXPECT_EQ(withVertices.P[3][i], withoutVertices.P[3][i]);
+  }
+
+  withVertices.useVertices(false);
+  EXPECT_EQ(withVertices.V.getCapacity(), 0);
+}
+
+TEST(Record, simpleStrings) {
+  // the specialised fragmentation of the strings of gamma_h gives the events of LUEXEC
+  sophia_interface general(5);
+  sophia_interface simple(5);
+  simple.useSimpleStrings(true);
+  sophiaevent_buffer buffer1, buffer2;
+  for (double eps : {1e-9, 1e-8, 1e-6}) {
+    for (int k = 0; k < 500; ++k) {
+      general.sophiaevent(k % 2 == 0, 1e10, eps, buffer1);
+      simple.sophiaevent(k % 2 == 0, 1e10, eps, buffer2);
+      ASSERT_EQ(buffer1.Nout, buffer2.Nout);
+      for (int i = 0; i < buffer1.Nout; ++i) {
+        EXPECT_EQ(buffer1.pdgID[i], buffer2.pdgID[i]);
+        EXPECT_EQ(buffer1.E[i], buffer2.E[i]);
+        EXPECT_EQ(buffer1.pz[i], buffer2.pz[i]);
+      }
+    }
+  }
+
+  // u - ud string as set up by gamma_h: taken; partons not joined or a string light enough to
+  // collapse into hadrons: left to LUEXEC
+  auto putString = [&](double Ecm, bool unjoined) {
+    simple.reset();
+    const double ee = Ecm / 2.;
+    simple.lund_put(1, 1, 0., 0., ee, ee);
+    simple.lund_put(2, 12, 0., 0., -ee, ee);
+    int Ijoin[2] = {1, 2};
+    simple.LUJOIN(2, Ijoin);
+    if (unjoined) simple.K[0][0] = 2;
+  };
+  putString(10., false);
+  EXPECT_TRUE(simple.fragmentSimpleStrings());
+  EXPECT_GT(simple.N, 2);
+  EXPECT_EQ(simple.K[0][0], 13);
+  putString(10., true);
+  EXPECT_FALSE(simple.fragmentSimpleStrings());
+  putString(1.5, false);
+  EXPECT_FALSE(simple.fragmentSimpleStrings());
+  EXPECT_EQ(simple.N, 2);
+}
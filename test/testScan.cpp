@@ -0,0 +1,89 @@
+#include <algorithm>
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "sophia_scan.h"
+
+TEST(Scan, jobs) {
+  const std::vector<interaction_request> points = scanGrid({1e9, 1e11}, {1e-9, 1e-8, 1e-7});
+  ASSERT_EQ(points.size(), 12u);
+  EXPECT_TRUE(points[0].onProton);
+  EXPECT_FALSE(points[6].onProton);
+  EXPECT_EQ(points[4].Ein, 1e11);
+  EXPECT_EQ(points[4].eps, 1e-8);
+  EXPECT_NE(scanSeed(1, 1), scanSeed(2, 0));
+  EXPECT_EQ(scanSeed(1, 1), sophia_random::hash(1, 1));
+
+  // 1050 events in jobs of 400 (rounded up from 350) events
+  const std::vector<scan_job> jobs = scanJobs(points, 1050, 350);
+  ASSERT_EQ(jobs.size(), 36u);
+  EXPECT_EQ(jobs[1].point, 0);
+  EXPECT_EQ(jobs[1].firstEvent, 400);
+  EXPECT_EQ(jobs[2].nEvents, 250);
+  EXPECT_EQ(jobs[3].point, 1);
+
+  // every rank gets work, the loads differ by less than the largest job
+  for (int size = 1; size <= 8; ++size) {
+    const std::vector<int> rank = assignJobs(jobs, size);
+    std::vector<double> load(size, 0.);
+    double maxCost = 0.;
+    for (size_t j = 0; j < jobs.size(); ++j) {
+      ASSERT_GE(rank[j], 0);
+      ASSERT_LT(rank[j], size);
+      load[rank[j]] += jobs[j].cost;
+      maxCost = std::max(maxCost, jobs[j].cost);
+    }
+    const auto range = std::minmax_element(load.begin(), load.end());
+    EXPECT_GT(*range.first, 0.);
+    EXPECT_LE(*range.second - *range.first, maxCost);
+  }
+}
+
+TEST(Scan, mergeIndependentOfRanks) {
+  const std::vector<interaction_request> points = scanGrid({1e10}, {1e-9, 1e-8}, true, false);
+  const sophia_spectra booking({22, 12, 1000010010}, 30, 1e-6, 1.);
+  const int nEvents = 700;
+  const std::vector<scan_job> jobs = scanJobs(points, nEvents, 200);
+  ASSERT_EQ(jobs.size(), 8u);
+
+  // jobs run by "rank 1 of 2" first and written to files, as scan_sophia does
+  const std::vector<int> rank = assignJobs(jobs, 2);
+  std::vector<sophia_spectra> jobSpectra(jobs.size());
+  for (int r = 1; r >= 0; --r) {
+    for (size_t j = 0; j < jobs.size(); ++j) {
+      if (rank[j] != r) continue;
+      runJob(points, jobs[j], 2, 4, booking).write(jobFileName("testScan", j));
+    }
+  }
+  for (size_t j = 0; j < jobs.size(); ++j) {
+    jobSpectra[j] = sophia_spectra::read(jobFileName("testScan", j));
+    std::remove(jobFileName("testScan", j).c_str());
+  }
+  const std::vector<sophia_spectra> merged = mergeJobs(jobs, jobSpectra, points.size());
+
+  // the same as one run per point
+  for (size_t k = 0; k < points.size(); ++k) {
+    const sophia_spectra whole = generateSpectra(true, 1e10, points[k].eps, nEvents, 3,
+                                                 scanSeed(4, k), booking);
+    EXPECT_EQ(merged[k].getNEvents(), nEvents);
+    EXPECT_EQ(merged[k].getSums(), whole.getSums());
+    EXPECT_EQ(merged[k].getSumsSquares(), whole.getSumsSquares());
+  }
+  EXPECT_NE(merged[0].getSums(), merged[1].getSums());
+}
+TEST(Scan, pointsDoNotShareStreams) {
+  // RANMAR substreams of a point start from seed and offset of its run seed (62 bits), which
+  // differ for all points of a large grid
+  const int nPoints = 1000000;
+  std::vector<std::pair<int, unsigned long long>> runs(nPoints);
+  for (int k = 0; k < nPoints; ++k) {
+    const unsigned long long seed = scanSeed(1, k);
+    runs[k] = std::make_pair(sophia_random::substreamSeed(seed, 0),
+                             sophia_random::hash(seed, 0) >> 32);
+  }
+  std::sort(runs.begin(), runs.end());
+  EXPECT_EQ(std::adjacent_find(runs.begin(), runs.end()), runs.end());
+}
+
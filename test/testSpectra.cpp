@@ -0,0 +1,110 @@
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "sophia_batch.h"
+
+TEST(Spectra, binning) {
+  sophia_spectra spectra({22, 211}, 8, 1e-8, 1.);
+  EXPECT_EQ(spectra.getNBins(), 8);
+  EXPECT_NEAR(spectra.getEdge(0), 1e-8, 1e-20);
+  EXPECT_NEAR(spectra.getEdge(4), 1e-4, 1e-16);
+  EXPECT_EQ(spectra.getEdge(8), 1.);
+  EXPECT_EQ(spectra.getSums().size(), 2u * sophia_spectra::nModes * 8);
+  EXPECT_THROW(spectra.getSum(111, 0), std::runtime_error);
+  EXPECT_THROW(spectra.getSum(22, 8), std::runtime_error);
+  EXPECT_THROW(sophia_spectra({22}, 10, 1., 1.), std::runtime_error);
+  EXPECT_THROW(spectra.merge(sophia_spectra({22, 211}, 9, 1e-8, 1.)), std::runtime_error);
+}
+
+TEST(Spectra, sameAsBatch) {
+  const double Ein = 1e10;
+  const int nEvents = 500;
+  sophia_spectra booking({22, 1000010010, -11}, 40, 1e-6, 1.);
+  sophia_spectra spectra = generateSpectra(true, Ein, 1e-8, nEvents, 1, 5, booking, true);
+  sophiabatch_output sbo = generateBatch(true, Ein, 1e-8, nEvents, 1, 5, true);
+  EXPECT_EQ(spectra.getNEvents(), nEvents);
+
+  long long nModes = 0;
+  for (int m = 0; m < sophia_spectra::nModes; ++m) nModes += spectra.getNEvents(m);
+  EXPECT_EQ(nModes, nEvents);
+  for (const int pdgID : booking.getPdgIDs()) {
+    double counted = 0.;  // the batch binned by hand
+    for (size_t i = 0; i < sbo.partID.size(); ++i) {
+      const double x = sbo.partP[3][i] / Ein;
+      if (ID_sophia_to_PDG(sbo.partID[i]) == pdgID && x >= 1e-6 && x < 1.) counted++;
+    }
+    double total = 0.;
+    for (int i = 0; i < spectra.getNBins(); ++i) {
+      double modes = 0.;
+      for (int m = 0; m < sophia_spectra::nModes; ++m) modes += spectra.getSum(pdgID, i, m);
+      EXPECT_EQ(spectra.getSum(pdgID, i), modes);
+      EXPECT_EQ(spectra.getSumSquares(pdgID, i), modes);  // weights 1
+      total += spectra.getSum(pdgID, i);
+    }
+    EXPECT_GT(total, 0.);
+    EXPECT_EQ(total, counted);
+  }
+}
+
+TEST(Spectra, independentOfThreadCount) {
+  sophia_spectra booking;
+  sophia_spectra serial = generateSpectra(false, 1e11, 1e-9, 2000, 1, 9, booking, false,
+                                          sophia_parameters(), 50);
+  sophia_spectra parallel = generateSpectra(false, 1e11, 1e-9, 2000, 4, 9, booking, false,
+                                            sophia_parameters(), 50);
+  EXPECT_EQ(serial.getSums(), parallel.getSums());
+  EXPECT_EQ(serial.getSumsSquares(), parallel.getSumsSquares());
+  for (int m = 0; m < sophia_spectra::nModes; ++m) {
+    EXPECT_EQ(serial.getNEvents(m), parallel.getNEvents(m));
+  }
+
+  // merge = sum of two runs
+  sophia_spectra twice = serial;
+  twice.merge(parallel);
+  EXPECT_EQ(twice.getNEvents(), 4000);
+  EXPECT_EQ(twice.getSum(22, 50), 2. * serial.getSum(22, 50));
+  twice.clear();
+  EXPECT_EQ(twice.getNEvents(), 0);
+  EXPECT_EQ(twice.getSum(22, 50), 0.);
+}
+
+TEST(Spectra, write) {
+  sophia_spectra spectra = generateSpectra(true, 1e10, 1e-8, 100, 1, 2, sophia_spectra({22}));
+  spectra.write("testSpectra.txt");
+  std::ifstream file("testSpectra.txt");
+  std::string line;
+  int nComments = 0;
+  double total = 0.;
+  while (std::getline(file, line)) {
+    if (line[0] == '#') {
+      nComments++;
+      continue;
+    }
+    int pdgID, Imode;
+    double xLow, xHigh, sum, sum2;
+    ASSERT_EQ(std::sscanf(line.c_str(), "%d %d %lf %lf %lf %lf", &pdgID, &Imode, &xLow, &xHigh,
+                          &sum, &sum2),
+              6);
+    EXPECT_EQ(pdgID, 22);
+    EXPECT_LT(xLow, xHigh);
+    total += sum;
+  }
+  EXPECT_EQ(nComments, 3);
+  double expected = 0.;
+  for (int i = 0; i < spectra.getNBins(); ++i) expected += spectra.getSum(22, i);
+  EXPECT_EQ(total, expected);
+
+  const sophia_spectra back = sophia_spectra::read("testSpectra.txt");
+  EXPECT_EQ(back.getPdgIDs(), spectra.getPdgIDs());
+  EXPECT_EQ(back.getNBins(), spectra.getNBins());
+  EXPECT_EQ(back.getXMin(), spectra.getXMin());
+  EXPECT_EQ(back.getNEvents(), 100);
+  for (int m = 0; m < sophia_spectra::nModes; ++m) {
+    EXPECT_EQ(back.getNEvents(m), spectra.getNEvents(m));
+  }
+  EXPECT_EQ(back.getSums(), spectra.getSums());
+  EXPECT_EQ(back.getSumsSquares(), spectra.getSumsSquares());
+  std::remove("testSpectra.txt");
+}
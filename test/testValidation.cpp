@@ -0,0 +1,291 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "sophia_interface.h"
+#include "sophia_spectra.h"
+
+/*
+    Statistical validation of the fast modes that do not reproduce the legacy events bit by bit
+    (tabulated cross sections, tabulated s sampling, the xoshiro256++ RNG) against the legacy
+    engine (analytic cross sections, RANMAR). For every point of a small (Ein, eps) grid both
+    generate nEvents events (different random numbers, so the samples are independent) which
+    are compared by
+      - the multiplicity distribution (chi^2) and its mean,
+      - the interaction mode fractions of dec_inter3 (chi^2),
+      - the spectra x = E / Ein of photons, e+-, nu_e, nu_mu and nucleons, binned (chi^2 with
+        the errors from the spread between events, as the particles of one event are
+        correlated),
+      - the x of the leading nucleon, one per event (Kolmogorov-Smirnov).
+    A comparison fails below minPValue. Every configuration but allFastModes differs from the
+    legacy engine in its one mode only, so a failure points to that mode. The time of both
+    runs is printed as the speedup of the mode. The simple string fragmentation reproduces the
+    legacy events (Record.simpleStrings) and is validated here as well, alone and in
+    allFastModes.
+*/
+
+static const double minPValue = 1e-3;
+static const int nEvents = 2000;
+
+// p-value of chi^2 with ndf degrees of freedom (Wilson-Hilferty)
+static double chi2PValue(double chi2, int ndf) {
+  if (ndf <= 0) return 1.;
+  const double a = 2. / (9. * ndf);
+  const double z = (std::cbrt(chi2 / ndf) - (1. - a)) / std::sqrt(a);
+  return 0.5 * std::erfc(z / std::sqrt(2.));
+}
+
+// p-value of the chi^2 test of two histograms with unequal totals; missing bins are empty
+static double compareHistograms(std::vector<double> h1, std::vector<double> h2) {
+  const size_t nBins = std::max(h1.size(), h2.size());
+  h1.resize(nBins, 0.);
+  h2.resize(nBins, 0.);
+  double n1 = 0., n2 = 0.;
+  for (size_t i = 0; i < nBins; ++i) {
+    n1 += h1[i];
+    n2 += h2[i];
+  }
+  double chi2 = 0.;
+  int ndf = -1;
+  for (size_t i = 0; i < nBins; ++i) {
+    if (h1[i] + h2[i] <= 0.) continue;
+    const double d = std::sqrt(n2 / n1) * h1[i] - std::sqrt(n1 / n2) * h2[i];
+    chi2 += d * d / (h1[i] + h2[i]);
+    ndf++;
+  }
+  return chi2PValue(chi2, ndf);
+}
+
+// p-value of the chi^2 test of two spectra, from the per-event sums and sums of squares of
+// every bin. The particles of one event may be correlated, the events are not.
+static double compareSpectra(const std::vector<double>& sum1, const std::vector<double>& sumSq1,
+                             const std::vector<double>& sum2, const std::vector<double>& sumSq2,
+                             int nEvents) {
+  double chi2 = 0.;
+  int ndf = 0;
+  for (size_t i = 0; i < sum1.size(); ++i) {
+    if (sum1[i] + sum2[i] < 20.) continue;  // Gaussian errors only
+    const double m1 = sum1[i] / nEvents, m2 = sum2[i] / nEvents;
+    const double var = (sumSq1[i] / nEvents - m1 * m1 + sumSq2[i] / nEvents - m2 * m2) / nEvents;
+    if (var <= 0.) continue;
+    chi2 += (m1 - m2) * (m1 - m2) / var;
+    ndf++;
+  }
+  return chi2PValue(chi2, ndf);
+}
+
+// p-value of the two-sample Kolmogorov-Smirnov test
+static double compareSamples(std::vector<double> s1, std::vector<double> s2) {
+  std::sort(s1.begin(), s1.end());
+  std::sort(s2.begin(), s2.end());
+  double D = 0.;
+  size_t i1 = 0, i2 = 0;
+  while (i1 < s1.size() && i2 < s2.size()) {
+    const double x = std::min(s1[i1], s2[i2]);
+    while (i1 < s1.size() && s1[i1] <= x) i1++;
+    while (i2 < s2.size() && s2[i2] <= x) i2++;
+    D = std::max(D, std::abs(double(i1) / s1.size() - double(i2) / s2.size()));
+  }
+  const double ne = std::sqrt(double(s1.size()) * s2.size() / (s1.size() + s2.size()));
+  const double lambda = (ne + 0.12 + 0.11 / ne) * D;
+  if (lambda < 0.2) return 1.;
+  double p = 0.;
+  for (int j = 1; j <= 100; ++j) {
+    p += 2. * ((j % 2) ? 1. : -1.) * std::exp(-2. * j * j * lambda * lambda);
+  }
+  return std::min(1., std::max(0., p));
+}
+
+struct validation_config {
+  std::string name;
+  bool tabulatedCrossections;
+  bool tabulatedSampling;
+  sophia_random::algorithm_type algorithm;
+  bool simpleStrings;
+};
+
+static const int nSpecies = 5;
+static const char* speciesNames[nSpecies] = {"photon", "e+-", "nu_e", "nu_mu", "nucleon"};
+static int speciesOf(int pdgID) {
+  switch (std::abs(pdgID)) {
+    case 22:
+      return 0;
+    case 11:
+      return 1;
+    case 12:
+      return 2;
+    case 14:
+      return 3;
+    case 1000010010:
+    case 1000000010:
+      return 4;
+  }
+  return -1;
+}
+
+// spectra: nBins log bins of x in [xMin, 1], x outside in the first and last bin
+static const int nBins = 40;
+static const double xMin = 1e-6;
+static int binOf(double x) {
+  const int i = static_cast<int>(nBins * std::log(x / xMin) / std::log(1. / xMin));
+  return std::min(nBins - 1, std::max(0, i));
+}
+
+struct validation_sample {
+  std::vector<double> multiplicity;  // events per Nout, as long as the largest Nout needs
+  std::vector<double> modes = std::vector<double>(sophia_spectra::nModes + 1, 0.);  // Imode + 1
+  double meanMultiplicity = 0.;
+  double varMultiplicity = 0.;
+  // per species: sum and sum of squares of the counts per event in every bin
+  std::vector<double> sum[nSpecies];
+  std::vector<double> sumSquares[nSpecies];
+  std::vector<double> xLeadingNucleon;
+  double seconds = 0.;
+};
+
+static validation_sample generateSample(const validation_config& config, bool onProton,
+                                        double Ein, double eps, int seed) {
+  sophia_interface SI(seed);
+  SI.useTabulatedCrossections(config.tabulatedCrossections);
+  SI.useTabulatedSampling(config.tabulatedSampling);
+  SI.setRandomAlgorithm(config.algorithm);
+  SI.useSimpleStrings(config.simpleStrings);
+
+  validation_sample sample;
+  for (int s = 0; s < nSpecies; ++s) {
+    sample.sum[s].assign(nBins, 0.);
+    sample.sumSquares[s].assign(nBins, 0.);
+  }
+  std::vector<double> counts(nSpecies * nBins);
+  sophiaevent_buffer buffer;
+  const auto start = std::chrono::steady_clock::now();
+  for (int k = 0; k < nEvents; ++k) {
+    SI.sophiaevent(onProton, Ein, eps, buffer);
+    if (buffer.Nout >= static_cast<int>(sample.multiplicity.size()))
+      sample.multiplicity.resize(buffer.Nout + 1, 0.);
+    sample.multiplicity[buffer.Nout]++;
+    sample.modes[SI.lastImode + 1]++;
+    sample.meanMultiplicity += buffer.Nout;
+    sample.varMultiplicity += double(buffer.Nout) * buffer.Nout;
+
+    std::fill(counts.begin(), counts.end(), 0.);
+    double xLeading = 0.;
+    for (int i = 0; i < buffer.Nout; ++i) {
+      const int s = speciesOf(buffer.pdgID[i]);
+      if (s < 0) continue;
+      const double x = buffer.E[i] / Ein;
+      counts[s * nBins + binOf(x)]++;
+      if (s == 4) xLeading = std::max(xLeading, x);
+    }
+    for (int s = 0; s < nSpecies; ++s) {
+      for (int i = 0; i < nBins; ++i) {
+        const double c = counts[s * nBins + i];
+        sample.sum[s][i] += c;
+        sample.sumSquares[s][i] += c * c;
+      }
+    }
+    sample.xLeadingNucleon.push_back(xLeading);
+  }
+  sample.seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  sample.meanMultiplicity /= nEvents;
+  sample.varMultiplicity =
+      sample.varMultiplicity / nEvents - sample.meanMultiplicity * sample.meanMultiplicity;
+  return sample;
+}
+
+// all comparisons of fast against legacy must pass, name for the messages
+static void expectCompatible(const validation_sample& legacy, const validation_sample& fast,
+                             const std::string& name) {
+  EXPECT_GT(compareHistograms(legacy.multiplicity, fast.multiplicity), minPValue)
+      << name << ": multiplicity";
+  const double sigmaMean =
+      std::sqrt((legacy.varMultiplicity + fast.varMultiplicity) / nEvents + 1e-12);
+  EXPECT_LT(std::abs(legacy.meanMultiplicity - fast.meanMultiplicity), 4. * sigmaMean)
+      << name << ": mean multiplicity";
+  EXPECT_GT(compareHistograms(legacy.modes, fast.modes), minPValue) << name << ": modes";
+  for (int s = 0; s < nSpecies; ++s) {
+    EXPECT_GT(compareSpectra(legacy.sum[s], legacy.sumSquares[s], fast.sum[s],
+                             fast.sumSquares[s], nEvents),
+              minPValue)
+        << name << ": " << speciesNames[s] << " spectrum";
+  }
+  EXPECT_GT(compareSamples(legacy.xLeadingNucleon, fast.xLeadingNucleon), minPValue)
+      << name << ": leading nucleon";
+}
+
+struct validation_point {
+  bool onProton;
+  double Ein, eps;  // GeV
+};
+
+// resonance region, multipion fragmentation at low and at high sqrt(s)
+static const validation_point grid[] = {
+    {true, 1e9, 1e-9}, {false, 1e10, 1e-9}, {true, 1e11, 1e-8}};
+
+static const validation_config legacyConfig = {"legacy", false, false, sophia_random::RANMAR,
+                                                false};
+
+static void validate(const validation_config& config) {
+  int seed = 1;
+  for (const validation_point& point : grid) {
+    const validation_sample legacy =
+        generateSample(legacyConfig, point.onProton, point.Ein, point.eps, seed++);
+    const validation_sample fast =
+        generateSample(config, point.onProton, point.Ein, point.eps, seed++);
+    std::ostringstream name;
+    name << config.name << " at Ein = " << point.Ein << " GeV, eps = " << point.eps << " GeV";
+    expectCompatible(legacy, fast, name.str());
+    std::cout << std::setw(24) << config.name << "  Ein = " << point.Ein
+              << " GeV  eps = " << point.eps << " GeV  speedup "
+              << legacy.seconds / fast.seconds << std::endl;
+  }
+}
+
+TEST(Validation, tabulatedCrossections) {
+  crossection_table::instance();  // not part of the timing
+  validate({"tabulated cross sections", true, false, sophia_random::RANMAR, false});
+}
+
+TEST(Validation, tabulatedSampling) {
+  functs_table::instance();
+  validate({"tabulated sampling", false, true, sophia_random::RANMAR, false});
+}
+
+TEST(Validation, xoshiro) {
+  validate({"xoshiro256++", false, false, sophia_random::XOSHIRO256, false});
+}
+
+TEST(Validation, simpleStrings) {
+  validate({"simple strings", false, false, sophia_random::RANMAR, true});
+}
+
+TEST(Validation, allFastModes) {
+  crossection_table::instance();
+  functs_table::instance();
+  validate({"all fast modes", true, true, sophia_random::XOSHIRO256, true});
+}
+
+TEST(Validation, detectsDifferences) {
+  // the comparisons have to see a 50 % higher photon energy in the resonance region ...
+  const validation_sample a = generateSample(legacyConfig, true, 1e9, 1e-9, 1);
+  const validation_sample b = generateSample(legacyConfig, true, 1e9, 1.5e-9, 2);
+  EXPECT_LT(compareHistograms(a.multiplicity, b.multiplicity), minPValue);
+  EXPECT_LT(compareHistograms(a.modes, b.modes), minPValue);
+  for (int s = 0; s < nSpecies; ++s) {
+    EXPECT_LT(compareSpectra(a.sum[s], a.sumSquares[s], b.sum[s], b.sumSquares[s], nEvents),
+              minPValue)
+        << speciesNames[s];
+  }
+
+  // ... and a 5 % shift of the leading nucleon
+  std::vector<double> shifted = a.xLeadingNucleon;
+  for (double& x : shifted) x *= 1.05;
+  EXPECT_LT(compareSamples(a.xLeadingNucleon, shifted), minPValue);
+}
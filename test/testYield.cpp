@@ -0,0 +1,85 @@
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+#include "gtest/gtest.h"
+#include "sophia_yield.h"
+
+TEST(Yield, build) {
+  const yield_table table = yield_table::build(13, false, 0., 10., 2, 200, 5, 3);
+  const yieldfile_header& header = table.getHeader();
+  EXPECT_GT(header.epsPrimeMin, 0.15);
+  EXPECT_EQ(header.nPoints, 5u);  // 1.8 decades
+  EXPECT_EQ(header.eventsPerPoint, 200u);
+
+  // energy conservation per stored event, up to the photon energy and float32 rounding
+  yield_event event;
+  for (int i = 0; i < 100; ++i) {
+    const int Nout = table.sample(header.epsPrimeMax, 0.5, (i + 0.5) / 100, event);
+    ASSERT_GT(Nout, 1);
+    double sum = 0.;
+    for (int j = 0; j < Nout; ++j) {
+      EXPECT_NE(event.pdgID[j], 0);
+      sum += event.x[j];
+    }
+    EXPECT_NEAR(sum, 1., 1e-5);
+  }
+  EXPECT_THROW(table.sample(20., 0.5, 0.5, event), std::runtime_error);
+
+  // independent of the number of threads
+  const yield_table serial = yield_table::build(13, false, 0., 10., 2, 200, 5, 1);
+  for (int i = 0; i < 50; ++i) {
+    yield_event other;
+    const double epsPrime = 0.2 * std::pow(50., i / 50.);
+    table.sample(epsPrime, 0.3, i / 50., event);
+    serial.sample(epsPrime, 0.3, i / 50., other);
+    EXPECT_EQ(event.pdgID, other.pdgID);
+    EXPECT_EQ(event.x, other.x);
+  }
+}
+
+TEST(Yield, roundTrip) {
+  const yield_table table = yield_table::build(14, true, 0.3, 3., 1, 50, 2, 2);
+  table.save("testYield.bin");
+  const yield_table loaded("testYield.bin");
+  EXPECT_EQ(loaded.getHeader().L0, 14);
+  EXPECT_EQ(loaded.getHeader().chargedPionsStable, 1);
+  EXPECT_EQ(loaded.getHeader().nParticles, table.getHeader().nParticles);
+  yield_event a, b;
+  for (int i = 0; i < 50; ++i) {
+    table.sample(1., 0.4, i / 50., a);
+    loaded.sample(1., 0.4, i / 50., b);
+    EXPECT_EQ(a.pdgID, b.pdgID);
+    EXPECT_EQ(a.x, b.x);
+    // stable charged pions are kept
+    for (int id : a.pdgID) EXPECT_NE(std::abs(id), 14);
+  }
+  std::remove("testYield.bin");
+
+  std::ofstream("testYield.bin") << "no table";
+  EXPECT_THROW(yield_table("testYield.bin"), std::runtime_error);
+  std::remove("testYield.bin");
+}
+
+TEST(Yield, sampleYield) {
+  // mean energy fraction of the photons, fast yields and full events
+  const double Ein = 1e10;
+  const double eps = 1e-9;
+  const yield_table table = yield_table::build(13, false, 0., 100., 10, 500, 7);
+  sophia_interface SI;
+  yield_event event;
+  sophiaevent_buffer buffer;
+  const int n = 4000;
+  double fast = 0., full = 0.;
+  for (int k = 0; k < n; ++k) {
+    const int Nout = sampleYield(SI, table, Ein, eps, event);
+    for (int j = 0; j < Nout; ++j) {
+      if (event.pdgID[j] == 22) fast += event.x[j];
+    }
+    const int N = SI.sophiaevent(true, Ein, eps, buffer);
+    for (int j = 0; j < N; ++j) {
+      if (buffer.pdgID[j] == 22) full += buffer.E[j] / Ein;
+    }
+  }
+  EXPECT_NEAR(fast / n, full / n, 0.1 * full / n);
+}